@@ -26,6 +26,8 @@
 #include <cassert>
 
 #include <geometry/shape.h>
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
 #include <geometry/shape_file_io.h>
 
 SHAPE_FILE_IO::SHAPE_FILE_IO( const std::string& aFilename, SHAPE_FILE_IO::IO_MODE aMode )
@@ -50,6 +52,15 @@ SHAPE_FILE_IO::SHAPE_FILE_IO( const std::string& aFilename, SHAPE_FILE_IO::IO_MO
 
     m_mode = aMode;
     // fixme: exceptions
+
+    if( m_file && m_mode == IOM_READ )
+    {
+        char buf[4096];
+        size_t n;
+
+        while( ( n = fread( buf, 1, sizeof( buf ), m_file ) ) > 0 )
+            m_readStream.write( buf, n );
+    }
 }
 
 
@@ -67,40 +78,53 @@ SHAPE_FILE_IO::~SHAPE_FILE_IO()
 
 SHAPE* SHAPE_FILE_IO::Read()
 {
- /*   char tmp[1024];
+    assert( m_mode == IOM_READ );
 
-    do {
-
-        if (fscanf(m_file, "%s", tmp) != 1)
-            return NULL;
+    if( !m_file )
+        return NULL;
 
-        if( !strcmp( tmp, "shape" )
-            break;
-    }
+    std::string tmp;
 
-    int type;
+    while( m_readStream >> tmp )
+    {
+        if( tmp == "group" )
+        {
+            m_readStream >> m_groupName;
+            continue;
+        }
 
-    SHAPE *rv = NULL;
+        if( tmp != "shape" )
+            continue;
 
-    fscanf(m_file,"%d %s", &type, tmp);
+        int type;
+        m_readStream >> type >> m_shapeName;
 
-    printf("create shape %d\n", type);
+        SHAPE* rv;
 
-    switch(type)
-    {
-        case SHAPE::LINE_CHAIN:
+        switch( type )
+        {
+        case SH_LINE_CHAIN:
             rv = new SHAPE_LINE_CHAIN;
             break;
-    }
 
-    if(!rv)
-        return NULL;
+        case SH_POLY_SET:
+            rv = new SHAPE_POLY_SET;
+            break;
 
-    rv.Parse ( )
+        default:
+            // The size of the shape data is unknown: nothing more can be read
+            return NULL;
+        }
+
+        if( !rv->Parse( m_readStream ) )
+        {
+            delete rv;
+            return NULL;
+        }
+
+        return rv;
+    }
 
-    fprintf(m_file,"shape %d %s %s\n", aShape->Type(), aName.c_str(), sh.c_str() );
-*/
-    assert( false );
     return NULL;
 }
 
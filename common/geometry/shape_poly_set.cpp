@@ -54,6 +54,8 @@ SHAPE_POLY_SET::~SHAPE_POLY_SET()
 
 int SHAPE_POLY_SET::NewOutline()
 {
+    invalidateIndex();
+
     SHAPE_LINE_CHAIN empty_path;
     POLYGON poly;
     poly.push_back( empty_path );
@@ -64,6 +66,8 @@ int SHAPE_POLY_SET::NewOutline()
 
 int SHAPE_POLY_SET::NewHole( int aOutline )
 {
+    invalidateIndex();
+
     m_polys.back().push_back( SHAPE_LINE_CHAIN() );
 
     return m_polys.back().size() - 2;
@@ -72,6 +76,8 @@ int SHAPE_POLY_SET::NewHole( int aOutline )
 
 int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole )
 {
+    invalidateIndex();
+
     if( aOutline < 0 )
         aOutline += m_polys.size();
 
@@ -131,6 +137,8 @@ const VECTOR2I& SHAPE_POLY_SET::CVertex( int index, int aOutline , int aHole ) c
 
 VECTOR2I& SHAPE_POLY_SET::Vertex( int index, int aOutline , int aHole )
 {
+    invalidateIndex();
+
     if( aOutline < 0 )
         aOutline += m_polys.size();
 
@@ -150,6 +158,8 @@ VECTOR2I& SHAPE_POLY_SET::Vertex( int index, int aOutline , int aHole )
 
 int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 {
+    invalidateIndex();
+
     assert( aOutline.IsClosed() );
 
     POLYGON poly;
@@ -164,6 +174,8 @@ int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 
 int SHAPE_POLY_SET::AddHole( const SHAPE_LINE_CHAIN& aHole, int aOutline )
 {
+    invalidateIndex();
+
     assert ( m_polys.size() );
 
     if( aOutline < 0 )
@@ -302,12 +314,6 @@ void SHAPE_POLY_SET::BooleanIntersection( const SHAPE_POLY_SET& a, const SHAPE_P
 
 void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
 {
-    // A static table to avoid repetitive calculations of the coefficient
-    // 1.0 - cos( M_PI/aCircleSegmentsCount)
-    // aCircleSegmentsCount is most of time <= 64 and usually 8, 12, 16, 32
-    #define SEG_CNT_MAX 64
-    static double arc_tolerance_factor[SEG_CNT_MAX+1];
-
     ClipperOffset c;
 
     BOOST_FOREACH( const POLYGON& poly, m_polys )
@@ -326,17 +332,9 @@ void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
     if( aCircleSegmentsCount < 6 )  // avoid incorrect aCircleSegmentsCount values
         aCircleSegmentsCount = 6;
 
-    double coeff;
-
-    if( aCircleSegmentsCount > SEG_CNT_MAX || arc_tolerance_factor[aCircleSegmentsCount] == 0 )
-    {
-        coeff = 1.0 - cos( M_PI/aCircleSegmentsCount);
-
-        if( aCircleSegmentsCount <= SEG_CNT_MAX )
-            arc_tolerance_factor[aCircleSegmentsCount] = coeff;
-    }
-    else
-        coeff = arc_tolerance_factor[aCircleSegmentsCount];
+    // Note: this is not cached in a static table, because zones are inflated
+    // from several threads, and one cos() is negligible compared to the offset itself
+    double coeff = 1.0 - cos( M_PI/aCircleSegmentsCount);
 
     c.ArcTolerance = std::abs( aFactor ) * coeff;
 
@@ -348,6 +346,7 @@ void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
 
 void SHAPE_POLY_SET::importTree( PolyTree* tree)
 {
+    invalidateIndex();
     m_polys.clear();
 
     for( PolyNode* n = tree->GetFirst(); n; n = n->GetNext() )
@@ -408,7 +407,64 @@ struct FractureEdge
 
 typedef std::vector<FractureEdge*> FractureEdgeSet;
 
-static int processEdge( FractureEdgeSet& edges, FractureEdge* edge )
+
+/**
+ * Class FractureEdgeIndex
+ * sorts the fracture edges in buckets of Y ranges, so that the edges crossing a
+ * horizontal line are found without testing all the edges of the polygon.
+ * Edges are never removed: when an edge is split, its Y range only shrinks, and the
+ * edges found in a bucket are filtered by FractureEdge::matches().
+ */
+class FractureEdgeIndex
+{
+public:
+    FractureEdgeIndex( int aYMin, int aYMax, int aEdgeCount )
+    {
+        // About 4 edges per bucket, if they are evenly spread
+        int64_t height = (int64_t) aYMax - aYMin + 1;
+        int64_t count = std::max( 1, aEdgeCount / 4 );
+
+        m_yMin = aYMin;
+        m_bucketHeight = std::max( (int64_t) 1, ( height + count - 1 ) / count );
+        m_buckets.resize( ( height + m_bucketHeight - 1 ) / m_bucketHeight );
+    }
+
+    void Add( FractureEdge* aEdge )
+    {
+        int last = bucket( std::max( aEdge->m_p1.y, aEdge->m_p2.y ) );
+
+        for( int i = bucket( std::min( aEdge->m_p1.y, aEdge->m_p2.y ) ); i <= last; i++ )
+            m_buckets[i].push_back( aEdge );
+    }
+
+    ///> Returns the edges which can cross the horizontal line at aY
+    const FractureEdgeSet& Find( int aY ) const
+    {
+        return m_buckets[bucket( aY )];
+    }
+
+private:
+    int bucket( int aY ) const
+    {
+        int64_t i = ( (int64_t) aY - m_yMin ) / m_bucketHeight;
+
+        return (int) std::max( (int64_t) 0, std::min( i, (int64_t) m_buckets.size() - 1 ) );
+    }
+
+    int m_yMin;
+    int64_t m_bucketHeight;
+    std::vector<FractureEdgeSet> m_buckets;
+};
+
+
+/**
+ * Connects the hole starting at edge to the nearest connected edge on its left.
+ * The edges are allocated from aPool, which must have room for 3 more edges: the
+ * tie between edges at the same distance is broken by their order in aPool.
+ * @return the number of edges connected to the outline.
+ */
+static int processEdge( FractureEdgeIndex& aIndex, std::vector<FractureEdge>& aPool,
+                        FractureEdge* edge )
 {
     int x = edge->m_p1.x;
     int y = edge->m_p1.y;
@@ -417,9 +473,11 @@ static int processEdge( FractureEdgeSet& edges, FractureEdge* edge )
 
     FractureEdge* e_nearest = NULL;
 
-    for( FractureEdgeSet::iterator i = edges.begin(); i != edges.end(); ++i )
+    const FractureEdgeSet& candidates = aIndex.Find( y );
+
+    for( FractureEdgeSet::const_iterator i = candidates.begin(); i != candidates.end(); ++i )
     {
-        if( !(*i)->matches( y ) )
+        if( !(*i)->m_connected || !(*i)->matches( y ) )
             continue;
 
         int x_intersect;
@@ -431,7 +489,10 @@ static int processEdge( FractureEdgeSet& edges, FractureEdge* edge )
 
         int dist = ( x - x_intersect );
 
-        if( dist >= 0 && dist < min_dist && (*i)->m_connected )
+        if( dist < 0 )
+            continue;
+
+        if( dist < min_dist || ( dist == min_dist && *i < e_nearest ) )
         {
             min_dist = dist;
             x_nearest = x_intersect;
@@ -443,13 +504,19 @@ static int processEdge( FractureEdgeSet& edges, FractureEdge* edge )
     {
         int count = 0;
 
-		FractureEdge* lead1 = new FractureEdge( true, VECTOR2I( x_nearest, y ), VECTOR2I( x, y ) );
-        FractureEdge* lead2 = new FractureEdge( true, VECTOR2I( x, y ), VECTOR2I( x_nearest, y ) );
-        FractureEdge* split_2 = new FractureEdge( true, VECTOR2I( x_nearest, y ), e_nearest->m_p2 );
+        // Room is reserved by the caller: the pool is not reallocated
+        assert( aPool.size() + 3 <= aPool.capacity() );
+
+        aPool.push_back( FractureEdge( true, VECTOR2I( x_nearest, y ), e_nearest->m_p2 ) );
+        FractureEdge* split_2 = &aPool.back();
+        aPool.push_back( FractureEdge( true, VECTOR2I( x_nearest, y ), VECTOR2I( x, y ) ) );
+        FractureEdge* lead1 = &aPool.back();
+        aPool.push_back( FractureEdge( true, VECTOR2I( x, y ), VECTOR2I( x_nearest, y ) ) );
+        FractureEdge* lead2 = &aPool.back();
 
-        edges.push_back( split_2 );
-        edges.push_back( lead1 );
-        edges.push_back( lead2 );
+        aIndex.Add( split_2 );
+        aIndex.Add( lead1 );
+        aIndex.Add( lead2 );
 
         FractureEdge* link = e_nearest->m_next;
 
@@ -475,9 +542,15 @@ static int processEdge( FractureEdgeSet& edges, FractureEdge* edge )
     return 0;
 }
 
+
+static bool compareEdgeX( const FractureEdge* aA, const FractureEdge* aB )
+{
+    return aA->m_p1.x < aB->m_p1.x;
+}
+
+
 void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 {
-    FractureEdgeSet edges;
     FractureEdgeSet border_edges;
     FractureEdge* root = NULL;
 
@@ -487,10 +560,30 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
         return;
 
     int num_unconnected = 0;
+    int num_points = 0;
+    int y_min = std::numeric_limits<int>::max();
+    int y_max = std::numeric_limits<int>::min();
+
+    BOOST_FOREACH( SHAPE_LINE_CHAIN& path, paths )
+    {
+        num_points += path.PointCount();
+
+        for( int i = 0; i < path.PointCount(); i++ )
+        {
+            y_min = std::min( y_min, path.CPoint( i ).y );
+            y_max = std::max( y_max, path.CPoint( i ).y );
+        }
+    }
+
+    // All the edges are allocated at once: one per point, and 3 more to connect each hole
+    std::vector<FractureEdge> pool;
+    pool.reserve( num_points + 3 * ( paths.size() - 1 ) );
+
+    FractureEdgeIndex index( y_min, y_max, pool.capacity() );
 
     BOOST_FOREACH( SHAPE_LINE_CHAIN& path, paths )
     {
-        int index = 0;
+        int index_in_path = 0;
 
         FractureEdge *prev = NULL, *first_edge = NULL;
 
@@ -506,7 +599,8 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 
         for( int i = 0; i < path.PointCount(); i++ )
         {
-            FractureEdge* fe = new FractureEdge( first, &path, index++ );
+            pool.push_back( FractureEdge( first, &path, index_in_path++ ) );
+            FractureEdge* fe = &pool.back();
 
             if( !root )
                 root = fe;
@@ -521,7 +615,7 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
                 fe->m_next = first_edge;
 
             prev = fe;
-            edges.push_back( fe );
+            index.Add( fe );
 
             if( !first )
             {
@@ -535,26 +629,16 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
         first = false; // first path is always the outline
     }
 
-    // keep connecting holes to the main outline, until there's no holes left...
-    while( num_unconnected > 0 )
-    {
-        int x_min = std::numeric_limits<int>::max();
-
-        FractureEdge* smallestX = NULL;
+    // Keep connecting holes to the main outline, from the left-most one, until there
+    // are no holes left.  A hole is connected at its first left-most edge: the sort
+    // is stable, and a hole is connected once, so its other edges are skipped.
+    std::stable_sort( border_edges.begin(), border_edges.end(), compareEdgeX );
 
-        // find the left-most hole edge and merge with the outline
-        for( FractureEdgeSet::iterator i = border_edges.begin(); i != border_edges.end(); ++i )
-        {
-            int xt = (*i)->m_p1.x;
-
-            if( ( xt < x_min ) && ! (*i)->m_connected )
-            {
-                x_min = xt;
-                smallestX = *i;
-            }
-        }
-
-        num_unconnected -= processEdge( edges, smallestX );
+    for( FractureEdgeSet::iterator i = border_edges.begin();
+         num_unconnected > 0 && i != border_edges.end(); ++i )
+    {
+        if( !(*i)->m_connected )
+            num_unconnected -= processEdge( index, pool, *i );
     }
 
     paths.clear();
@@ -569,9 +653,6 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 
     newPath.Append( e->m_p1 );
 
-    for( FractureEdgeSet::iterator i = edges.begin(); i != edges.end(); ++i )
-        delete *i;
-
     paths.push_back( newPath );
 }
 
@@ -579,6 +660,7 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 void SHAPE_POLY_SET::Fracture( POLYGON_MODE aFastMode )
 {
     Simplify( aFastMode ); // remove overlapping holes/degeneracy
+    invalidateIndex();
 
     BOOST_FOREACH( POLYGON& paths, m_polys )
     {
@@ -619,6 +701,8 @@ const std::string SHAPE_POLY_SET::Format() const
 
 bool SHAPE_POLY_SET::Parse( std::stringstream& aStream )
 {
+    invalidateIndex();
+
     std::string tmp;
 
     aStream >> tmp;
@@ -693,18 +777,24 @@ const BOX2I SHAPE_POLY_SET::BBox( int aClearance ) const
 
 void SHAPE_POLY_SET::RemoveAllContours()
 {
+    invalidateIndex();
     m_polys.clear();
 }
 
 
 void SHAPE_POLY_SET::DeletePolygon( int aIdx )
 {
+    // The other outlines are not modified: keep their index
+    if( aIdx < (int) m_outlineIndex.size() )
+        m_outlineIndex.erase( m_outlineIndex.begin() + aIdx );
+
     m_polys.erase( m_polys.begin() + aIdx );
 }
 
 
 void SHAPE_POLY_SET::Append( const SHAPE_POLY_SET& aSet )
 {
+    invalidateIndex();
     m_polys.insert( m_polys.end(), aSet.m_polys.begin(), aSet.m_polys.end() );
 }
 
@@ -715,6 +805,222 @@ void SHAPE_POLY_SET::Append( const VECTOR2I& aP, int aOutline, int aHole )
 }
 
 
+/**
+ * Function edgeCrossing
+ * is the test of one edge (aStart, aEnd) of the point in polygon algorithm, see
+ * "The Point in Polygon Problem for Arbitrary Polygons" by Hormann & Agathos
+ * @return -1 if aP is on the edge, 1 if the edge crosses the ray from aP to the right,
+ * 0 otherwise.
+ */
+static inline int edgeCrossing( const VECTOR2I& aP, const VECTOR2I& ip, const VECTOR2I& ipNext )
+{
+    if( ipNext.y == aP.y )
+    {
+        if( ( ipNext.x == aP.x ) || ( ip.y == aP.y &&
+            ( ( ipNext.x > aP.x ) == ( ip.x < aP.x ) ) ) )
+            return -1;
+    }
+
+    if( ( ip.y < aP.y ) != ( ipNext.y < aP.y ) )
+    {
+        if( ip.x >= aP.x )
+        {
+            if( ipNext.x > aP.x )
+                return 1;
+
+            int64_t d = (int64_t)( ip.x - aP.x ) * (int64_t)( ipNext.y - aP.y ) -
+                        (int64_t)( ipNext.x - aP.x ) * (int64_t)( ip.y - aP.y );
+
+            if( !d )
+                return -1;
+
+            if( ( d > 0 ) == ( ipNext.y > ip.y ) )
+                return 1;
+        }
+        else
+        {
+            if( ipNext.x > aP.x )
+            {
+                int64_t d = (int64_t)( ip.x - aP.x ) * (int64_t)( ipNext.y - aP.y ) -
+                            (int64_t)( ipNext.x - aP.x ) * (int64_t)( ip.y - aP.y );
+
+                if( !d )
+                    return -1;
+
+                if( ( d > 0 ) == ( ipNext.y > ip.y ) )
+                    return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+///> Outlines with less points are not indexed: walking all their edges is fast enough
+#define MIN_INDEXED_POINTS  32
+
+/**
+ * Struct OUTLINE_INDEX
+ * sorts the edges of an outline in horizontal strips: the edge i, from point i to
+ * point i + 1, is in all the strips its Y range overlaps.  Only the edges of the strip
+ * of a point can cross the horizontal ray from this point, or contain it.
+ */
+struct SHAPE_POLY_SET::OUTLINE_INDEX
+{
+    OUTLINE_INDEX( const SHAPE_LINE_CHAIN& aPath ) :
+        m_bbox( aPath.BBox() ),
+        m_hash( pointsHash( aPath ) )
+    {
+        int cnt = aPath.PointCount();
+
+        // About 8 edges per strip, if they are evenly spread
+        int64_t height = (int64_t) m_bbox.GetHeight() + 1;
+        int64_t count = std::min( std::max( cnt / 8, 1 ), 4096 );
+
+        m_yMin = m_bbox.GetY();
+        m_stripHeight = std::max( (int64_t) 1, ( height + count - 1 ) / count );
+        m_strips.resize( ( height + m_stripHeight - 1 ) / m_stripHeight );
+
+        for( int i = 0; i < cnt; i++ )
+        {
+            const VECTOR2I& p1 = aPath.CPoint( i );
+            const VECTOR2I& p2 = aPath.CPoint( i + 1 == cnt ? 0 : i + 1 );
+
+            int last = strip( std::max( p1.y, p2.y ) );
+
+            for( int s = strip( std::min( p1.y, p2.y ) ); s <= last; s++ )
+                m_strips[s].push_back( i );
+        }
+    }
+
+    int strip( int aY ) const
+    {
+        int64_t s = ( (int64_t) aY - m_yMin ) / m_stripHeight;
+
+        return (int) std::max( (int64_t) 0, std::min( s, (int64_t) m_strips.size() - 1 ) );
+    }
+
+    static uint64_t pointsHash( const SHAPE_LINE_CHAIN& aPath )
+    {
+        uint64_t hash = aPath.PointCount();
+
+        for( int i = 0; i < aPath.PointCount(); i++ )
+        {
+            hash = hash * 31 + (uint32_t) aPath.CPoint( i ).x;
+            hash = hash * 31 + (uint32_t) aPath.CPoint( i ).y;
+        }
+
+        return hash;
+    }
+
+    ///> Returns true if aPath is still the outline this index was built for
+    bool Matches( const SHAPE_LINE_CHAIN& aPath ) const
+    {
+        return pointsHash( aPath ) == m_hash;
+    }
+
+    BOX2I m_bbox;
+    uint64_t m_hash;
+    int m_yMin;
+    int64_t m_stripHeight;
+    std::vector< std::vector<int> > m_strips;
+};
+
+
+const SHAPE_POLY_SET::OUTLINE_INDEX* SHAPE_POLY_SET::outlineIndex( int aIndex ) const
+{
+    const SHAPE_LINE_CHAIN& path = m_polys[aIndex][0];
+
+    if( path.PointCount() < MIN_INDEXED_POINTS )
+        return NULL;
+
+    if( m_outlineIndex.size() != m_polys.size() )
+    {
+        m_outlineIndex.clear();
+        m_outlineIndex.resize( m_polys.size() );
+    }
+
+    if( !m_outlineIndex[aIndex] )
+        m_outlineIndex[aIndex].reset( new OUTLINE_INDEX( path ) );
+
+    // The outline must not be modified through a reference taken before the index
+    // was built (see the class comment)
+    assert( m_outlineIndex[aIndex]->Matches( path ) );
+
+    return m_outlineIndex[aIndex].get();
+}
+
+
+bool SHAPE_POLY_SET::collideOutlineEdges( int aIndex, const SEG& aSeg, int aClearance ) const
+{
+    const SHAPE_LINE_CHAIN& path = m_polys[aIndex][0];
+    const OUTLINE_INDEX* index = outlineIndex( aIndex );
+    int cnt = path.PointCount();
+
+    if( !index )
+    {
+        for( int i = 0; i < cnt; i++ )
+        {
+            SEG edge( path.CPoint( i ), path.CPoint( i + 1 == cnt ? 0 : i + 1 ) );
+
+            if( edge.Collide( aSeg, aClearance ) )
+                return true;
+        }
+
+        return false;
+    }
+
+    BOX2I area( aSeg.A, aSeg.B - aSeg.A );
+    area.Inflate( aClearance );
+
+    if( !index->m_bbox.Intersects( area ) )
+        return false;
+
+    // An edge close enough to aSeg overlaps in Y the area around aSeg, so it is
+    // in one of the strips of this area
+    int last = index->strip( area.GetBottom() );
+
+    for( int s = index->strip( area.GetY() ); s <= last; s++ )
+    {
+        const std::vector<int>& edges = index->m_strips[s];
+
+        for( unsigned jj = 0; jj < edges.size(); jj++ )
+        {
+            int i = edges[jj];
+            SEG edge( path.CPoint( i ), path.CPoint( i + 1 == cnt ? 0 : i + 1 ) );
+
+            if( edge.Collide( aSeg, aClearance ) )
+                return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool SHAPE_POLY_SET::Collide( const VECTOR2I& aP, int aClearance ) const
+{
+    return Collide( SEG( aP, aP ), aClearance );
+}
+
+
+bool SHAPE_POLY_SET::Collide( const SEG& aSeg, int aClearance ) const
+{
+    for( unsigned ii = 0; ii < m_polys.size(); ii++ )
+    {
+        if( m_polys[ii].size() == 0 )
+            continue;
+
+        // Either aSeg is inside the outline, or it is close to one of its edges
+        if( Contains( aSeg.A, ii ) || collideOutlineEdges( ii, aSeg, aClearance ) )
+            return true;
+    }
+
+    return false;
+}
+
+
 bool SHAPE_POLY_SET::Contains( const VECTOR2I& aP, int aSubpolyIndex ) const
 {
     // fixme: support holes!
@@ -722,15 +1028,52 @@ bool SHAPE_POLY_SET::Contains( const VECTOR2I& aP, int aSubpolyIndex ) const
     if( m_polys.size() == 0 ) // empty set?
         return false;
 
+    int first = 0;
+    int last = m_polys.size() - 1;
+
     if( aSubpolyIndex >= 0 )
-        return pointInPolygon( aP, m_polys[aSubpolyIndex][0] );
+        first = last = aSubpolyIndex;
 
-    BOOST_FOREACH ( const POLYGON& polys, m_polys )
+    for( int ii = first; ii <= last; ii++ )
     {
-        if( polys.size() == 0 )
+        if( m_polys[ii].size() == 0 )
             continue;
 
-        if( pointInPolygon( aP, polys[0] ) )
+        const SHAPE_LINE_CHAIN& path = m_polys[ii][0];
+        const OUTLINE_INDEX* index = outlineIndex( ii );
+
+        if( !index )
+        {
+            if( pointInPolygon( aP, path ) )
+                return true;
+
+            continue;
+        }
+
+        if( !index->m_bbox.Contains( aP ) )
+            continue;
+
+        // Same test as pointInPolygon(), restricted to the edges near aP
+        const std::vector<int>& edges = index->m_strips[index->strip( aP.y )];
+        int cnt = path.PointCount();
+        int result = 0;
+        bool on_edge = false;
+
+        for( unsigned jj = 0; jj < edges.size(); jj++ )
+        {
+            int i = edges[jj];
+            int crossing = edgeCrossing( aP, path.CPoint( i ), path.CPoint( i + 1 == cnt ? 0 : i + 1 ) );
+
+            if( crossing < 0 )
+            {
+                on_edge = true;
+                break;
+            }
+
+            result ^= crossing;
+        }
+
+        if( on_edge || result )
             return true;
     }
 
@@ -755,46 +1098,12 @@ bool SHAPE_POLY_SET::pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN&
     {
         VECTOR2I ipNext = ( i == cnt ? aPath.CPoint( 0 ) : aPath.CPoint( i ) );
 
-        if( ipNext.y == aP.y )
-        {
-            if( ( ipNext.x == aP.x ) || ( ip.y == aP.y &&
-                ( ( ipNext.x > aP.x ) == ( ip.x < aP.x ) ) ) )
-                return true;
-        }
-
-        if( ( ip.y < aP.y ) != ( ipNext.y < aP.y ) )
-        {
-            if( ip.x >= aP.x )
-            {
-                if( ipNext.x > aP.x )
-                    result = 1 - result;
-                else
-                {
-                    int64_t d = (int64_t)( ip.x - aP.x ) * (int64_t)( ipNext.y - aP.y ) -
-                                (int64_t)( ipNext.x - aP.x ) * (int64_t)( ip.y - aP.y );
-
-                    if( !d )
-                        return true;
-
-                    if( ( d > 0 ) == ( ipNext.y > ip.y ) )
-                        result = 1 - result;
-                }
-            }
-            else
-            {
-                if( ipNext.x > aP.x )
-                {
-                    int64_t d = (int64_t)( ip.x - aP.x ) * (int64_t)( ipNext.y - aP.y ) -
-                                (int64_t)( ipNext.x - aP.x ) * (int64_t)( ip.y - aP.y );
+        int crossing = edgeCrossing( aP, ip, ipNext );
 
-                if( !d )
-                    return true;
+        if( crossing < 0 )
+            return true;
 
-                if( ( d > 0 ) == ( ipNext.y > ip.y ) )
-                    result = 1 - result;
-                }
-            }
-        }
+        result ^= crossing;
 
         ip = ipNext;
     }
@@ -805,6 +1114,8 @@ bool SHAPE_POLY_SET::pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN&
 
 void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 {
+    invalidateIndex();
+
     BOOST_FOREACH( POLYGON &poly, m_polys )
     {
         BOOST_FOREACH( SHAPE_LINE_CHAIN &path, poly )
@@ -188,6 +188,8 @@ char* StrPurge( char* text )
 
 char* GetLine( FILE* File, char* Line, int* LineNum, int SizeLine )
 {
+    char* saveptr;
+
     do {
         if( fgets( Line, SizeLine, File ) == NULL )
             return NULL;
@@ -197,7 +199,7 @@ char* GetLine( FILE* File, char* Line, int* LineNum, int SizeLine )
 
     } while( Line[0] == '#' || Line[0] == '\n' ||  Line[0] == '\r' || Line[0] == 0 );
 
-    strtok( Line, "\n\r" );
+    strtok_r( Line, "\n\r", &saveptr );
     return Line;
 }
 
@@ -54,6 +54,13 @@ void SCH_EDIT_FRAME::DeleteAnnotation( bool aCurrentSheetOnly )
     m_CurrentSheet->Last()->UpdateAllScreenReferences();
     GetCanvas()->Refresh();
     OnModify();
+
+    if( !aCurrentSheetOnly )
+    {
+        // The references have changed in all the sheets, and so can the net names
+        SCH_SCREENS screens;
+        screens.ConnectivityChanged();
+    }
 }
 
 
@@ -176,6 +183,10 @@ void SCH_EDIT_FRAME::AnnotateComponents( bool              aAnnotateSchematic,
 
     OnModify();
 
+    // The references and the units of the components of any sheet can have changed,
+    // and so can the pins and the names of the nets
+    screens.ConnectivityChanged();
+
     // Update on screen references, that can be modified by previous calculations:
     m_CurrentSheet->Last()->UpdateAllScreenReferences();
     SetSheetNumberAndCount();
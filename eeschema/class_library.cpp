@@ -620,13 +620,14 @@ void PART_LIB::LoadAliases( LIB_PART* aPart )
 bool PART_LIB::LoadHeader( LINE_READER& aLineReader )
 {
     char* line, * text, * data;
+    char* saveptr;
 
     while( aLineReader.ReadLine() )
     {
         line = (char*) aLineReader;
 
-        text = strtok( line, " \t\r\n" );
-        data = strtok( NULL, " \t\r\n" );
+        text = strtok_r( line, " \t\r\n", &saveptr );
+        data = strtok_r( NULL, " \t\r\n", &saveptr );
 
         if( stricmp( text, "TimeStamp" ) == 0 )
             timeStamp = atol( data );
@@ -643,6 +644,7 @@ bool PART_LIB::LoadDocs( wxString& aErrorMsg )
 {
     int        lineNumber = 0;
     char       line[8000], * name, * text;
+    char*      saveptr;
     LIB_ALIAS* entry;
     FILE*      file;
     wxFileName fn = fileName;
@@ -684,7 +686,7 @@ bool PART_LIB::LoadDocs( wxString& aErrorMsg )
         }
 
         // Read one $CMP/$ENDCMP part entry from library:
-        name = strtok( line + 5, "\n\r" );
+        name = strtok_r( line + 5, "\n\r", &saveptr );
 
         wxString cmpname = FROM_UTF8( name );
 
@@ -695,7 +697,7 @@ bool PART_LIB::LoadDocs( wxString& aErrorMsg )
             if( strncmp( line, "$ENDCMP", 7 ) == 0 )
                 break;
 
-            text = strtok( line + 2, "\n\r" );
+            text = strtok_r( line + 2, "\n\r", &saveptr );
 
             if( entry )
             {
@@ -798,31 +800,86 @@ bool PART_LIB::SaveHeader( OUTPUTFORMATTER& aFormatter )
 }
 
 
-PART_LIB* PART_LIB::LoadLibrary( const wxString& aFileName ) throw( IO_ERROR, boost::bad_pointer )
+/**
+ * Function fileState
+ * @return a string changed when \a aFile is modified (its size and modification time),
+ *         or an empty string if it does not exist.
+ */
+static wxString fileState( const wxFileName& aFile )
 {
-    std::auto_ptr<PART_LIB> lib( new PART_LIB( LIBRARY_TYPE_EESCHEMA, aFileName ) );
+    if( !aFile.FileExists() )
+        return wxEmptyString;
+
+    return wxString::Format( wxT( "%s %ld" ), GetChars( aFile.GetSize().ToString() ),
+                             (long) aFile.GetModificationTime().GetTicks() );
+}
+
+
+/**
+ * Function libraryState
+ * @return the state of the part library \a aFileName and of its document file.
+ */
+static wxString libraryState( const wxString& aFileName )
+{
+    wxFileName fn( aFileName );
+    wxString   state = fileState( fn );
+
+    if( state.IsEmpty() )
+        return wxEmptyString;
 
+    fn.SetExt( DOC_EXT );
+
+    return state + wxT( ";" ) + fileState( fn );
+}
+
+
+PART_LIB* PART_LIB::LoadLibrary( const wxString& aFileName ) throw( IO_ERROR, boost::bad_pointer )
+{
     wxBusyCursor ShowWait;
 
     wxString errorMsg;
 
-    if( !lib->Load( errorMsg ) )
+    PART_LIB* ret = ParseLibrary( aFileName, errorMsg );
+
+    if( !ret )
         THROW_IO_ERROR( errorMsg );
 
+    return ret;
+}
+
+
+PART_LIB* PART_LIB::ParseLibrary( const wxString& aFileName, wxString& aErrorMsg )
+{
+    std::auto_ptr<PART_LIB> lib( new PART_LIB( LIBRARY_TYPE_EESCHEMA, aFileName ) );
+
+    // Read before the files, so a file modified while it is read is seen as changed
+    lib->m_fileState = libraryState( aFileName );
+
+    try
+    {
+        if( !lib->Load( aErrorMsg ) )
+            return NULL;
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        // No exception can leave a worker thread
+        aErrorMsg = ioe.errorText;
+        return NULL;
+    }
+
     if( USE_OLD_DOC_FILE_FORMAT( lib->versionMajor, lib->versionMinor ) )
     {
 #if 1
         // not fatal if error here.
-        lib->LoadDocs( errorMsg );
+        wxString docErrorMsg;
+        lib->LoadDocs( docErrorMsg );
 #else
-        if( !lib->LoadDocs( errorMsg ) )
-            THROW_IO_ERROR( errorMsg );
+        if( !lib->LoadDocs( aErrorMsg ) )
+            return NULL;
 #endif
     }
 
-    PART_LIB* ret = lib.release();
-
-    return ret;
+    return lib.release();
 }
 
 
@@ -1007,6 +1064,83 @@ void PART_LIBS::FindLibraryNearEntries( std::vector<LIB_ALIAS*>& aCandidates,
 int PART_LIBS::s_modify_generation = 1;     // starts at 1 and goes up
 
 
+/// False after ClearParsedLibraries(): the libraries of the containers deleted later,
+/// at exit, are not kept.
+static bool s_keepParsedLibs = true;
+
+
+/**
+ * Function parsedLibs
+ * @return the libraries of the deleted PART_LIBS containers, which can be used again
+ *         while their files do not change.  The list is never destroyed, so it can be
+ *         used by the containers deleted during the static destruction.
+ */
+static PART_LIBS_BASE& parsedLibs()
+{
+    static PART_LIBS_BASE* libs = new PART_LIBS_BASE;
+
+    return *libs;
+}
+
+
+PART_LIBS::~PART_LIBS()
+{
+    unsigned ii = 0;
+
+    while( ii < size() )
+    {
+        PART_LIB& lib = at( ii );
+
+        // The cache library is rewritten with the schematic, and the modified
+        // libraries are not the same as their files.
+        if( !s_keepParsedLibs || lib.IsModified() || lib.IsCache()
+            || lib.m_fileState.IsEmpty() )
+            ii++;
+        else
+            parsedLibs().push_back( release( begin() + ii ).release() );
+    }
+}
+
+
+void PART_LIBS::ClearParsedLibraries()
+{
+    s_keepParsedLibs = false;
+    parsedLibs().clear();
+}
+
+
+PART_LIB* PART_LIBS::takeParsedLibrary( const wxString& aFileName )
+{
+    wxString fullPath = wxFileName( aFileName ).GetFullPath();
+    wxString state;
+
+    PART_LIBS_BASE& libs = parsedLibs();
+
+    for( unsigned ii = 0; ii < libs.size(); ii++ )
+    {
+        PART_LIB& lib = libs[ii];
+
+        if( lib.GetFullFileName() != fullPath )
+            continue;
+
+        if( state.IsEmpty() )
+            state = libraryState( aFileName );
+
+        if( state.IsEmpty() || lib.m_fileState != state )
+            continue;
+
+        PART_LIB* ret = libs.release( libs.begin() + ii ).release();
+
+        // Like a library just read, so the components are linked to its parts again
+        ret->m_mod_hash = s_modify_generation;
+
+        return ret;
+    }
+
+    return NULL;
+}
+
+
 int PART_LIBS::GetModifyHash()
 {
     int hash = 0;
@@ -1123,6 +1257,8 @@ void PART_LIBS::LoadAllLibraries( PROJECT* aProject ) throw( IO_ERROR, boost::ba
 
     wxASSERT( !size() );    // expect to load into "this" empty container.
 
+    std::vector<wxString> filenames;
+
     for( unsigned i = 0; i < lib_names.GetCount();  ++i )
     {
         fn.Clear();
@@ -1149,21 +1285,64 @@ void PART_LIBS::LoadAllLibraries( PROJECT* aProject ) throw( IO_ERROR, boost::ba
             filename = fn.GetFullPath();
         }
 
-        try
+        // Don't load the library twice, see AddLibrary().
+        bool loaded = false;
+
+        for( unsigned ii = 0; ii < filenames.size() && !loaded; ii++ )
+            loaded = wxFileName( filenames[ii] ).GetName() == fn.GetName();
+
+        if( !loaded )
+            filenames.push_back( filename );
+    }
+
+    std::vector<PART_LIB*> libs( filenames.size(), (PART_LIB*) NULL );
+    std::vector<wxString>  errors( filenames.size() );
+    bool                   toRead = false;
+
+    for( unsigned ii = 0; ii < filenames.size(); ii++ )
+    {
+        libs[ii] = takeParsedLibrary( filenames[ii] );
+
+        if( !libs[ii] )
+            toRead = true;
+    }
+
+    // The libraries not used by this project
+    parsedLibs().clear();
+
+    if( toRead )
+    {
+        wxBusyCursor ShowWait;
+
+        // The libraries are independent, they are read in parallel.
+#ifdef USE_OPENMP
+        #pragma omp parallel for schedule( dynamic, 1 )
+#endif
+        for( int ii = 0; ii < (int) filenames.size(); ii++ )
         {
-            AddLibrary( filename );
+            if( !libs[ii] )
+                libs[ii] = PART_LIB::ParseLibrary( filenames[ii], errors[ii] );
         }
-        catch( const IO_ERROR& ioe )
+    }
+
+    for( unsigned ii = 0; ii < libs.size(); ii++ )
+    {
+        if( !libs[ii] )
         {
+            for( unsigned jj = ii + 1; jj < libs.size(); jj++ )
+                delete libs[jj];
+
             wxString msg = wxString::Format( _(
                     "Part library '%s' failed to load. Error:\n"
                     "%s" ),
-                    GetChars( filename ),
-                    GetChars( ioe.errorText )
+                    GetChars( filenames[ii] ),
+                    GetChars( errors[ii] )
                     );
 
             THROW_IO_ERROR( msg );
         }
+
+        push_back( libs[ii] );
     }
 
     // add the special cache library.
@@ -197,6 +197,13 @@ public:
         ++s_modify_generation;
     }
 
+    /**
+     * Destructor
+     * keeps the libraries which are unchanged since they were read, so the next
+     * LoadAllLibraries() can use them instead of reading their files again.
+     */
+    ~PART_LIBS();
+
     /// Return the modification hash for all libraries.  The value returned
     /// changes on every library modification.
     int GetModifyHash();
@@ -236,9 +243,21 @@ public:
      * Function LoadAllLibraries
      * loads all of the project's libraries into this container, which should
      * be cleared before calling it.
+     * <p>
+     * The libraries kept by a previous container are used again when the size and the
+     * modification time of their files have not changed.  The other ones are read in
+     * parallel.
+     * </p>
      */
     void LoadAllLibraries( PROJECT* aProject ) throw( IO_ERROR, boost::bad_pointer );
 
+    /**
+     * Function ClearParsedLibraries
+     * deletes the libraries kept by the deleted containers, and stops keeping them.
+     * To be called when eeschema is unloaded, before the projects are deleted.
+     */
+    static void ClearParsedLibraries();
+
     /**
      * Function LibNamesAndPaths
      * either saves or loads the names of the currently configured part libraries
@@ -334,6 +353,13 @@ public:
 
     int GetLibraryCount() { return size(); }
 
+private:
+    /**
+     * Function takeParsedLibrary
+     * @return the library of \a aFileName kept by a deleted container, if its files have
+     *         not changed since it was read (owned by the caller), or NULL.
+     */
+    static PART_LIB* takeParsedLibrary( const wxString& aFileName );
 };
 
 
@@ -355,6 +381,7 @@ class PART_LIB
     bool            isModified;     ///< Library modification status.
     LIB_ALIAS_MAP   m_amap;         ///< Map of alias objects associated with the library.
     int             m_mod_hash;     ///< incremented each time library is changed.
+    wxString        m_fileState;    ///< size and modification time of the files when read
 
     friend class LIB_PART;
     friend class PART_LIBS;
@@ -652,6 +679,18 @@ public:
      */
     static PART_LIB* LoadLibrary( const wxString& aFileName ) throw( IO_ERROR, boost::bad_pointer );
 
+    /**
+     * Function ParseLibrary
+     * allocates and loads a part library file, like LoadLibrary(), but without any
+     * UI call, so it can be used by a worker thread.
+     *
+     * @param aFileName - File name of the part library to load.
+     * @param aErrorMsg - Error message if load fails.
+     * @return PART_LIB* - the allocated and loaded PART_LIB, which is owned by
+     *   the caller, or NULL if the library could not be loaded.
+     */
+    static PART_LIB* ParseLibrary( const wxString& aFileName, wxString& aErrorMsg );
+
     /**
      * Function HasPowerParts
      * @return true if at least one power part is found in lib
@@ -36,7 +36,12 @@
 #include <lib_pin.h>      // LIB_PIN::PinStringNum( m_PinNum )
 #include <sch_item_struct.h>
 
+#include <algorithm>
+
 class NETLIST_OBJECT_LIST;
+class NETLIST_SHEET_INDEX;
+class NETLIST_LABEL_INDEX;
+class NETLIST_LABEL_GROUP;
 class SCH_COMPONENT;
 
 
@@ -176,6 +181,8 @@ public:
      */
     bool HasNetNameCandidate() { return m_netNameCandidate != NULL; }
 
+    NETLIST_OBJECT* GetNetNameCandidate() const { return m_netNameCandidate; }
+
     /**
      * Function GetPinNum
      * returns a pin number in wxString form.  Pin numbers are not always
@@ -265,6 +272,83 @@ public:
 typedef std::vector<NETLIST_OBJECT*>    NETLIST_OBJECTS;
 
 
+/**
+ * Class NET_CODE_SETS
+ * is a disjoint-set forest of the net codes created while building a netlist.
+ * Merging a net code into another one gives the items of both the code of the second,
+ * exactly as relabelling all of them would, but in almost constant time.
+ */
+class NET_CODE_SETS
+{
+public:
+    void Clear()
+    {
+        m_parent.clear();
+        m_code.clear();
+        m_rank.clear();
+    }
+
+    /**
+     * Function Find
+     * @return the net code now carried by the items created with \a aCode
+     * (0, i.e. not yet connected, is left unchanged)
+     */
+    int Find( int aCode )
+    {
+        if( aCode <= 0 )
+            return aCode;
+
+        return m_code[ root( aCode ) ];
+    }
+
+    /**
+     * Function Merge
+     * gives the net code \a aNewCode to all items having the net code \a aOldCode
+     */
+    void Merge( int aOldCode, int aNewCode )
+    {
+        int oldRoot = root( aOldCode );
+        int newRoot = root( aNewCode );
+
+        if( oldRoot == newRoot )
+            return;
+
+        int code = m_code[newRoot];
+
+        if( m_rank[oldRoot] > m_rank[newRoot] )
+            std::swap( oldRoot, newRoot );
+        else if( m_rank[oldRoot] == m_rank[newRoot] )
+            m_rank[newRoot]++;
+
+        m_parent[oldRoot] = newRoot;
+        m_code[newRoot] = code;
+    }
+
+private:
+    int root( int aCode )
+    {
+        while( (int) m_parent.size() <= aCode )
+        {
+            m_parent.push_back( m_parent.size() );
+            m_code.push_back( m_code.size() );
+            m_rank.push_back( 0 );
+        }
+
+        while( m_parent[aCode] != aCode )
+        {
+            m_parent[aCode] = m_parent[ m_parent[aCode] ];     // path halving
+            aCode = m_parent[aCode];
+        }
+
+        return aCode;
+    }
+
+    std::vector<int> m_parent;      // parent of each net code in its tree
+    std::vector<int> m_code;        // net code given to the items of a tree, stored at its root
+    std::vector<int> m_rank;
+};
+
+
 /**
  * Class NETLIST_OBJECT_LIST
  * is a container holding and _owning_ NETLIST_OBJECTs, which are connected items
@@ -275,6 +359,8 @@ class NETLIST_OBJECT_LIST : public NETLIST_OBJECTS
     int m_lastNetCode;      // Used in intermediate calculation: last net code created
     int m_lastBusNetCode;   // Used in intermediate calculation:
                             // last net code created for bus members
+    NET_CODE_SETS m_netCodes;       // Used in intermediate calculation: merged net codes
+    NET_CODE_SETS m_busNetCodes;    // Used in intermediate calculation: merged bus net codes
 
 public:
     /**
@@ -304,6 +390,21 @@ public:
      */
     bool BuildNetListInfo( SCH_SHEET_LIST& aSheets );
 
+    /**
+     * Function ConnectItems
+     * the second part of BuildNetListInfo(): builds the nets of the objects
+     * already in the list, and gives them their net codes and net names
+     * @return true if OK, false is not item found
+     */
+    bool ConnectItems();
+
+    /**
+     * Function AppendCopies
+     * appends to the list a copy of each object of \a aSource
+     * (the net name candidates are copied too)
+     */
+    void AppendCopies( const NETLIST_OBJECT_LIST& aSource );
+
     /**
      * Acces to an item in list
      */
@@ -412,15 +513,40 @@ private:
      * Propagate aNewNetCode to items having an internal netcode aOldNetCode
      * used to interconnect group of items already physically connected,
      * when a new connection is found between aOldNetCode and aNewNetCode
+     * The codes are only merged in m_netCodes (or m_busNetCodes): use netCode()
+     * and busNetCode() to read the code of an item while building the netlist.
      */
     void propageNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus );
 
+    /// @return the current net code of \a aItem, while building the netlist
+    int netCode( const NETLIST_OBJECT* aItem )
+    {
+        return m_netCodes.Find( aItem->GetNet() );
+    }
+
+    /// @return the current bus net code of \a aItem, while building the netlist
+    int busNetCode( const NETLIST_OBJECT* aItem )
+    {
+        return m_busNetCodes.Find( aItem->m_BusNetCode );
+    }
+
+    /*
+     * Connect aItem (and all the items already connected to it) to the net
+     * (or the bus if aIsBus is true) aNetCode
+     */
+    void connectToNet( NETLIST_OBJECT* aItem, int aNetCode, bool aIsBus );
+
+    /*
+     * Connect all the labels of aGroup to the net aNetCode
+     */
+    void connectLabelGroup( NETLIST_LABEL_GROUP* aGroup, int aNetCode );
+
     /*
      * This function merges the net codes of groups of objects already connected
      * to labels (wires, bus, pins ... ) when 2 labels are equivalents
      * (i.e. group objects connected by labels)
      */
-    void labelConnect( NETLIST_OBJECT* aLabelRef );
+    void labelConnect( NETLIST_OBJECT* aLabelRef, NETLIST_LABEL_INDEX& aLabels );
 
     /* Comparison function to sort by increasing Netcode the list of connected items
      */
@@ -440,18 +566,23 @@ private:
      * Propagate net codes from a parent sheet to an include sheet,
      * from a pin sheet connection
      */
-    void sheetLabelConnect( NETLIST_OBJECT* aSheetLabel );
+    void sheetLabelConnect( NETLIST_OBJECT* aSheetLabel, NETLIST_LABEL_INDEX& aLabels );
 
-    void pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus, int start );
+    /*
+     * Search the objects of the sheet of aRef having an end at one of its ends
+     * (found in aSheet, the index of this sheet)
+     */
+    void pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus,
+                              const NETLIST_SHEET_INDEX& aSheet );
 
     /*
      * Search connections betweena junction and segments
      * Propagate the junction net code to objects connected by this junction.
      * The junction must have a valid net code
-     * The list of objects is expected sorted by sheets.
-     * Search is done from index aIdxStart to the last element of list
+     * The segments are searched in aSheet, the index of the sheet of the junction
      */
-    void segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus, int aIdxStart );
+    void segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus,
+                                const NETLIST_SHEET_INDEX& aSheet );
 
     void connectBusLabels();
 
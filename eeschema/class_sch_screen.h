@@ -38,6 +38,7 @@
 #include <class_page_info.h>
 #include <kiway_player.h>
 #include <sch_marker.h>
+#include <sch_item_index.h>
 
 #include <../eeschema/general.h>
 
@@ -86,6 +87,30 @@ private:
     int     m_modification_sync;        ///< inequality with PART_LIBS::GetModificationHash()
                                         ///< will trigger ResolveAll().
 
+    unsigned m_connectivityRevision;    ///< changed each time the connections of the items
+                                        ///< can have changed, see ConnectivityChanged()
+
+    static unsigned s_connectivityGeneration;   ///< last revision given to a screen
+
+    mutable SCH_ITEM_INDEX m_itemIndex;         ///< items of m_drawList by position
+    mutable bool           m_itemIndexValid;    ///< false when m_itemIndex must be built again
+
+    /**
+     * Function getItemIndex
+     * builds the index of the draw items if the list has changed since it was built.
+     * @return the index, or NULL if it cannot be used because an item or a block is
+     *         being edited (the edited items can be moved without the screen knowing it).
+     */
+    const SCH_ITEM_INDEX* getItemIndex() const;
+
+    /**
+     * Function getItemsAt
+     * gives the draw items which can be hit or connected at \a aPosition, in the order
+     * of the draw list.  All the items are given when the index cannot be used.
+     */
+    void getItemsAt( const wxPoint& aPosition, int aAccuracy,
+                     std::vector< SCH_ITEM* >& aItems ) const;
+
     /**
      * Function addConnectedItemsToBlock
      * add items connected at \a aPosition to the block pick list.
@@ -142,6 +167,11 @@ public:
     {
         m_drawList.Append( aItem );
         --m_modification_sync;
+
+        if( aItem->Type() != SCH_MARKER_T )
+            ConnectivityChanged();
+        else
+            m_itemIndexValid = false;
     }
 
     /**
@@ -154,8 +184,27 @@ public:
     {
         m_drawList.Append( aList );
         --m_modification_sync;
+        ConnectivityChanged();
     }
 
+    /**
+     * Function ConnectivityChanged
+     * tells the screen that items have been added, moved, modified or removed, so
+     * the connections computed from its items (see SCH_CONNECTIVITY) must be updated.
+     */
+    void ConnectivityChanged()
+    {
+        m_connectivityRevision = ++s_connectivityGeneration;
+        m_itemIndexValid = false;
+    }
+
+    /**
+     * Function GetConnectivityRevision
+     * @return a number changed by each call to ConnectivityChanged(), which is never
+     * given to another screen.
+     */
+    unsigned GetConnectivityRevision() const    { return m_connectivityRevision; }
+
     /**
      * Function GetCurItem
      * returns the currently selected SCH_ITEM, overriding BASE_SCREEN::GetCurItem().
@@ -556,6 +605,13 @@ public:
      */
     void SchematicCleanUp();
 
+    /**
+     * Function ConnectivityChanged
+     * calls SCH_SCREEN::ConnectivityChanged() for all the screens of the hierarchy,
+     * after a change affecting all of them (like the annotation of the components).
+     */
+    void ConnectivityChanged();
+
     /**
      * Function ReplaceDuplicateTimeStamps
      * test all sheet and component objects in the schematic for duplicate time stamps
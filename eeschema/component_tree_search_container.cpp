@@ -24,9 +24,15 @@
 #include <component_tree_search_container.h>
 
 #include <algorithm>
+#include <iterator>
 #include <boost/foreach.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 #include <set>
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
 #include <wx/string.h>
 #include <wx/tokenzr.h>
 #include <wx/treectrl.h>
@@ -44,6 +50,9 @@
 // result is very unspecific.
 static const unsigned kLowestDefaultScore = 1;
 
+// Below this number of candidates, starting the threads costs more than scoring them.
+static const unsigned kParallelScoreMinimum = 2000;
+
 struct COMPONENT_TREE_SEARCH_CONTAINER::TREE_NODE
 {
     // Levels of nodes.
@@ -108,6 +117,8 @@ COMPONENT_TREE_SEARCH_CONTAINER::COMPONENT_TREE_SEARCH_CONTAINER( PART_LIBS* aLi
       m_libs( aLibs ),
       m_filter( CMP_FILTER_NONE )
 {
+    m_indexValid = false;
+    m_lastMatchesValid = false;
 }
 
 
@@ -198,6 +209,7 @@ void COMPONENT_TREE_SEARCH_CONTAINER::AddAliasList( const wxString& aNodeName,
         TREE_NODE* alias_node = new TREE_NODE( TREE_NODE::TYPE_ALIAS, lib_node,
                                                a, a->GetName(), display_info, search_text );
         m_nodes.push_back( alias_node );
+        m_aliases.push_back( alias_node );
 
         if( a->GetPart()->IsMulti() )    // Add all units as sub-nodes.
         {
@@ -216,6 +228,9 @@ void COMPONENT_TREE_SEARCH_CONTAINER::AddAliasList( const wxString& aNodeName,
 
         ++m_components_added;
     }
+
+    m_indexValid = false;
+    m_lastMatchesValid = false;
 }
 
 
@@ -321,6 +336,171 @@ private:
 }
 
 
+// Returns true if aSearch has no regular expression or wildcard syntax: then, all
+// the matchers find its terms as plain substrings only.
+static bool isPlainSearch( const wxString& aSearch )
+{
+    const wxString pattern_chars = wxT( ".*+?^${}()|[]\\" );
+
+    for( wxString::const_iterator it = aSearch.begin(); it != aSearch.end(); ++it )
+    {
+        if( pattern_chars.Find( *it ) != wxNOT_FOUND )
+            return false;
+    }
+
+    return true;
+}
+
+
+void COMPONENT_TREE_SEARCH_CONTAINER::addTrigrams( const wxString& aText, unsigned aAlias )
+{
+    for( size_t pos = 0; pos + 3 <= aText.length(); ++pos )
+    {
+        std::vector<unsigned>& aliases = m_trigrams[ aText.Mid( pos, 3 ) ];
+
+        // The aliases are added in increasing order: the lists stay sorted.
+        if( aliases.empty() || aliases.back() != aAlias )
+            aliases.push_back( aAlias );
+    }
+}
+
+
+void COMPONENT_TREE_SEARCH_CONTAINER::buildIndex()
+{
+    m_trigrams.clear();
+
+    // A term matches an alias if it is found in its name, its library name or
+    // its search text. Trigrams overlapping two of them are not indexed.
+    for( unsigned i = 0; i < m_aliases.size(); ++i )
+    {
+        const TREE_NODE* node = m_aliases[i];
+
+        addTrigrams( node->MatchName, i );
+        addTrigrams( node->Parent->MatchName, i );
+        addTrigrams( node->SearchText, i );
+    }
+
+    m_indexValid = true;
+}
+
+
+static bool shorterList( const std::vector<unsigned>* a1, const std::vector<unsigned>* a2 )
+{
+    return a1->size() < a2->size();
+}
+
+
+void COMPONENT_TREE_SEARCH_CONTAINER::narrowCandidates( const wxString& aTerm,
+                                                        std::vector<unsigned>& aCandidates ) const
+{
+    std::vector<const std::vector<unsigned>*> lists;
+
+    for( size_t pos = 0; pos + 3 <= aTerm.length(); ++pos )
+    {
+        TRIGRAM_MAP::const_iterator it = m_trigrams.find( aTerm.Mid( pos, 3 ) );
+
+        if( it == m_trigrams.end() )
+        {
+            aCandidates.clear();    // No alias contains this trigram.
+            return;
+        }
+
+        lists.push_back( &it->second );
+    }
+
+    // Intersect the shortest lists first, the next intersections are then quicker.
+    std::sort( lists.begin(), lists.end(), shorterList );
+
+    std::vector<unsigned> found;
+
+    for( unsigned i = 0; i < lists.size() && !aCandidates.empty(); ++i )
+    {
+        found.clear();
+        std::set_intersection( aCandidates.begin(), aCandidates.end(),
+                               lists[i]->begin(), lists[i]->end(),
+                               std::back_inserter( found ) );
+        aCandidates.swap( found );
+    }
+}
+
+
+void COMPONENT_TREE_SEARCH_CONTAINER::scoreTerm( const wxString& aTerm,
+                                                 std::vector<unsigned>& aCandidates )
+{
+    int threads = 1;
+
+#ifdef USE_OPENMP
+    if( aCandidates.size() >= kParallelScoreMinimum )
+        threads = omp_get_max_threads();
+#endif
+
+    // wxRegEx keeps the result of its last match, so a matcher can't be shared by
+    // several threads.
+    boost::ptr_vector<EDA_COMBINED_MATCHER> matchers;
+
+    for( int i = 0; i < threads; ++i )
+        matchers.push_back( new EDA_COMBINED_MATCHER( aTerm ) );
+
+#ifdef USE_OPENMP
+    #pragma omp parallel for num_threads( threads ) schedule( dynamic, 256 )
+#endif
+    for( int i = 0; i < (int) aCandidates.size(); ++i )
+    {
+#ifdef USE_OPENMP
+        EDA_COMBINED_MATCHER& matcher = matchers[omp_get_thread_num()];
+#else
+        EDA_COMBINED_MATCHER& matcher = matchers[0];
+#endif
+        TREE_NODE* node = m_aliases[aCandidates[i]];
+
+        // Keywords and description we only count if the match string is at
+        // least two characters long. That avoids spurious, low quality
+        // matches. Most abbreviations are at three characters long.
+        int found_pos;
+        int matcher_fired = 0;
+
+        if( aTerm == node->MatchName )
+            node->MatchScore += 1000;  // exact match. High score :)
+        else if( (found_pos = matcher.Find( node->MatchName, &matcher_fired ) ) != EDA_PATTERN_NOT_FOUND )
+        {
+            // Substring match. The earlier in the string the better.  score += 20..40
+            node->MatchScore += matchPosScore( found_pos, 20 ) + 20;
+        }
+        else if( matcher.Find( node->Parent->MatchName, &matcher_fired ) != EDA_PATTERN_NOT_FOUND )
+            node->MatchScore += 19;   // parent name matches.         score += 19
+        else if( ( found_pos = matcher.Find( node->SearchText, &matcher_fired ) ) != EDA_PATTERN_NOT_FOUND )
+        {
+            // If we have a very short search term (like one or two letters), we don't want
+            // to accumulate scores if they just happen to be in keywords or description as
+            // almost any one or two-letter combination shows up in there.
+            // For longer terms, we add scores 1..18 for positional match (higher in the
+            // front, where the keywords are).                        score += 0..18
+            node->MatchScore += ( ( aTerm.length() >= 2 )
+                                   ? matchPosScore( found_pos, 17 ) + 1
+                                   : 0 );
+        }
+        else
+        {
+            node->MatchScore = 0;    // No match. That's it for this item.
+            continue;
+        }
+
+        node->MatchScore += 2 * matcher_fired;
+    }
+
+    // Leaf nodes without score are out of the game for the next terms.
+    unsigned count = 0;
+
+    for( unsigned i = 0; i < aCandidates.size(); ++i )
+    {
+        if( m_aliases[aCandidates[i]]->MatchScore > 0 )
+            aCandidates[count++] = aCandidates[i];
+    }
+
+    aCandidates.resize( count );
+}
+
+
 void COMPONENT_TREE_SEARCH_CONTAINER::UpdateSearchTerm( const wxString& aSearch )
 {
     if( m_tree == NULL )
@@ -332,16 +512,55 @@ void COMPONENT_TREE_SEARCH_CONTAINER::UpdateSearchTerm( const wxString& aSearch
 #endif
 
     // We score the list by going through it several time, essentially with a complexity
-    // of O(n). For the default library of 2000+ items, this typically takes less than 5ms
-    // on an i5. Good enough, no index needed.
+    // of O(n). With large libraries, the candidates are first narrowed down with the
+    // trigram index and the matches of the previous search, and only these are scored.
 
-    // Initial AND condition: Leaf nodes are considered to match initially.
+    // The candidate aliases get the lowest score below, the other ones are out.
     BOOST_FOREACH( TREE_NODE* node, m_nodes )
     {
         node->PreviousScore = node->MatchScore;
-        node->MatchScore = ( node->Type == TREE_NODE::TYPE_LIB ) ? 0 : kLowestDefaultScore;
+        node->MatchScore = 0;
     }
 
+    std::vector<wxString> terms;
+    wxStringTokenizer tokenizer( aSearch );
+
+    while ( tokenizer.HasMoreTokens() )
+        terms.push_back( tokenizer.GetNextToken().Lower() );
+
+    // When typing, the search string extends the previous one. With plain substring
+    // terms, it can only match the aliases matching the previous one. Pattern syntax
+    // added to a term ("r" -> "r|c") can match more aliases.
+    std::vector<unsigned> candidates;
+
+    if( m_lastMatchesValid && aSearch.StartsWith( m_lastSearch )
+        && isPlainSearch( m_lastSearch ) && isPlainSearch( aSearch ) )
+    {
+        candidates = m_lastMatches;
+    }
+    else
+    {
+        candidates.resize( m_aliases.size() );
+
+        for( unsigned i = 0; i < candidates.size(); ++i )
+            candidates[i] = i;
+    }
+
+    // A plain term is found only in the aliases having all its trigrams.
+    BOOST_FOREACH( const wxString& term, terms )
+    {
+        if( term.length() < 3 || !isPlainSearch( term ) )
+            continue;
+
+        if( !m_indexValid )
+            buildIndex();
+
+        narrowCandidates( term, candidates );
+    }
+
+    BOOST_FOREACH( unsigned i, candidates )
+        m_aliases[i]->MatchScore = kLowestDefaultScore;
+
     // Create match scores for each node for all the terms, that come space-separated.
     // Scoring adds up values for each term according to importance of the match. If a term does
     // not match at all, the result is thrown out of the results (AND semantics).
@@ -353,53 +572,12 @@ void COMPONENT_TREE_SEARCH_CONTAINER::UpdateSearchTerm( const wxString& aSearch
     //     first so contribute more to the score.
     //
     // This is of course subject to tweaking.
-    wxStringTokenizer tokenizer( aSearch );
+    BOOST_FOREACH( const wxString& term, terms )
+        scoreTerm( term, candidates );
 
-    while ( tokenizer.HasMoreTokens() )
-    {
-        const wxString term = tokenizer.GetNextToken().Lower();
-        EDA_COMBINED_MATCHER matcher( term );
-
-        BOOST_FOREACH( TREE_NODE* node, m_nodes )
-        {
-            if( node->Type != TREE_NODE::TYPE_ALIAS )
-                continue;      // Only aliases are actually scored here.
-
-            if( node->MatchScore == 0)
-                continue;   // Leaf node without score are out of the game.
-
-            // Keywords and description we only count if the match string is at
-            // least two characters long. That avoids spurious, low quality
-            // matches. Most abbreviations are at three characters long.
-            int found_pos;
-            int matcher_fired = 0;
-
-            if( term == node->MatchName )
-                node->MatchScore += 1000;  // exact match. High score :)
-            else if( (found_pos = matcher.Find( node->MatchName, &matcher_fired ) ) != EDA_PATTERN_NOT_FOUND )
-            {
-                // Substring match. The earlier in the string the better.  score += 20..40
-                node->MatchScore += matchPosScore( found_pos, 20 ) + 20;
-            }
-            else if( matcher.Find( node->Parent->MatchName, &matcher_fired ) != EDA_PATTERN_NOT_FOUND )
-                node->MatchScore += 19;   // parent name matches.         score += 19
-            else if( ( found_pos = matcher.Find( node->SearchText, &matcher_fired ) ) != EDA_PATTERN_NOT_FOUND )
-            {
-                // If we have a very short search term (like one or two letters), we don't want
-                // to accumulate scores if they just happen to be in keywords or description as
-                // almost any one or two-letter combination shows up in there.
-                // For longer terms, we add scores 1..18 for positional match (higher in the
-                // front, where the keywords are).                        score += 0..18
-                node->MatchScore += ( ( term.length() >= 2 )
-                                       ? matchPosScore( found_pos, 17 ) + 1
-                                       : 0 );
-            }
-            else
-                node->MatchScore = 0;    // No match. That's it for this item.
-
-            node->MatchScore += 2 * matcher_fired;
-        }
-    }
+    m_lastSearch = aSearch;
+    m_lastMatches.swap( candidates );
+    m_lastMatchesValid = true;
 
     // Library nodes have the maximum score seen in any of their children.
     // Alias nodes have the score of their parents.
@@ -27,6 +27,8 @@
 #include <vector>
 #include <wx/string.h>
 
+#include <hashtables.h>
+
 class LIB_ALIAS;
 class PART_LIB;
 class PART_LIBS;
@@ -40,6 +42,11 @@ class wxArrayString;
 //
 // The scored result list is adpated on each update on the search-term: this allows
 // to have a search-as-you-type experience.
+//
+// To keep the typing responsive with large libraries, only the components containing
+// all the trigrams of the plain search terms (index built on the first search) are
+// scored, and when the search string extends the previous one, only the components
+// matching the previous one are scored.
 class COMPONENT_TREE_SEARCH_CONTAINER
 {
 public:
@@ -106,6 +113,7 @@ public:
      * is applied to the components list to narrow it down. Results are scored by
      * relevancy (e.g. exact match scores higher than prefix-match which in turn scores
      * higher than substring match). This updates the search and tree on each call.
+     * Large candidate lists are scored in parallel.
      *
      * @param aSearch is the user-provided search string.
      */
@@ -129,7 +137,42 @@ private:
     struct TREE_NODE;
     static bool scoreComparator( const TREE_NODE* a1, const TREE_NODE* a2 );
 
+    /** Function buildIndex
+     * Fill the trigram index with the names, library names, keywords and
+     * descriptions of all the aliases.
+     */
+    void buildIndex();
+
+    /// Add the alias numbered aAlias to the lists of the trigrams of aText.
+    void addTrigrams( const wxString& aText, unsigned aAlias );
+
+    /** Function narrowCandidates
+     * Remove from aCandidates the aliases which can not match the plain term aTerm,
+     * because one of its trigrams is not in their texts.
+     *
+     * @param aTerm is a search term without regular expression or wildcard
+     *              syntax, of at least 3 characters.
+     * @param aCandidates is the sorted list of alias numbers to narrow down.
+     */
+    void narrowCandidates( const wxString& aTerm, std::vector<unsigned>& aCandidates ) const;
+
+    /** Function scoreTerm
+     * Add the score of the search term aTerm to the candidate aliases, and remove
+     * the ones it doesn't match from aCandidates.
+     */
+    void scoreTerm( const wxString& aTerm, std::vector<unsigned>& aCandidates );
+
+    typedef boost::unordered_map< wxString, std::vector<unsigned>, WXSTRING_HASH > TRIGRAM_MAP;
+
     std::vector<TREE_NODE*> m_nodes;
+    std::vector<TREE_NODE*> m_aliases;      // alias nodes, in the order they were added
+    TRIGRAM_MAP m_trigrams;                 // alias numbers containing each trigram
+    bool m_indexValid;
+
+    wxString m_lastSearch;                  // search string of the last update
+    std::vector<unsigned> m_lastMatches;    // alias numbers matching m_lastSearch
+    bool m_lastMatchesValid;
+
     wxTreeCtrl* m_tree;
     int m_libraries_added;
     int m_components_added;
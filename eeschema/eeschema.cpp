@@ -41,6 +41,7 @@
 
 #include <general.h>
 #include <class_libentry.h>
+#include <class_library.h>
 #include <hotkeys.h>
 #include <transform.h>
 #include <wildcards_and_files_ext.h>
@@ -236,6 +237,7 @@ bool IFACE::OnKifaceStart( PGM_BASE* aProgram, int aCtlBits )
 void IFACE::OnKifaceEnd()
 {
     wxConfigSaveSetups( KifaceSettings(), cfg_params() );
+    PART_LIBS::ClearParsedLibraries();
     end_common();
 }
 
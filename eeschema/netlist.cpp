@@ -43,8 +43,11 @@
 #include <sch_no_connect.h>
 #include <sch_text.h>
 #include <sch_sheet.h>
+#include <sch_connectivity.h>
 #include <algorithm>
+#include <map>
 #include <invoke_sch_dialog.h>
+#include <hashtables.h>
 #include <boost/foreach.hpp>
 
 #define IS_WIRE false
@@ -60,6 +63,276 @@ inline int CmpLabel_KEEPCASE( const wxString& aString1, const wxString& aString2
     //return aString1.CmpNoCase( aString2 );  // case insensitive
 }
 
+/** @brief The key used to find labels, equal for the labels CmpLabel_KEEPCASE finds equal.
+ * Must be changed together with CmpLabel_KEEPCASE.
+ */
+inline wxString LabelKey_KEEPCASE( const wxString& aLabel )
+{
+    return aLabel;                            // case sensitive
+    //return aLabel.Upper();                  // case insensitive
+}
+
+
+/// Hash function for wxPoint, to find the netlist objects ending at a given point
+struct WXPOINT_HASH : std::unary_function<wxPoint, std::size_t>
+{
+    std::size_t operator()( const wxPoint& aPoint ) const
+    {
+        return ( std::size_t( aPoint.x ) * 73856093u ) ^ ( std::size_t( aPoint.y ) * 19349663u );
+    }
+};
+
+
+/**
+ * Class NETLIST_SHEET_INDEX
+ * indexes the netlist objects of a sheet by position, to find the objects connected
+ * at a given point without scanning all the objects of the sheet.
+ */
+class NETLIST_SHEET_INDEX
+{
+public:
+    /**
+     * Function Build
+     * indexes the objects of \a aList from \a aStart, as long as they are on the
+     * same sheet (the list is sorted by sheet).
+     */
+    void Build( const NETLIST_OBJECT_LIST& aList, unsigned aStart );
+
+    /**
+     * Function EndsAt
+     * @return the objects having their start or end point at \a aPoint, or NULL
+     */
+    const NETLIST_OBJECTS* EndsAt( const wxPoint& aPoint ) const
+    {
+        POINT_MAP::const_iterator it = m_ends.find( aPoint );
+
+        return it == m_ends.end() ? NULL : &it->second;
+    }
+
+    /**
+     * Function SegmentsThrough
+     * appends to \a aSegments the wires (or the buses, if \a aIsBus is true) which
+     * can pass through \a aPoint: the horizontal and vertical ones on the same line,
+     * and all the oblique ones.
+     */
+    void SegmentsThrough( const wxPoint& aPoint, bool aIsBus, NETLIST_OBJECTS& aSegments ) const;
+
+private:
+    typedef boost::unordered_map<wxPoint, NETLIST_OBJECTS, WXPOINT_HASH> POINT_MAP;
+    typedef boost::unordered_map<int, NETLIST_OBJECTS> LINE_MAP;
+
+    POINT_MAP       m_ends;
+    LINE_MAP        m_horizontal[2];    // wires [0] and buses [1], by ordinate
+    LINE_MAP        m_vertical[2];      // wires [0] and buses [1], by abscissa
+    NETLIST_OBJECTS m_oblique[2];       // wires [0] and buses [1]
+};
+
+
+void NETLIST_SHEET_INDEX::Build( const NETLIST_OBJECT_LIST& aList, unsigned aStart )
+{
+    m_ends.clear();
+
+    for( int ii = 0; ii < 2; ii++ )
+    {
+        m_horizontal[ii].clear();
+        m_vertical[ii].clear();
+        m_oblique[ii].clear();
+    }
+
+    const SCH_SHEET_PATH& sheet = aList.GetItem( aStart )->m_SheetPath;
+
+    for( unsigned ii = aStart; ii < aList.size(); ii++ )
+    {
+        NETLIST_OBJECT* item = aList.GetItem( ii );
+
+        if( item->m_SheetPath != sheet )
+            break;
+
+        m_ends[item->m_Start].push_back( item );
+
+        if( item->m_End != item->m_Start )
+            m_ends[item->m_End].push_back( item );
+
+        if( item->m_Type != NET_SEGMENT && item->m_Type != NET_BUS )
+            continue;
+
+        int kind = item->m_Type == NET_BUS ? 1 : 0;
+
+        if( item->m_Start.y == item->m_End.y )
+            m_horizontal[kind][item->m_Start.y].push_back( item );
+        else if( item->m_Start.x == item->m_End.x )
+            m_vertical[kind][item->m_Start.x].push_back( item );
+        else
+            m_oblique[kind].push_back( item );
+    }
+}
+
+
+void NETLIST_SHEET_INDEX::SegmentsThrough( const wxPoint& aPoint, bool aIsBus,
+                                           NETLIST_OBJECTS& aSegments ) const
+{
+    int kind = aIsBus ? 1 : 0;
+
+    LINE_MAP::const_iterator it = m_horizontal[kind].find( aPoint.y );
+
+    if( it != m_horizontal[kind].end() )
+        aSegments.insert( aSegments.end(), it->second.begin(), it->second.end() );
+
+    it = m_vertical[kind].find( aPoint.x );
+
+    if( it != m_vertical[kind].end() )
+        aSegments.insert( aSegments.end(), it->second.begin(), it->second.end() );
+
+    aSegments.insert( aSegments.end(), m_oblique[kind].begin(), m_oblique[kind].end() );
+}
+
+
+/**
+ * Class NETLIST_LABEL_GROUP
+ * is a group of labels connected together.
+ * Once all its labels are connected to a net, they stay on the same net: connecting one
+ * of them is enough to connect the whole group to another net.
+ */
+class NETLIST_LABEL_GROUP
+{
+public:
+    NETLIST_LABEL_GROUP() :
+        m_Connected( false )
+    {
+    }
+
+    NETLIST_OBJECTS m_Items;
+    bool            m_Connected;    // true when all m_Items are on the same net
+};
+
+
+/**
+ * Class NETLIST_LABEL_INDEX
+ * indexes the labels of a netlist by sheet and text, to find the labels connected
+ * to a given label without scanning the whole netlist.
+ */
+class NETLIST_LABEL_INDEX
+{
+public:
+    NETLIST_LABEL_INDEX( const NETLIST_OBJECT_LIST& aList );
+
+    /// @return the labels of any type, named \a aLabel in \a aSheet, or NULL
+    NETLIST_LABEL_GROUP* SheetLabels( const SCH_SHEET_PATH& aSheet, const wxString& aLabel )
+    {
+        return find( m_sheetLabels, aSheet, aLabel );
+    }
+
+    /// @return the hierarchical labels named \a aLabel in \a aSheet, or NULL
+    NETLIST_LABEL_GROUP* HierLabels( const SCH_SHEET_PATH& aSheet, const wxString& aLabel )
+    {
+        return find( m_hierLabels, aSheet, aLabel );
+    }
+
+    /**
+     * Function GlobalLabels
+     * @return the labels of type \a aType (NET_PINLABEL, NET_GLOBLABEL or
+     * NET_GLOBBUSLABELMEMBER) named \a aLabel in the whole hierarchy, or NULL
+     */
+    NETLIST_LABEL_GROUP* GlobalLabels( NETLIST_ITEM_T aType, const wxString& aLabel );
+
+private:
+    typedef boost::unordered_map<wxString, NETLIST_LABEL_GROUP, WXSTRING_HASH> GROUP_MAP;
+    typedef std::vector<SCH_SHEET*> SHEET_KEY;
+
+    static SHEET_KEY sheetKey( SCH_SHEET_PATH aSheet );
+
+    NETLIST_LABEL_GROUP* find( std::vector<GROUP_MAP>& aGroups, const SCH_SHEET_PATH& aSheet,
+                               const wxString& aLabel );
+
+    std::map<SHEET_KEY, int> m_sheetNumbers;
+    std::vector<GROUP_MAP>   m_sheetLabels;     // labels of any type, for each sheet
+    std::vector<GROUP_MAP>   m_hierLabels;      // hierarchical labels, for each sheet
+    GROUP_MAP                m_pinLabels;
+    GROUP_MAP                m_globLabels;
+    GROUP_MAP                m_globBusLabels;
+};
+
+
+NETLIST_LABEL_INDEX::NETLIST_LABEL_INDEX( const NETLIST_OBJECT_LIST& aList )
+{
+    for( unsigned ii = 0; ii < aList.size(); ii++ )
+    {
+        NETLIST_OBJECT* item = aList.GetItem( ii );
+
+        if( !item->IsLabelType() )
+            continue;
+
+        SHEET_KEY key = sheetKey( item->m_SheetPath );
+        std::map<SHEET_KEY, int>::iterator sheet = m_sheetNumbers.find( key );
+
+        if( sheet == m_sheetNumbers.end() )
+        {
+            sheet = m_sheetNumbers.insert( std::make_pair( key, int( m_sheetLabels.size() ) ) ).first;
+            m_sheetLabels.push_back( GROUP_MAP() );
+            m_hierLabels.push_back( GROUP_MAP() );
+        }
+
+        wxString label = LabelKey_KEEPCASE( item->m_Label );
+
+        m_sheetLabels[sheet->second][label].m_Items.push_back( item );
+
+        if( item->m_Type == NET_HIERLABEL || item->m_Type == NET_HIERBUSLABELMEMBER )
+            m_hierLabels[sheet->second][label].m_Items.push_back( item );
+        else if( item->m_Type == NET_PINLABEL )
+            m_pinLabels[label].m_Items.push_back( item );
+        else if( item->m_Type == NET_GLOBLABEL )
+            m_globLabels[label].m_Items.push_back( item );
+        else if( item->m_Type == NET_GLOBBUSLABELMEMBER )
+            m_globBusLabels[label].m_Items.push_back( item );
+    }
+}
+
+
+NETLIST_LABEL_INDEX::SHEET_KEY NETLIST_LABEL_INDEX::sheetKey( SCH_SHEET_PATH aSheet )
+{
+    // Sheet paths are equal when they have the same sheets (see SCH_SHEET_PATH::operator==)
+    SHEET_KEY key;
+
+    for( unsigned ii = 0; ii < aSheet.GetCount(); ii++ )
+        key.push_back( aSheet.GetSheet( ii ) );
+
+    return key;
+}
+
+
+NETLIST_LABEL_GROUP* NETLIST_LABEL_INDEX::find( std::vector<GROUP_MAP>& aGroups,
+                                                const SCH_SHEET_PATH& aSheet,
+                                                const wxString& aLabel )
+{
+    std::map<SHEET_KEY, int>::iterator sheet = m_sheetNumbers.find( sheetKey( aSheet ) );
+
+    if( sheet == m_sheetNumbers.end() )
+        return NULL;
+
+    GROUP_MAP::iterator group = aGroups[sheet->second].find( LabelKey_KEEPCASE( aLabel ) );
+
+    return group == aGroups[sheet->second].end() ? NULL : &group->second;
+}
+
+
+NETLIST_LABEL_GROUP* NETLIST_LABEL_INDEX::GlobalLabels( NETLIST_ITEM_T aType,
+                                                        const wxString& aLabel )
+{
+    GROUP_MAP* groups;
+
+    switch( aType )
+    {
+    case NET_PINLABEL:           groups = &m_pinLabels;     break;
+    case NET_GLOBLABEL:          groups = &m_globLabels;    break;
+    case NET_GLOBBUSLABELMEMBER: groups = &m_globBusLabels; break;
+    default:                     return NULL;
+    }
+
+    GROUP_MAP::iterator group = groups->find( LabelKey_KEEPCASE( aLabel ) );
+
+    return group == groups->end() ? NULL : &group->second;
+}
+
 
 //Imported function:
 int TestDuplicateSheetNames( bool aCreateMarker );
@@ -155,6 +428,32 @@ void NETLIST_OBJECT_LIST::Clear()
 }
 
 
+void NETLIST_OBJECT_LIST::AppendCopies( const NETLIST_OBJECT_LIST& aSource )
+{
+    // The net name candidates of the copies must be the copies of the candidates
+    boost::unordered_map<const NETLIST_OBJECT*, NETLIST_OBJECT*> copies;
+    unsigned first = size();
+
+    reserve( size() + aSource.size() );
+
+    for( unsigned ii = 0; ii < aSource.size(); ii++ )
+    {
+        NETLIST_OBJECT* item = new NETLIST_OBJECT( *aSource.GetItem( ii ) );
+
+        copies[aSource.GetItem( ii )] = item;
+        push_back( item );
+    }
+
+    for( unsigned ii = first; ii < size(); ii++ )
+    {
+        NETLIST_OBJECT* item = GetItem( ii );
+
+        if( item->HasNetNameCandidate() )
+            item->SetNetNameCandidate( copies[item->GetNetNameCandidate()] );
+    }
+}
+
+
 void NETLIST_OBJECT_LIST::SortListbyNetcode()
 {
     sort( this->begin(), this->end(), NETLIST_OBJECT_LIST::sortItemsbyNetcode );
@@ -169,16 +468,15 @@ void NETLIST_OBJECT_LIST::SortListbySheet()
 
 NETLIST_OBJECT_LIST* SCH_EDIT_FRAME::BuildNetListBase()
 {
-    // I own this list until I return it to the new owner.
-    std::auto_ptr<NETLIST_OBJECT_LIST> ret( new NETLIST_OBJECT_LIST() );
-
     // Creates the flattened sheet list:
     SCH_SHEET_LIST aSheets;
 
-    // Build netlist info
-    bool success = ret->BuildNetListInfo( aSheets );
+    // Build netlist info, reading again only the sheets modified since the last build.
+    // I own this list until I return it to the new owner.
+    std::auto_ptr<NETLIST_OBJECT_LIST> ret(
+        m_connectivity->GetNetList( aSheets, Prj().SchLibs()->GetModifyHash() ) );
 
-    if( !success )
+    if( ret->empty() )
     {
         SetStatusText( _( "No Objects" ) );
         return ret.release();
@@ -206,6 +504,14 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
         }
     }
 
+    return ConnectItems();
+}
+
+
+bool NETLIST_OBJECT_LIST::ConnectItems()
+{
+    SCH_SHEET_PATH* sheet;
+
     if( size() == 0 )
         return false;
 
@@ -214,15 +520,20 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
 
     sheet = &(GetItem( 0 )->m_SheetPath);
     m_lastNetCode = m_lastBusNetCode = 1;
+    m_netCodes.Clear();
+    m_busNetCodes.Clear();
+
+    // Objects of the current sheet, by position
+    NETLIST_SHEET_INDEX sheetIndex;
 
-    for( unsigned ii = 0, istart = 0; ii < size(); ii++ )
+    for( unsigned ii = 0; ii < size(); ii++ )
     {
         NETLIST_OBJECT* net_item = GetItem( ii );
 
-        if( net_item->m_SheetPath != *sheet )   // Sheet change
+        if( ii == 0 || net_item->m_SheetPath != *sheet )   // Sheet change
         {
             sheet  = &(net_item->m_SheetPath);
-            istart = ii;
+            sheetIndex.Build( *this, ii );
         }
 
         switch( net_item->m_Type )
@@ -235,79 +546,79 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
         case NET_PINLABEL:
         case NET_SHEETLABEL:
         case NET_NOCONNECT:
-            if( net_item->GetNet() != 0 )
+            if( netCode( net_item ) != 0 )
                 break;
 
         case NET_SEGMENT:
             // Test connections point to point type without bus.
-            if( net_item->GetNet() == 0 )
+            if( netCode( net_item ) == 0 )
             {
                 net_item->SetNet( m_lastNetCode );
                 m_lastNetCode++;
             }
 
-            pointToPointConnect( net_item, IS_WIRE, istart );
+            pointToPointConnect( net_item, IS_WIRE, sheetIndex );
             break;
 
         case NET_JUNCTION:
             // Control of the junction outside BUS.
-            if( net_item->GetNet() == 0 )
+            if( netCode( net_item ) == 0 )
             {
                 net_item->SetNet( m_lastNetCode );
                 m_lastNetCode++;
             }
 
-            segmentToPointConnect( net_item, IS_WIRE, istart );
+            segmentToPointConnect( net_item, IS_WIRE, sheetIndex );
 
             // Control of the junction, on BUS.
-            if( net_item->m_BusNetCode == 0 )
+            if( busNetCode( net_item ) == 0 )
             {
                 net_item->m_BusNetCode = m_lastBusNetCode;
                 m_lastBusNetCode++;
             }
 
-            segmentToPointConnect( net_item, IS_BUS, istart );
+            segmentToPointConnect( net_item, IS_BUS, sheetIndex );
             break;
 
         case NET_LABEL:
         case NET_HIERLABEL:
         case NET_GLOBLABEL:
             // Test connections type junction without bus.
-            if( net_item->GetNet() == 0 )
+            if( netCode( net_item ) == 0 )
             {
                 net_item->SetNet( m_lastNetCode );
                 m_lastNetCode++;
             }
 
-            segmentToPointConnect( net_item, IS_WIRE, istart );
+            segmentToPointConnect( net_item, IS_WIRE, sheetIndex );
             break;
 
         case NET_SHEETBUSLABELMEMBER:
-            if( net_item->m_BusNetCode != 0 )
+            if( busNetCode( net_item ) != 0 )
                 break;
 
         case NET_BUS:
             // Control type connections point to point mode bus
-            if( net_item->m_BusNetCode == 0 )
+            if( busNetCode( net_item ) == 0 )
             {
                 net_item->m_BusNetCode = m_lastBusNetCode;
                 m_lastBusNetCode++;
             }
 
-            pointToPointConnect( net_item, IS_BUS, istart );
+            pointToPointConnect( net_item, IS_BUS, sheetIndex );
             break;
 
         case NET_BUSLABELMEMBER:
         case NET_HIERBUSLABELMEMBER:
         case NET_GLOBBUSLABELMEMBER:
             // Control connections similar has on BUS
-            if( net_item->GetNet() == 0 )
+            if( netCode( net_item ) == 0 )
             {
                 net_item->m_BusNetCode = m_lastBusNetCode;
                 m_lastBusNetCode++;
             }
 
-            segmentToPointConnect( net_item, IS_BUS, istart );
+            segmentToPointConnect( net_item, IS_BUS, sheetIndex );
             break;
         }
     }
@@ -321,6 +632,8 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
     connectBusLabels();
 
     // Group objects by label.
+    NETLIST_LABEL_INDEX labels( *this );
+
     for( unsigned ii = 0; ii < size(); ii++ )
     {
         switch( GetItem( ii )->m_Type )
@@ -338,7 +651,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
         case NET_PINLABEL:
         case NET_BUSLABELMEMBER:
         case NET_GLOBBUSLABELMEMBER:
-            labelConnect( GetItem( ii ) );
+            labelConnect( GetItem( ii ), labels );
             break;
 
         case NET_SHEETBUSLABELMEMBER:
@@ -361,7 +674,16 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
     {
         if( GetItem( ii )->m_Type == NET_SHEETLABEL
             || GetItem( ii )->m_Type == NET_SHEETBUSLABELMEMBER )
-            sheetLabelConnect( GetItem( ii ) );
+            sheetLabelConnect( GetItem( ii ), labels );
+    }
+
+    // Give each object the code of the net it has been merged into
+    for( unsigned ii = 0; ii < size(); ii++ )
+    {
+        NETLIST_OBJECT* item = GetItem( ii );
+
+        item->SetNet( netCode( item ) );
+        item->m_BusNetCode = busNetCode( item );
     }
 
     // Sort objects by NetCode
@@ -595,38 +917,37 @@ void NETLIST_OBJECT_LIST::findBestNetNameForEachNet()
 }
 
 
-void NETLIST_OBJECT_LIST::sheetLabelConnect( NETLIST_OBJECT* SheetLabel )
+void NETLIST_OBJECT_LIST::sheetLabelConnect( NETLIST_OBJECT* SheetLabel,
+                                             NETLIST_LABEL_INDEX& aLabels )
 {
-    if( SheetLabel->GetNet() == 0 )
+    if( netCode( SheetLabel ) == 0 )
         return;
 
-    for( unsigned ii = 0; ii < size(); ii++ )
-    {
-        NETLIST_OBJECT* ObjetNet = GetItem( ii );
-
-        if( ObjetNet->m_SheetPath != SheetLabel->m_SheetPathInclude )
-            continue;  //use SheetInclude, not the sheet!!
+    //use SheetInclude, not the sheet!!
+    connectLabelGroup( aLabels.HierLabels( SheetLabel->m_SheetPathInclude, SheetLabel->m_Label ),
+                       netCode( SheetLabel ) );
+}
 
-        if( (ObjetNet->m_Type != NET_HIERLABEL ) && (ObjetNet->m_Type != NET_HIERBUSLABELMEMBER ) )
-            continue;
 
-        if( ObjetNet->GetNet() == SheetLabel->GetNet() )
-            continue;  //already connected.
+void NETLIST_OBJECT_LIST::connectBusLabels()
+{
+    // The bus label members are connected to the members of the same bus having
+    // the same member number: group them by bus net code and member number.
+    typedef boost::unordered_map< std::pair<int, int>, NETLIST_OBJECTS > BUS_MEMBERS;
+    BUS_MEMBERS busMembers;
 
-        if( CmpLabel_KEEPCASE( ObjetNet->m_Label, SheetLabel->m_Label ) != 0 )
-            continue;  //different names.
+    for( unsigned ii = 0; ii < size(); ii++ )
+    {
+        NETLIST_OBJECT* Label = GetItem( ii );
 
-        // Propagate Netcode having all the objects of the same Netcode.
-        if( ObjetNet->GetNet() )
-            propageNetCode( ObjetNet->GetNet(), SheetLabel->GetNet(), IS_WIRE );
-        else
-            ObjetNet->SetNet( SheetLabel->GetNet() );
+        if(  (Label->m_Type == NET_SHEETBUSLABELMEMBER)
+          || (Label->m_Type == NET_BUSLABELMEMBER)
+          || (Label->m_Type == NET_HIERBUSLABELMEMBER) )
+        {
+            busMembers[ std::make_pair( busNetCode( Label ), Label->m_Member ) ].push_back( Label );
+        }
     }
-}
 
-
-void NETLIST_OBJECT_LIST::connectBusLabels()
-{
     for( unsigned ii = 0; ii < size(); ii++ )
     {
         NETLIST_OBJECT* Label = GetItem( ii );
@@ -635,31 +956,22 @@ void NETLIST_OBJECT_LIST::connectBusLabels()
           || (Label->m_Type == NET_BUSLABELMEMBER)
           || (Label->m_Type == NET_HIERBUSLABELMEMBER) )
         {
-            if( Label->GetNet() == 0 )
+            NETLIST_OBJECTS& members =
+                busMembers[ std::make_pair( busNetCode( Label ), Label->m_Member ) ];
+
+            // The first member of a group connects all the others:
+            // there is nothing left to do for the next ones.
+            if( members.front() != Label )
+                continue;
+
+            if( netCode( Label ) == 0 )
             {
                 Label->SetNet( m_lastNetCode );
                 m_lastNetCode++;
             }
 
-            for( unsigned jj = ii + 1; jj < size(); jj++ )
-            {
-                NETLIST_OBJECT* LabelInTst =  GetItem( jj );
-                if( (LabelInTst->m_Type == NET_SHEETBUSLABELMEMBER)
-                   || (LabelInTst->m_Type == NET_BUSLABELMEMBER)
-                   || (LabelInTst->m_Type == NET_HIERBUSLABELMEMBER) )
-                {
-                    if( LabelInTst->m_BusNetCode != Label->m_BusNetCode )
-                        continue;
-
-                    if( LabelInTst->m_Member != Label->m_Member )
-                        continue;
-
-                    if( LabelInTst->GetNet() == 0 )
-                        LabelInTst->SetNet( Label->GetNet() );
-                    else
-                        propageNetCode( LabelInTst->GetNet(), Label->GetNet(), IS_WIRE );
-                }
-            }
+            for( unsigned jj = 1; jj < members.size(); jj++ )
+                connectToNet( members[jj], netCode( Label ), IS_WIRE );
         }
     }
 }
@@ -671,91 +983,70 @@ void NETLIST_OBJECT_LIST::propageNetCode( int aOldNetCode, int aNewNetCode, bool
         return;
 
     if( aIsBus == false )    // Propagate NetCode
-    {
-        for( unsigned jj = 0; jj < size(); jj++ )
-        {
-            NETLIST_OBJECT* object = GetItem( jj );
+        m_netCodes.Merge( aOldNetCode, aNewNetCode );
+    else                     // Propagate BusNetCode
+        m_busNetCodes.Merge( aOldNetCode, aNewNetCode );
+}
 
-            if( object->GetNet() == aOldNetCode )
-                object->SetNet( aNewNetCode );
-        }
+
+void NETLIST_OBJECT_LIST::connectToNet( NETLIST_OBJECT* aItem, int aNetCode, bool aIsBus )
+{
+    if( aIsBus == false )
+    {
+        if( netCode( aItem ) == 0 )
+            aItem->SetNet( aNetCode );
+        else
+            propageNetCode( netCode( aItem ), aNetCode, IS_WIRE );
     }
-    else               // Propagate BusNetCode
+    else
     {
-        for( unsigned jj = 0; jj < size(); jj++ )
-        {
-            NETLIST_OBJECT* object = GetItem( jj );
-
-            if( object->m_BusNetCode == aOldNetCode )
-                object->m_BusNetCode = aNewNetCode;
-        }
+        if( busNetCode( aItem ) == 0 )
+            aItem->m_BusNetCode = aNetCode;
+        else
+            propageNetCode( busNetCode( aItem ), aNetCode, IS_BUS );
     }
 }
 
 
-void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus,
-                                               int start )
+void NETLIST_OBJECT_LIST::connectLabelGroup( NETLIST_LABEL_GROUP* aGroup, int aNetCode )
 {
-    int netCode;
+    if( !aGroup )
+        return;
 
-    if( aIsBus == false )    // Objects other than BUS and BUSLABELS
+    if( aGroup->m_Connected )
     {
-        netCode = aRef->GetNet();
+        // All the labels are on the same net, move it at once
+        connectToNet( aGroup->m_Items[0], aNetCode, IS_WIRE );
+        return;
+    }
 
-        for( unsigned i = start; i < size(); i++ )
-        {
-            NETLIST_OBJECT* item = GetItem( i );
+    BOOST_FOREACH( NETLIST_OBJECT* item, aGroup->m_Items )
+        connectToNet( item, aNetCode, IS_WIRE );
 
-            if( item->m_SheetPath != aRef->m_SheetPath )  //used to be > (why?)
-                continue;
+    aGroup->m_Connected = true;
+}
 
-            switch( item->m_Type )
-            {
-            case NET_SEGMENT:
-            case NET_PIN:
-            case NET_LABEL:
-            case NET_HIERLABEL:
-            case NET_GLOBLABEL:
-            case NET_SHEETLABEL:
-            case NET_PINLABEL:
-            case NET_JUNCTION:
-            case NET_NOCONNECT:
-                if( aRef->m_Start == item->m_Start
-                    || aRef->m_Start == item->m_End
-                    || aRef->m_End   == item->m_Start
-                    || aRef->m_End   == item->m_End )
-                {
-                    if( item->GetNet() == 0 )
-                        item->SetNet( netCode );
-                    else
-                        propageNetCode( item->GetNet(), netCode, IS_WIRE );
-                }
-                break;
 
-            case NET_BUS:
-            case NET_BUSLABELMEMBER:
-            case NET_SHEETBUSLABELMEMBER:
-            case NET_HIERBUSLABELMEMBER:
-            case NET_GLOBBUSLABELMEMBER:
-            case NET_ITEM_UNSPECIFIED:
-                break;
-            }
-        }
-    }
-    else    // Object type BUS, BUSLABELS, and junctions.
-    {
-        netCode = aRef->m_BusNetCode;
+void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus,
+                                               const NETLIST_SHEET_INDEX& aSheet )
+{
+    int refNetCode = aIsBus ? busNetCode( aRef ) : netCode( aRef );
 
-        for( unsigned i = start; i < size(); i++ )
-        {
-            NETLIST_OBJECT* item = GetItem( i );
+    // Objects having an end at one of the ends of aRef
+    const NETLIST_OBJECTS* ends[2] = { aSheet.EndsAt( aRef->m_Start ), NULL };
 
-            if( item->m_SheetPath != aRef->m_SheetPath )
-                continue;
+    if( aRef->m_End != aRef->m_Start )
+        ends[1] = aSheet.EndsAt( aRef->m_End );
+
+    for( int ii = 0; ii < 2; ii++ )
+    {
+        if( !ends[ii] )
+            continue;
 
+        BOOST_FOREACH( NETLIST_OBJECT* item, *ends[ii] )
+        {
             switch( item->m_Type )
             {
-            case NET_ITEM_UNSPECIFIED:
             case NET_SEGMENT:
             case NET_PIN:
             case NET_LABEL:
@@ -764,6 +1055,8 @@ void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus
             case NET_SHEETLABEL:
             case NET_PINLABEL:
             case NET_NOCONNECT:
+                if( aIsBus == false )    // Objects other than BUS and BUSLABELS
+                    connectToNet( item, refNetCode, IS_WIRE );
                 break;
 
             case NET_BUS:
@@ -771,17 +1064,15 @@ void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus
             case NET_SHEETBUSLABELMEMBER:
             case NET_HIERBUSLABELMEMBER:
             case NET_GLOBBUSLABELMEMBER:
+                if( aIsBus )    // Object type BUS, BUSLABELS, and junctions.
+                    connectToNet( item, refNetCode, IS_BUS );
+                break;
+
             case NET_JUNCTION:
-                if(  aRef->m_Start == item->m_Start
-                  || aRef->m_Start == item->m_End
-                  || aRef->m_End   == item->m_Start
-                  || aRef->m_End   == item->m_End )
-                {
-                    if( item->m_BusNetCode == 0 )
-                        item->m_BusNetCode = netCode;
-                    else
-                        propageNetCode( item->m_BusNetCode, netCode, IS_BUS );
-                }
+                connectToNet( item, refNetCode, aIsBus );
+                break;
+
+            case NET_ITEM_UNSPECIFIED:
                 break;
             }
         }
@@ -790,89 +1081,50 @@ void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus
 
 
 void NETLIST_OBJECT_LIST::segmentToPointConnect( NETLIST_OBJECT* aJonction,
-                                                bool aIsBus, int aIdxStart )
+                                                bool aIsBus, const NETLIST_SHEET_INDEX& aSheet )
 {
-    for( unsigned i = aIdxStart; i < size(); i++ )
-    {
-        NETLIST_OBJECT* segment = GetItem( i );
-
-        // if different sheets, obviously no physical connection between elements.
-        if( segment->m_SheetPath != aJonction->m_SheetPath )
-            continue;
+    // Only the segments of the sheet of the junction can be connected to it
+    NETLIST_OBJECTS segments;
 
-        if( aIsBus == IS_WIRE )
-        {
-            if( segment->m_Type != NET_SEGMENT )
-                continue;
-        }
-        else
-        {
-            if( segment->m_Type != NET_BUS )
-                continue;
-        }
+    aSheet.SegmentsThrough( aJonction->m_Start, aIsBus, segments );
 
+    BOOST_FOREACH( NETLIST_OBJECT* segment, segments )
+    {
         if( IsPointOnSegment( segment->m_Start, segment->m_End, aJonction->m_Start ) )
         {
             // Propagation Netcode has all the objects of the same Netcode.
             if( aIsBus == IS_WIRE )
-            {
-                if( segment->GetNet() )
-                    propageNetCode( segment->GetNet(), aJonction->GetNet(), aIsBus );
-                else
-                    segment->SetNet( aJonction->GetNet() );
-            }
+                connectToNet( segment, netCode( aJonction ), aIsBus );
             else
-            {
-                if( segment->m_BusNetCode )
-                    propageNetCode( segment->m_BusNetCode, aJonction->m_BusNetCode, aIsBus );
-                else
-                    segment->m_BusNetCode = aJonction->m_BusNetCode;
-            }
+                connectToNet( segment, busNetCode( aJonction ), aIsBus );
         }
     }
 }
 
 
-void NETLIST_OBJECT_LIST::labelConnect( NETLIST_OBJECT* aLabelRef )
+void NETLIST_OBJECT_LIST::labelConnect( NETLIST_OBJECT* aLabelRef, NETLIST_LABEL_INDEX& aLabels )
 {
-    if( aLabelRef->GetNet() == 0 )
-        return;
-
-    for( unsigned i = 0; i < size(); i++ )
-    {
-        NETLIST_OBJECT* item = GetItem( i );
+    int refNetCode = netCode( aLabelRef );
 
-        if( item->GetNet() == aLabelRef->GetNet() )
-            continue;
+    if( refNetCode == 0 )
+        return;
 
-        if( item->m_SheetPath != aLabelRef->m_SheetPath )
-        {
-            if( item->m_Type != NET_PINLABEL && item->m_Type != NET_GLOBLABEL
-                && item->m_Type != NET_GLOBBUSLABELMEMBER )
-                continue;
+    // NET_HIERLABEL are used to connect sheets.
+    // NET_LABEL are local to a sheet
+    // NET_GLOBLABEL are global.
+    // NET_PINLABEL is a kind of global label (generated by a power pin invisible)
 
-            if( (item->m_Type == NET_GLOBLABEL
-                 || item->m_Type == NET_GLOBBUSLABELMEMBER)
-               && item->m_Type != aLabelRef->m_Type )
-                //global labels only connect other global labels.
-                continue;
-        }
+    // Labels of any type of the same sheet
+    connectLabelGroup( aLabels.SheetLabels( aLabelRef->m_SheetPath, aLabelRef->m_Label ),
+                       refNetCode );
 
-        // NET_HIERLABEL are used to connect sheets.
-        // NET_LABEL are local to a sheet
-        // NET_GLOBLABEL are global.
-        // NET_PINLABEL is a kind of global label (generated by a power pin invisible)
-        if( item->IsLabelType() )
-        {
-            if( CmpLabel_KEEPCASE( item->m_Label, aLabelRef->m_Label ) != 0 )
-                continue;
+    // Labels of other sheets: the power pin labels, and global labels only connect
+    // other global labels.
+    connectLabelGroup( aLabels.GlobalLabels( NET_PINLABEL, aLabelRef->m_Label ), refNetCode );
 
-            if( item->GetNet() )
-                propageNetCode( item->GetNet(), aLabelRef->GetNet(), IS_WIRE );
-            else
-                item->SetNet( aLabelRef->GetNet() );
-        }
-    }
+    if( aLabelRef->m_Type == NET_GLOBLABEL || aLabelRef->m_Type == NET_GLOBBUSLABELMEMBER )
+        connectLabelGroup( aLabels.GlobalLabels( aLabelRef->m_Type, aLabelRef->m_Label ),
+                           refNetCode );
 }
 
 
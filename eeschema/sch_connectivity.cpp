@@ -0,0 +1,142 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file sch_connectivity.cpp
+ */
+
+#include <algorithm>
+
+#include <fctsys.h>
+#include <class_sch_screen.h>
+#include <sch_sheet.h>
+#include <sch_sheet_path.h>
+#include <sch_connectivity.h>
+
+
+SCH_CONNECTIVITY::SCH_CONNECTIVITY()
+{
+    m_netListValid = false;
+    m_libsHash = 0;
+    m_updatedSheets = 0;
+}
+
+
+SCH_CONNECTIVITY::~SCH_CONNECTIVITY()
+{
+    Clear();
+}
+
+
+void SCH_CONNECTIVITY::Clear()
+{
+    for( SHEET_MAP::iterator it = m_sheets.begin(); it != m_sheets.end(); ++it )
+        delete it->second;
+
+    m_sheets.clear();
+    m_sheetOrder.clear();
+    m_netList.Clear();
+    m_netListValid = false;
+}
+
+
+NETLIST_OBJECT_LIST* SCH_CONNECTIVITY::GetNetList( SCH_SHEET_LIST& aSheets, int aLibsHash )
+{
+    // The pins of the components are taken from the libraries
+    if( aLibsHash != m_libsHash )
+    {
+        Clear();
+        m_libsHash = aLibsHash;
+    }
+
+    std::vector<SHEET_ITEMS*> sheetOrder;
+    bool changed = false;
+
+    m_updatedSheets = 0;
+
+    for( SCH_SHEET_PATH* sheet = aSheets.GetFirst(); sheet; sheet = aSheets.GetNext() )
+    {
+        // Sheet paths are equal when they have the same sheets (see SCH_SHEET_PATH::operator==)
+        SHEET_KEY key;
+
+        for( unsigned ii = 0; ii < sheet->GetCount(); ii++ )
+            key.push_back( sheet->GetSheet( ii ) );
+
+        SHEET_ITEMS*& entry = m_sheets[key];
+        SCH_SCREEN* screen = sheet->LastScreen();
+
+        if( !entry )
+            entry = new SHEET_ITEMS;
+        else if( entry->m_Screen == screen
+               && entry->m_Revision == screen->GetConnectivityRevision() )
+        {
+            sheetOrder.push_back( entry );
+            continue;
+        }
+
+        entry->m_Items.Clear();
+        entry->m_Screen = screen;
+        entry->m_Revision = screen->GetConnectivityRevision();
+
+        for( SCH_ITEM* item = screen->GetDrawItems(); item; item = item->Next() )
+            item->GetNetListItem( entry->m_Items, sheet );
+
+        sheetOrder.push_back( entry );
+        m_updatedSheets++;
+        changed = true;
+    }
+
+    // Forget the sheets removed from the hierarchy
+    if( m_sheets.size() != sheetOrder.size() )
+    {
+        for( SHEET_MAP::iterator it = m_sheets.begin(); it != m_sheets.end(); )
+        {
+            if( std::find( sheetOrder.begin(), sheetOrder.end(), it->second ) == sheetOrder.end() )
+            {
+                delete it->second;
+                m_sheets.erase( it++ );
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    if( changed || !m_netListValid || sheetOrder != m_sheetOrder )
+    {
+        m_sheetOrder.swap( sheetOrder );
+        m_netList.Clear();
+
+        for( unsigned ii = 0; ii < m_sheetOrder.size(); ii++ )
+            m_netList.AppendCopies( m_sheetOrder[ii]->m_Items );
+
+        m_netList.ConnectItems();
+        m_netListValid = true;
+    }
+
+    NETLIST_OBJECT_LIST* netList = new NETLIST_OBJECT_LIST();
+    netList->AppendCopies( m_netList );
+
+    return netList;
+}
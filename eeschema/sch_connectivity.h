@@ -0,0 +1,98 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file sch_connectivity.h
+ * @brief Connections of the schematic kept between netlist requests.
+ */
+
+#ifndef _SCH_CONNECTIVITY_H_
+#define _SCH_CONNECTIVITY_H_
+
+#include <map>
+#include <vector>
+
+#include <class_netlist_object.h>
+
+class SCH_SCREEN;
+class SCH_SHEET;
+class SCH_SHEET_LIST;
+
+
+/**
+ * Class SCH_CONNECTIVITY
+ * keeps the connected items of the whole schematic between two netlist requests.
+ * <p>
+ * The netlist objects of each sheet are kept as long as the connectivity revision of
+ * its screen (see SCH_SCREEN::ConnectivityChanged()) does not change, so only the sheets
+ * edited since the last request are read again.  When no sheet has changed, the nets
+ * of the previous request are used as they are.
+ * </p>
+ */
+class SCH_CONNECTIVITY
+{
+public:
+    SCH_CONNECTIVITY();
+    ~SCH_CONNECTIVITY();
+
+    /**
+     * Function GetNetList
+     * updates the connections with the sheets changed since the last call.
+     * @param aSheets = the flattened sheet list
+     * @param aLibsHash = the modification hash of the part libraries (when the
+     *                    libraries change, all the sheets are read again)
+     * @return a copy, owned by the caller, of the connected items of \a aSheets
+     *         (empty when the schematic has no item).
+     */
+    NETLIST_OBJECT_LIST* GetNetList( SCH_SHEET_LIST& aSheets, int aLibsHash );
+
+    /**
+     * Function Clear
+     * forgets all the connections.
+     */
+    void Clear();
+
+    /// @return the number of sheets read again by the last call to GetNetList()
+    int GetUpdatedSheetCount() const { return m_updatedSheets; }
+
+private:
+    /// Netlist objects of a sheet, not connected yet
+    struct SHEET_ITEMS
+    {
+        SCH_SCREEN*         m_Screen;
+        unsigned            m_Revision;
+        NETLIST_OBJECT_LIST m_Items;
+    };
+
+    typedef std::vector<SCH_SHEET*>             SHEET_KEY;
+    typedef std::map<SHEET_KEY, SHEET_ITEMS*>   SHEET_MAP;
+
+    SHEET_MAP                   m_sheets;
+    std::vector<SHEET_ITEMS*>   m_sheetOrder;   ///< sheets of the last request, in order
+    NETLIST_OBJECT_LIST         m_netList;      ///< connected items of the last request
+    bool                        m_netListValid;
+    int                         m_libsHash;
+    int                         m_updatedSheets;
+};
+
+#endif    // _SCH_CONNECTIVITY_H_
@@ -0,0 +1,290 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file sch_item_index.cpp
+ */
+
+#include <algorithm>
+
+#include <fctsys.h>
+#include <sch_item_struct.h>
+#include <sch_line.h>
+#include <sch_sheet.h>
+#include <sch_item_index.h>
+
+
+/// Size of the grid cells, in internal units (mils): a few grid steps
+#define CELL_SIZE       256
+
+/// Items covering more cells are not stored in the cells (large sheets, long buses)
+#define MAX_ITEM_CELLS  64
+
+/// Added around the item areas, more than the pen widths used by the hit tests
+#define AREA_MARGIN     50
+
+
+/// @return the cell containing the coordinate aCoord (rounded down, also when negative)
+static inline int cellOf( int aCoord )
+{
+    return aCoord >= 0 ? aCoord / CELL_SIZE : -( ( -aCoord - 1 ) / CELL_SIZE ) - 1;
+}
+
+
+/// @return true if the normalized areas aA and aB have a common point
+static inline bool areasIntersect( const EDA_RECT& aA, const EDA_RECT& aB )
+{
+    return aA.GetLeft() <= aB.GetRight() && aB.GetLeft() <= aA.GetRight()
+        && aA.GetTop() <= aB.GetBottom() && aB.GetTop() <= aA.GetBottom();
+}
+
+
+EDA_RECT SCH_ITEM_INDEX::ItemArea( SCH_ITEM* aItem )
+{
+    EDA_RECT area = aItem->GetBoundingBox();
+    std::vector< wxPoint > points;
+
+    area.Normalize();
+
+    aItem->GetConnectionPoints( points );
+
+    // The lines of the notes layer have no connection point, but can be hit
+    if( aItem->Type() == SCH_LINE_T )
+    {
+        points.push_back( ( (SCH_LINE*) aItem )->GetStartPoint() );
+        points.push_back( ( (SCH_LINE*) aItem )->GetEndPoint() );
+    }
+
+    for( unsigned ii = 0; ii < points.size(); ii++ )
+        area.Merge( points[ii] );
+
+    // The labels of the sheet pins can be outside of the sheet
+    if( aItem->Type() == SCH_SHEET_T )
+    {
+        SCH_SHEET_PINS& pins = ( (SCH_SHEET*) aItem )->GetPins();
+
+        for( SCH_SHEET_PINS::iterator pin = pins.begin(); pin != pins.end(); ++pin )
+        {
+            EDA_RECT pinArea = pin->GetBoundingBox();
+
+            pinArea.Normalize();
+            area.Merge( pinArea );
+        }
+    }
+
+    area.Inflate( AREA_MARGIN );
+
+    return area;
+}
+
+
+bool SCH_ITEM_INDEX::cellRange( const EDA_RECT& aArea, CELL& aFirst, CELL& aLast )
+{
+    aFirst = CELL( cellOf( aArea.GetLeft() ), cellOf( aArea.GetTop() ) );
+    aLast = CELL( cellOf( aArea.GetRight() ), cellOf( aArea.GetBottom() ) );
+
+    double count = double( aLast.first - aFirst.first + 1 ) * ( aLast.second - aFirst.second + 1 );
+
+    return count <= MAX_ITEM_CELLS;
+}
+
+
+void SCH_ITEM_INDEX::Clear()
+{
+    m_entries.clear();
+    m_cells.clear();
+    m_largeItems.clear();
+    m_numbers.clear();
+}
+
+
+void SCH_ITEM_INDEX::Build( SCH_ITEM* aFirst )
+{
+    Clear();
+
+    for( SCH_ITEM* item = aFirst; item; item = item->Next() )
+        Add( item );
+}
+
+
+void SCH_ITEM_INDEX::Add( SCH_ITEM* aItem )
+{
+    ENTRY entry;
+
+    entry.m_Item = aItem;
+    entry.m_Area = ItemArea( aItem );
+
+    m_numbers[aItem] = m_entries.size();
+    m_entries.push_back( entry );
+    link( m_entries.size() - 1 );
+}
+
+
+void SCH_ITEM_INDEX::Remove( SCH_ITEM* aItem )
+{
+    int number = GetNumber( aItem );
+
+    if( number < 0 )
+        return;
+
+    unlink( number );
+    m_entries[number].m_Item = NULL;
+    m_numbers.erase( aItem );
+}
+
+
+void SCH_ITEM_INDEX::Update( SCH_ITEM* aItem )
+{
+    int number = GetNumber( aItem );
+
+    if( number < 0 )
+        return;
+
+    unlink( number );
+    m_entries[number].m_Area = ItemArea( aItem );
+    link( number );
+}
+
+
+int SCH_ITEM_INDEX::GetNumber( const SCH_ITEM* aItem ) const
+{
+    boost::unordered_map<const SCH_ITEM*, unsigned>::const_iterator it = m_numbers.find( aItem );
+
+    if( it == m_numbers.end() )
+        return -1;
+
+    return it->second;
+}
+
+
+void SCH_ITEM_INDEX::link( unsigned aNumber )
+{
+    CELL first, last;
+
+    if( !cellRange( m_entries[aNumber].m_Area, first, last ) )
+    {
+        m_largeItems.push_back( aNumber );
+        return;
+    }
+
+    for( int x = first.first; x <= last.first; x++ )
+    {
+        for( int y = first.second; y <= last.second; y++ )
+            m_cells[CELL( x, y )].push_back( aNumber );
+    }
+}
+
+
+void SCH_ITEM_INDEX::unlink( unsigned aNumber )
+{
+    CELL first, last;
+
+    if( !cellRange( m_entries[aNumber].m_Area, first, last ) )
+    {
+        m_largeItems.erase( std::remove( m_largeItems.begin(), m_largeItems.end(), aNumber ),
+                            m_largeItems.end() );
+        return;
+    }
+
+    for( int x = first.first; x <= last.first; x++ )
+    {
+        for( int y = first.second; y <= last.second; y++ )
+        {
+            CELL_MAP::iterator cell = m_cells.find( CELL( x, y ) );
+
+            if( cell == m_cells.end() )
+                continue;
+
+            std::vector<unsigned>& numbers = cell->second;
+
+            numbers.erase( std::remove( numbers.begin(), numbers.end(), aNumber ), numbers.end() );
+
+            if( numbers.empty() )
+                m_cells.erase( cell );
+        }
+    }
+}
+
+
+void SCH_ITEM_INDEX::Query( const EDA_RECT& aArea, std::vector<unsigned>& aNumbers ) const
+{
+    EDA_RECT area = aArea;
+    CELL     first, last;
+
+    area.Normalize();
+    aNumbers.clear();
+
+    if( cellRange( area, first, last ) )
+    {
+        for( int x = first.first; x <= last.first; x++ )
+        {
+            for( int y = first.second; y <= last.second; y++ )
+            {
+                CELL_MAP::const_iterator cell = m_cells.find( CELL( x, y ) );
+
+                if( cell != m_cells.end() )
+                    aNumbers.insert( aNumbers.end(), cell->second.begin(), cell->second.end() );
+            }
+        }
+    }
+    else
+    {
+        // Searching a large area: testing all the items is faster than reading the cells
+        for( unsigned ii = 0; ii < m_entries.size(); ii++ )
+        {
+            if( m_entries[ii].m_Item )
+                aNumbers.push_back( ii );
+        }
+    }
+
+    aNumbers.insert( aNumbers.end(), m_largeItems.begin(), m_largeItems.end() );
+
+    std::sort( aNumbers.begin(), aNumbers.end() );
+    aNumbers.erase( std::unique( aNumbers.begin(), aNumbers.end() ), aNumbers.end() );
+
+    unsigned count = 0;
+
+    for( unsigned ii = 0; ii < aNumbers.size(); ii++ )
+    {
+        if( areasIntersect( m_entries[aNumbers[ii]].m_Area, area ) )
+            aNumbers[count++] = aNumbers[ii];
+    }
+
+    aNumbers.resize( count );
+}
+
+
+void SCH_ITEM_INDEX::Query( const wxPoint& aPosition, int aAccuracy,
+                            std::vector<SCH_ITEM*>& aItems ) const
+{
+    std::vector<unsigned> numbers;
+    EDA_RECT area( aPosition, wxSize( 0, 0 ) );
+
+    area.Inflate( aAccuracy );
+    Query( area, numbers );
+
+    aItems.clear();
+
+    for( unsigned ii = 0; ii < numbers.size(); ii++ )
+        aItems.push_back( m_entries[numbers[ii]].m_Item );
+}
@@ -0,0 +1,153 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file sch_item_index.h
+ * @brief Grid index of the schematic items of a screen.
+ */
+
+#ifndef _SCH_ITEM_INDEX_H_
+#define _SCH_ITEM_INDEX_H_
+
+#include <vector>
+
+#include <hashtables.h>
+#include <class_eda_rect.h>
+
+class SCH_ITEM;
+
+
+/**
+ * Class SCH_ITEM_INDEX
+ * is a uniform grid giving the schematic items which can be found near a point or
+ * in an area.
+ * <p>
+ * Each item is stored with an area containing its bounding box, its connection points
+ * and the parts it owns (component fields, sheet pins), so all the items that can be hit
+ * or connected at a point are found.  The items are numbered in the order they are added,
+ * and the queries return them in this order, so when the index is built from a draw list,
+ * the items are found in the order of the draw list.
+ * </p>
+ * <p>
+ * The index does not know when the items are moved: the owner must call Update() or build
+ * the index again.
+ * </p>
+ */
+class SCH_ITEM_INDEX
+{
+public:
+    SCH_ITEM_INDEX() {}
+
+    /**
+     * Function Clear
+     * removes all the items from the index.
+     */
+    void Clear();
+
+    /**
+     * Function Build
+     * fills the index with the items of a draw list.
+     * @param aFirst = the first item of the list
+     */
+    void Build( SCH_ITEM* aFirst );
+
+    /**
+     * Function Add
+     * adds \a aItem after the items already in the index.
+     */
+    void Add( SCH_ITEM* aItem );
+
+    /**
+     * Function Remove
+     * removes \a aItem from the index.  Nothing is done if it is not in the index.
+     */
+    void Remove( SCH_ITEM* aItem );
+
+    /**
+     * Function Update
+     * stores again the area of \a aItem, after it has been moved or modified.  Its
+     * order is not changed.
+     */
+    void Update( SCH_ITEM* aItem );
+
+    /**
+     * Function Query
+     * finds the items whose area intersects \a aArea.
+     * @param aArea = the area to search
+     * @param aNumbers = the numbers of the items found, in increasing order
+     *                   (the previous content is cleared)
+     */
+    void Query( const EDA_RECT& aArea, std::vector<unsigned>& aNumbers ) const;
+
+    /**
+     * Function Query
+     * finds the items which can be hit at \a aPosition with \a aAccuracy.
+     * @param aItems = the items found, in the order they have been added
+     *                 (the previous content is cleared)
+     */
+    void Query( const wxPoint& aPosition, int aAccuracy, std::vector<SCH_ITEM*>& aItems ) const;
+
+    /**
+     * Function GetNumber
+     * @return the number of \a aItem (its rank when the index was built), or -1 if it is
+     *         not in the index.
+     */
+    int GetNumber( const SCH_ITEM* aItem ) const;
+
+    /// @return the item numbered \a aNumber, or NULL if it has been removed.
+    SCH_ITEM* GetItem( unsigned aNumber ) const         { return m_entries[aNumber].m_Item; }
+
+    /// @return the area stored for the item numbered \a aNumber.
+    const EDA_RECT& GetArea( unsigned aNumber ) const   { return m_entries[aNumber].m_Area; }
+
+    /**
+     * Function ItemArea
+     * @return the area stored in the index for \a aItem.
+     */
+    static EDA_RECT ItemArea( SCH_ITEM* aItem );
+
+private:
+    struct ENTRY
+    {
+        SCH_ITEM*   m_Item;
+        EDA_RECT    m_Area;
+    };
+
+    typedef std::pair<int, int>                                     CELL;
+    typedef boost::unordered_map< CELL, std::vector<unsigned> >     CELL_MAP;
+
+    /// Adds (or removes) the item numbered \a aNumber to (or from) the cells under its area
+    void link( unsigned aNumber );
+    void unlink( unsigned aNumber );
+
+    /// @return the cells under \a aArea in aFirst and aLast, false if they are too many
+    static bool cellRange( const EDA_RECT& aArea, CELL& aFirst, CELL& aLast );
+
+    std::vector<ENTRY>      m_entries;
+    CELL_MAP                m_cells;
+    std::vector<unsigned>   m_largeItems;       ///< items on too many cells, always tested
+
+    boost::unordered_map<const SCH_ITEM*, unsigned> m_numbers;
+};
+
+#endif    // _SCH_ITEM_INDEX_H_
@@ -55,6 +55,7 @@
 #include <lib_pin.h>
 
 #include <boost/foreach.hpp>
+#include <algorithm>
 
 #define EESCHEMA_FILE_STAMP   "EESchema"
 
@@ -93,12 +94,17 @@ static GRID_TYPE SchematicGridList[] = {
 };
 
 
+unsigned SCH_SCREEN::s_connectivityGeneration = 0;
+
+
 SCH_SCREEN::SCH_SCREEN( KIWAY* aKiway ) :
     BASE_SCREEN( SCH_SCREEN_T ),
     KIWAY_HOLDER( aKiway ),
     m_paper( wxT( "A4" ) )
 {
     m_modification_sync = 0;
+    m_itemIndexValid = false;
+    ConnectivityChanged();
 
     SetZoom( 32 );
 
@@ -153,12 +159,18 @@ void SCH_SCREEN::Clear()
 void SCH_SCREEN::FreeDrawList()
 {
     m_drawList.DeleteAll();
+    ConnectivityChanged();
 }
 
 
 void SCH_SCREEN::Remove( SCH_ITEM* aItem )
 {
     m_drawList.Remove( aItem );
+
+    if( aItem->Type() != SCH_MARKER_T )
+        ConnectivityChanged();
+    else
+        m_itemIndexValid = false;
 }
 
 
@@ -168,6 +180,11 @@ void SCH_SCREEN::DeleteItem( SCH_ITEM* aItem )
 
     SetModify();
 
+    if( aItem->Type() != SCH_MARKER_T )
+        ConnectivityChanged();
+    else
+        m_itemIndexValid = false;
+
     if( aItem->Type() == SCH_SHEET_PIN_T )
     {
         // This structure is attached to a sheet, get the parent sheet object.
@@ -201,10 +218,51 @@ bool SCH_SCREEN::CheckIfOnDrawList( SCH_ITEM* aItem )
 }
 
 
-SCH_ITEM* SCH_SCREEN::GetItem( const wxPoint& aPosition, int aAccuracy, KICAD_T aType ) const
+const SCH_ITEM_INDEX* SCH_SCREEN::getItemIndex() const
+{
+    SCH_ITEM* curItem = GetCurItem();
+
+    if( IsBlockActive() || ( curItem && curItem->GetFlags() ) )
+        return NULL;
+
+    if( !m_itemIndexValid )
+    {
+        m_itemIndex.Build( m_drawList.begin() );
+        m_itemIndexValid = true;
+    }
+
+    return &m_itemIndex;
+}
+
+
+void SCH_SCREEN::getItemsAt( const wxPoint& aPosition, int aAccuracy,
+                             std::vector< SCH_ITEM* >& aItems ) const
 {
+    const SCH_ITEM_INDEX* index = getItemIndex();
+
+    if( index )
+    {
+        index->Query( aPosition, aAccuracy, aItems );
+        return;
+    }
+
+    aItems.clear();
+
     for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+        aItems.push_back( item );
+}
+
+
+SCH_ITEM* SCH_SCREEN::GetItem( const wxPoint& aPosition, int aAccuracy, KICAD_T aType ) const
+{
+    std::vector< SCH_ITEM* > items;
+
+    getItemsAt( aPosition, aAccuracy, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        SCH_ITEM* item = items[ii];
+
         if( item->HitTest( aPosition, aAccuracy ) && (aType == NOT_USED) )
             return item;
 
@@ -264,6 +322,8 @@ void SCH_SCREEN::ExtractWires( DLIST< SCH_ITEM >& aList, bool aCreateCopy )
             break;
         }
     }
+
+    ConnectivityChanged();
 }
 
 
@@ -290,6 +350,7 @@ void SCH_SCREEN::ReplaceWires( DLIST< SCH_ITEM >& aWireList )
     }
 
     m_drawList.Append( aWireList );
+    ConnectivityChanged();
 }
 
 
@@ -429,52 +490,65 @@ bool SCH_SCREEN::SchematicCleanUp( EDA_DRAW_PANEL* aCanvas, wxDC* aDC )
     SCH_ITEM* item, * testItem;
     bool      modified = false;
 
-    item = m_drawList.begin();
+    // Only the items having a common point can be merged, so each item is only tested
+    // with the items found in its area, in the order of the draw list.
+    SCH_ITEM_INDEX index;
+    std::vector< unsigned > candidates;
+
+    index.Build( m_drawList.begin() );
 
-    for( ; item; item = item->Next() )
+    for( item = m_drawList.begin(); item; item = item->Next() )
     {
         if( ( item->Type() != SCH_LINE_T ) && ( item->Type() != SCH_JUNCTION_T ) )
             continue;
 
-        testItem = item->Next();
+        int number = index.GetNumber( item );
+
+        // Until a merge, only the next items are tested, after it all the items are
+        int firstCandidate = number + 1;
+
+        index.Query( index.GetArea( number ), candidates );
+
+        unsigned ii = 0;
 
-        while( testItem )
+        while( ii < candidates.size() )
         {
+            if( (int) candidates[ii] < firstCandidate )
+            {
+                ii++;
+                continue;
+            }
+
+            testItem = index.GetItem( candidates[ii] );
+
+            bool merged = false;
+
             if( ( item->Type() == SCH_LINE_T ) && ( testItem->Type() == SCH_LINE_T ) )
             {
                 SCH_LINE* line = (SCH_LINE*) item;
 
-                if( line->MergeOverlap( (SCH_LINE*) testItem ) )
-                {
-                    // Keep the current flags, because the deleted segment can be flagged.
-                    item->SetFlags( testItem->GetFlags() );
-                    DeleteItem( testItem );
-                    testItem = m_drawList.begin();
-                    modified = true;
-                }
-                else
-                {
-                    testItem = testItem->Next();
-                }
+                merged = line->MergeOverlap( (SCH_LINE*) testItem );
             }
             else if ( ( ( item->Type() == SCH_JUNCTION_T ) && ( testItem->Type() == SCH_JUNCTION_T ) ) && ( testItem != item ) )
             {
-                if ( testItem->HitTest( item->GetPosition() ) )
-                {
-                    // Keep the current flags, because the deleted segment can be flagged.
-                    item->SetFlags( testItem->GetFlags() );
-                    DeleteItem( testItem );
-                    testItem = m_drawList.begin();
-                    modified = true;
-                }
-                else
-                {
-                    testItem = testItem->Next();
-                }
+                merged = testItem->HitTest( item->GetPosition() );
+            }
+
+            if( merged )
+            {
+                // Keep the current flags, because the deleted segment can be flagged.
+                item->SetFlags( testItem->GetFlags() );
+                index.Remove( testItem );
+                DeleteItem( testItem );
+                index.Update( item );
+                index.Query( index.GetArea( number ), candidates );
+                firstCandidate = 0;
+                ii = 0;
+                modified = true;
             }
             else
             {
-                testItem = testItem->Next();
+                ii++;
             }
         }
     }
@@ -565,6 +639,10 @@ void SCH_SCREEN::CheckComponentsToPartsLinks()
 
             SCH_COMPONENT::ResolveAll( c, libs );
 
+            // The pins and the bounding boxes of the components come from their new
+            // parts, so the item index and the connections must be built again.
+            ConnectivityChanged();
+
             m_modification_sync = mod_hash;     // note the last mod_hash
 
             // guard against unneeded runs through this code path by printing trace
@@ -650,9 +728,14 @@ LIB_PIN* SCH_SCREEN::GetPin( const wxPoint& aPosition, SCH_COMPONENT** aComponen
     SCH_ITEM*       item;
     SCH_COMPONENT*  component = NULL;
     LIB_PIN*        pin = NULL;
+    std::vector< SCH_ITEM* > items;
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
+    getItemsAt( aPosition, 0, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        item = items[ii];
+
         if( item->Type() != SCH_COMPONENT_T )
             continue;
 
@@ -720,13 +803,16 @@ SCH_SHEET* SCH_SCREEN::GetSheet( const wxString& aName )
 SCH_SHEET_PIN* SCH_SCREEN::GetSheetLabel( const wxPoint& aPosition )
 {
     SCH_SHEET_PIN* sheetPin = NULL;
+    std::vector< SCH_ITEM* > items;
 
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    getItemsAt( aPosition, 0, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
-        if( item->Type() != SCH_SHEET_T )
+        if( items[ii]->Type() != SCH_SHEET_T )
             continue;
 
-        SCH_SHEET* sheet = (SCH_SHEET*) item;
+        SCH_SHEET* sheet = (SCH_SHEET*) items[ii];
         sheetPin = sheet->GetPin( aPosition );
 
         if( sheetPin )
@@ -741,9 +827,14 @@ int SCH_SCREEN::CountConnectedItems( const wxPoint& aPos, bool aTestJunctions )
 {
     SCH_ITEM* item;
     int       count = 0;
+    std::vector< SCH_ITEM* > items;
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
+    getItemsAt( aPos, 0, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        item = items[ii];
+
         if( item->Type() == SCH_JUNCTION_T  && !aTestJunctions )
             continue;
 
@@ -935,14 +1026,52 @@ bool SCH_SCREEN::TestDanglingEnds( EDA_DRAW_PANEL* aCanvas, wxDC* aDC )
 {
     SCH_ITEM* item;
     std::vector< DANGLING_END_ITEM > endPoints;
+    std::vector< unsigned > firstEndPoint;  // index of the first end point of each item
     bool hasDanglingEnds = false;
 
     for( item = m_drawList.begin(); item; item = item->Next() )
+    {
+        firstEndPoint.push_back( endPoints.size() );
         item->GetEndPoints( endPoints );
+    }
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
+    firstEndPoint.push_back( endPoints.size() );
+
+    // An item can only be connected to the end points of the items found at its own
+    // end points.  They are given to the item in the order of the draw list, so the wire
+    // ends stay in pairs.  The index is built here, because this function is also called
+    // while items are moved.
+    SCH_ITEM_INDEX index;
+    std::vector< DANGLING_END_ITEM > nearEndPoints;
+    std::vector< unsigned > nearItems;
+    std::vector< unsigned > found;
+    unsigned number = 0;
+
+    index.Build( m_drawList.begin() );
+
+    for( item = m_drawList.begin(); item; item = item->Next(), number++ )
     {
-        if( item->IsDanglingStateChanged( endPoints ) && ( aCanvas ) && ( aDC ) )
+        nearItems.clear();
+
+        for( unsigned ii = firstEndPoint[number]; ii < firstEndPoint[number + 1]; ii++ )
+        {
+            index.Query( EDA_RECT( endPoints[ii].GetPosition(), wxSize( 0, 0 ) ), found );
+            nearItems.insert( nearItems.end(), found.begin(), found.end() );
+        }
+
+        std::sort( nearItems.begin(), nearItems.end() );
+        nearItems.erase( std::unique( nearItems.begin(), nearItems.end() ), nearItems.end() );
+
+        nearEndPoints.clear();
+
+        for( unsigned ii = 0; ii < nearItems.size(); ii++ )
+        {
+            nearEndPoints.insert( nearEndPoints.end(),
+                                  endPoints.begin() + firstEndPoint[nearItems[ii]],
+                                  endPoints.begin() + firstEndPoint[nearItems[ii] + 1] );
+        }
+
+        if( item->IsDanglingStateChanged( nearEndPoints ) && ( aCanvas ) && ( aDC ) )
         {
             item->Draw( aCanvas, aDC, wxPoint( 0, 0 ), g_XorMode );
             item->Draw( aCanvas, aDC, wxPoint( 0, 0 ), GR_DEFAULT_DRAWMODE );
@@ -981,6 +1110,9 @@ bool SCH_SCREEN::BreakSegment( const wxPoint& aPoint )
         brokenSegments = true;
     }
 
+    if( brokenSegments )
+        ConnectivityChanged();
+
     return brokenSegments;
 }
 
@@ -1016,8 +1148,14 @@ bool SCH_SCREEN::BreakSegmentsOnJunctions()
 
 int SCH_SCREEN::GetNode( const wxPoint& aPosition, EDA_ITEMS& aList )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector< SCH_ITEM* > items;
+
+    getItemsAt( aPosition, 0, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        SCH_ITEM* item = items[ii];
+
         if( item->Type() == SCH_LINE_T && item->HitTest( aPosition )
             && (item->GetLayer() == LAYER_BUS || item->GetLayer() == LAYER_WIRE) )
         {
@@ -1035,8 +1173,14 @@ int SCH_SCREEN::GetNode( const wxPoint& aPosition, EDA_ITEMS& aList )
 
 SCH_LINE* SCH_SCREEN::GetWireOrBus( const wxPoint& aPosition )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector< SCH_ITEM* > items;
+
+    getItemsAt( aPosition, 0, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        SCH_ITEM* item = items[ii];
+
         if( (item->Type() == SCH_LINE_T) && item->HitTest( aPosition )
             && (item->GetLayer() == LAYER_BUS || item->GetLayer() == LAYER_WIRE) )
         {
@@ -1051,8 +1195,14 @@ SCH_LINE* SCH_SCREEN::GetWireOrBus( const wxPoint& aPosition )
 SCH_LINE* SCH_SCREEN::GetLine( const wxPoint& aPosition, int aAccuracy, int aLayer,
                                SCH_LINE_TEST_T aSearchType )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector< SCH_ITEM* > items;
+
+    getItemsAt( aPosition, aAccuracy, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        SCH_ITEM* item = items[ii];
+
         if( item->Type() != SCH_LINE_T )
             continue;
 
@@ -1084,8 +1234,14 @@ SCH_LINE* SCH_SCREEN::GetLine( const wxPoint& aPosition, int aAccuracy, int aLay
 
 SCH_TEXT* SCH_SCREEN::GetLabel( const wxPoint& aPosition, int aAccuracy )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector< SCH_ITEM* > items;
+
+    getItemsAt( aPosition, aAccuracy, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        SCH_ITEM* item = items[ii];
+
         switch( item->Type() )
         {
         case SCH_LABEL_T:
@@ -1444,6 +1600,13 @@ void SCH_SCREENS::SchematicCleanUp()
 }
 
 
+void SCH_SCREENS::ConnectivityChanged()
+{
+    for( size_t i = 0;  i < m_screens.size();  i++ )
+        m_screens[i]->ConnectivityChanged();
+}
+
+
 int SCH_SCREENS::ReplaceDuplicateTimeStamps()
 {
     EDA_ITEMS items;
@@ -117,6 +117,9 @@ void SCH_EDIT_FRAME::SaveCopyInUndoList( SCH_ITEM*      aItem,
     if( aItem == NULL || aCommandType == UR_WIRE_IMAGE )
         return;
 
+    // The item is about to be changed, and perhaps its connections
+    GetScreen()->ConnectivityChanged();
+
     PICKED_ITEMS_LIST* commandToUndo = new PICKED_ITEMS_LIST();
     commandToUndo->m_TransformPoint = aTransformPoint;
 
@@ -162,6 +165,9 @@ void SCH_EDIT_FRAME::SaveCopyInUndoList( const PICKED_ITEMS_LIST& aItemsList,
                                          UNDO_REDO_T        aTypeCommand,
                                          const wxPoint&     aTransformPoint )
 {
+    // The items are about to be changed, and perhaps their connections
+    GetScreen()->ConnectivityChanged();
+
     PICKED_ITEMS_LIST* commandToUndo = new PICKED_ITEMS_LIST();
 
     commandToUndo->m_TransformPoint = aTransformPoint;
@@ -234,6 +240,8 @@ void SCH_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
     SCH_ITEM* item;
     SCH_ITEM* alt_item;
 
+    GetScreen()->ConnectivityChanged();
+
     // Exchange the current wires, buses, and junctions with the copy save by the last edit.
     if( aList->m_Status == UR_WIRE_IMAGE )
     {
@@ -62,6 +62,7 @@ class DIALOG_SCH_FIND;
 class wxFindDialogEvent;
 class wxFindReplaceData;
 class SCHLIB_FILTER;
+class SCH_CONNECTIVITY;
 
 
 /// enum used in RotationMiroir()
@@ -139,6 +140,7 @@ private:
     SCH_COLLECTOR           m_collectedItems;     ///< List of collected items.
     SCH_FIND_COLLECTOR      m_foundItems;         ///< List of find/replace items.
     SCH_ITEM*               m_undoItem;           ///< Copy of the current item being edited.
+    SCH_CONNECTIVITY*       m_connectivity;       ///< Connections kept between netlist builds.
     wxString                m_simulatorCommand;   ///< Command line used to call the circuit
                                                   ///< simulator (gnucap, spice, ...)
     wxString                m_netListerCommand;   ///< Command line to call a custom net list
@@ -493,6 +495,7 @@ public:
      * netlist generation:
      * Creates a flat list which stores all connected objects, and mainly
      * pins and labels.
+     * Only the sheets modified since the previous call are read again.
      * @return NETLIST_OBJECT_LIST* - caller owns the object.
      */
     NETLIST_OBJECT_LIST* BuildNetListBase();
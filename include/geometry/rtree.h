@@ -30,6 +30,9 @@
 #include <assert.h>
 #include <stdlib.h>
 
+#include <vector>
+#include <algorithm>
+
 #define ASSERT assert    // RTree uses ASSERT( condition )
 #ifndef rMin
   #define rMin std::min
@@ -120,6 +123,18 @@ public:
                  const ELEMTYPE     a_max[NUMDIMS],
                  const DATATYPE&    a_dataId );
 
+    /// Remove all entries and insert a_count entries at once.  The nodes are packed
+    /// with the Sort-Tile-Recursive algorithm, which is much faster than inserting the
+    /// entries one by one and gives less overlapping nodes.
+    /// \param a_min Mins of the bounding rects, NUMDIMS values per entry
+    /// \param a_max Maxs of the bounding rects, NUMDIMS values per entry
+    /// \param a_dataIds Data of the entries
+    /// \param a_count Number of entries
+    void BulkLoad( const ELEMTYPE*  a_min,
+                   const ELEMTYPE*  a_max,
+                   const DATATYPE*  a_dataIds,
+                   int              a_count );
+
     /// Find all within search rectangle
     /// \param a_min Min of search bounding rect
     /// \param a_max Max of search bounding rect
@@ -432,6 +447,20 @@ protected:
         bool isLeaf;
     };
 
+    /// Orders branches by the center of their rect along an axis
+    struct BranchCenterLess
+    {
+        BranchCenterLess( int a_axis ) : m_axis( a_axis ) {}
+
+        bool operator()( const Branch& a_branchA, const Branch& a_branchB ) const
+        {
+            return (ELEMTYPEREAL) a_branchA.m_rect.m_min[m_axis] + a_branchA.m_rect.m_max[m_axis] <
+                   (ELEMTYPEREAL) a_branchB.m_rect.m_min[m_axis] + a_branchB.m_rect.m_max[m_axis];
+        }
+
+        int m_axis;
+    };
+
     Node*           AllocNode();
     void            FreeNode( Node* a_node );
     void            InitNode( Node* a_node );
@@ -457,6 +486,7 @@ protected:
     void            InitParVars( PartitionVars* a_parVars, int a_maxRects, int a_minFill );
     void            PickSeeds( PartitionVars* a_parVars );
     void            Classify( int a_index, int a_group, PartitionVars* a_parVars );
+    void            SortTileRecursive( Branch* a_branches, int a_count, int a_axis );
     bool            RemoveRect( Rect* a_rect, const DATATYPE& a_id, Node** a_root );
     bool            RemoveRectRec( Rect*            a_rect,
                                    const DATATYPE&  a_id,
@@ -665,6 +695,89 @@ void RTREE_QUAL::Insert( const ELEMTYPE     a_min[NUMDIMS],
 }
 
 
+RTREE_TEMPLATE
+void RTREE_QUAL::BulkLoad( const ELEMTYPE*  a_min,
+                           const ELEMTYPE*  a_max,
+                           const DATATYPE*  a_dataIds,
+                           int              a_count )
+{
+    RemoveAll();
+
+    if( a_count <= 0 )
+        return;
+
+    std::vector<Branch> branches( a_count );
+
+    for( int index = 0; index < a_count; ++index )
+    {
+        for( int axis = 0; axis < NUMDIMS; ++axis )
+        {
+            branches[index].m_rect.m_min[axis]  = a_min[index * NUMDIMS + axis];
+            branches[index].m_rect.m_max[axis]  = a_max[index * NUMDIMS + axis];
+        }
+
+        branches[index].m_data = a_dataIds[index];
+    }
+
+    // Pack the leaves, then each upper level, until a single node is left
+    for( int level = 0; ; ++level )
+    {
+        int count = branches.size();
+        int nodeCount = ( count + MAXNODES - 1 ) / MAXNODES;
+
+        SortTileRecursive( &branches[0], count, 0 );
+
+        std::vector<Branch> parents( nodeCount );
+
+        for( int node = 0; node < nodeCount; ++node )
+        {
+            Node* newNode = AllocNode();
+            newNode->m_level = level;
+
+            for( int index = node * MAXNODES; index < rMin( count, ( node + 1 ) * MAXNODES );
+                 ++index )
+            {
+                newNode->m_branch[newNode->m_count++] = branches[index];
+            }
+
+            parents[node].m_rect    = NodeCover( newNode );
+            parents[node].m_child   = newNode;
+        }
+
+        if( nodeCount == 1 )
+        {
+            FreeNode( m_root );
+            m_root = parents[0].m_child;
+            return;
+        }
+
+        branches.swap( parents );
+    }
+}
+
+
+// Sort the branches so that each run of MAXNODES branches forms a tile: sort them
+// along an axis, cut them in slices, and sort each slice along the next axis.
+RTREE_TEMPLATE
+void RTREE_QUAL::SortTileRecursive( Branch* a_branches, int a_count, int a_axis )
+{
+    std::sort( a_branches, a_branches + a_count, BranchCenterLess( a_axis ) );
+
+    if( a_axis == NUMDIMS - 1 )
+        return;
+
+    int nodeCount   = ( a_count + MAXNODES - 1 ) / MAXNODES;
+    int sliceCount  = (int) ceil( pow( (double) nodeCount, 1.0 / ( NUMDIMS - a_axis ) ) );
+    int sliceSize   = MAXNODES * ( ( nodeCount + sliceCount - 1 ) / sliceCount );
+
+    for( int first = 0; first < a_count; first += sliceSize )
+    {
+        SortTileRecursive( a_branches + first, rMin( sliceSize, a_count - first ),
+                           a_axis + 1 );
+    }
+}
+
+
 RTREE_TEMPLATE
 void RTREE_QUAL::Remove( const ELEMTYPE     a_min[NUMDIMS],
                          const ELEMTYPE     a_max[NUMDIMS],
@@ -27,6 +27,8 @@
 #define __SHAPE_FILE_IO_H
 
 #include <cstdio>
+#include <string>
+#include <sstream>
 
 class SHAPE;
 
@@ -51,8 +53,27 @@ class SHAPE_FILE_IO
         void BeginGroup( const std::string aName = "<noname>");
         void EndGroup();
 
+        /**
+         * Function Read
+         * reads the next shape of the file (opened with IOM_READ).  Polygon sets and
+         * line chains are supported.
+         * @return the new shape (owned by the caller), or NULL at the end of the file
+         * or if the shape cannot be read.
+         */
         SHAPE* Read();
 
+        ///> Returns the name of the last shape returned by Read()
+        const std::string& GetShapeName() const
+        {
+            return m_shapeName;
+        }
+
+        ///> Returns the name of the group of the last shape returned by Read()
+        const std::string& GetGroupName() const
+        {
+            return m_groupName;
+        }
+
         void Write( const SHAPE* aShape, const std::string aName = "<noname>" );
 
         void Write( const SHAPE& aShape, const std::string aName = "<noname>" )
@@ -64,6 +85,11 @@ class SHAPE_FILE_IO
         FILE* m_file;
         bool m_groupActive;
         IO_MODE m_mode;
+
+        ///> The file contents in IOM_READ mode, since shapes are parsed from a stream
+        std::stringstream m_readStream;
+        std::string m_shapeName;
+        std::string m_groupName;
 };
 
 #endif
@@ -258,6 +258,15 @@ class SHAPE_INDEX
          */
         void Reindex();
 
+        /**
+         * Function BulkLoad()
+         *
+         * Replaces the contents of the index with aShapes, packing the R-tree in one go,
+         * which is much faster than adding the shapes one by one.
+         * @param aShapes the shapes to store
+         */
+        void BulkLoad( const std::vector<T>& aShapes );
+
         /**
          * Function Query()
          *
@@ -335,23 +344,38 @@ void SHAPE_INDEX<T>::RemoveAll()
 template <class T>
 void SHAPE_INDEX<T>::Reindex()
 {
-    RTree<T, int, 2, float>* newTree;
-    newTree = new RTree<T, int, 2, float>();
+    std::vector<T> shapes;
 
     Iterator iter = this->Begin();
 
     while( !iter.IsNull() )
     {
-        T shape = *iter;
-        BOX2I box = boundingBox( shape );
-        int min[2] = { box.GetX(), box.GetY() };
-        int max[2] = { box.GetRight(), box.GetBottom() };
-        newTree->Insert( min, max, shape );
+        shapes.push_back( *iter );
         iter++;
     }
 
-    delete this->m_tree;
-    this->m_tree = newTree;
+    BulkLoad( shapes );
+}
+
+template <class T>
+void SHAPE_INDEX<T>::BulkLoad( const std::vector<T>& aShapes )
+{
+    int count = aShapes.size();
+    std::vector<int> mins( 2 * count ), maxs( 2 * count );
+
+    for( int i = 0; i < count; i++ )
+    {
+        BOX2I box = boundingBox( aShapes[i] );
+        mins[2 * i]     = box.GetX();
+        mins[2 * i + 1] = box.GetY();
+        maxs[2 * i]     = box.GetRight();
+        maxs[2 * i + 1] = box.GetBottom();
+    }
+
+    if( count )
+        this->m_tree->BulkLoad( &mins[0], &maxs[0], &aShapes[0], count );
+    else
+        this->m_tree->RemoveAll();
 }
 
 template <class T>
@@ -27,6 +27,7 @@
 
 #include <vector>
 #include <cstdio>
+#include <boost/shared_ptr.hpp>
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
 
@@ -39,7 +40,13 @@
  * Represents a set of closed polygons. Polygons may be nonconvex, self-intersecting
  * and have holes. Provides boolean operations (using Clipper library as the backend).
  *
- * TODO: add convex partitioning & spatial index
+ * Contains() and Collide() build, on first use, an index of the edges of each large
+ * outline, which is kept until the set is modified.  References to the outlines or
+ * vertices (given by Outline(), Hole(), Polygon(), Vertex() and Iterate()) must not be
+ * used to modify the set after a call to Contains() or Collide(): these accessors drop
+ * the index, but a reference taken before the call does not.  Debug builds check it.
+ *
+ * TODO: add convex partitioning
  */
 class SHAPE_POLY_SET : public SHAPE
 {
@@ -96,7 +103,7 @@ class SHAPE_POLY_SET : public SHAPE
 
             T& Get()
             {
-                return m_poly->Polygon( m_currentOutline )[0].Point( m_currentVertex );
+                return m_poly->m_polys[m_currentOutline][0].Point( m_currentVertex );
             }
 
             T& operator*()
@@ -172,18 +179,21 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns the reference to aIndex-th outline in the set
         SHAPE_LINE_CHAIN& Outline( int aIndex )
         {
+            invalidateIndex();
             return m_polys[aIndex][0];
         }
 
         ///> Returns the reference to aHole-th hole in the aIndex-th outline
         SHAPE_LINE_CHAIN& Hole( int aOutline, int aHole )
         {
+            invalidateIndex();
             return m_polys[aOutline][aHole + 1];
         }
 
         ///> Returns the aIndex-th subpolygon in the set
         POLYGON& Polygon( int aIndex )
         {
+            invalidateIndex();
             return m_polys[aIndex];
         }
 
@@ -205,6 +215,8 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Returns an iterator object, for iterating between aFirst and aLast outline.
         ITERATOR Iterate( int aFirst, int aLast )
         {
+            invalidateIndex();
+
             ITERATOR iter;
 
             iter.m_poly = this;
@@ -324,13 +336,20 @@ class SHAPE_POLY_SET : public SHAPE
 
         const BOX2I BBox( int aClearance = 0 ) const;
 
-        // fixme: add collision support
-        bool Collide( const VECTOR2I& aP, int aClearance = 0 ) const { return false; }
-        bool Collide( const SEG& aSeg, int aClearance = 0 ) const { return false; }
+        ///> Returns true if aP is inside an outline, or closer than aClearance to one.
+        ///> Like Contains(), holes are not taken into account.
+        bool Collide( const VECTOR2I& aP, int aClearance = 0 ) const;
+
+        ///> Returns true if aSeg crosses an outline, is inside it, or is closer than
+        ///> aClearance to it.  Like Contains(), holes are not taken into account.
+        bool Collide( const SEG& aSeg, int aClearance = 0 ) const;
 
 
         ///> Returns true is a given subpolygon contains the point aP. If aSubpolyIndex < 0 (default value),
-        ///> checks all polygons in the set
+        ///> checks all polygons in the set.
+        ///> The edges of the large outlines are indexed on the first call, so that the next
+        ///> calls only test the edges near aP.  The index is not built by several threads
+        ///> at once: a set must not be shared between threads before its first query.
         bool Contains( const VECTOR2I& aP, int aSubpolyIndex = -1 ) const;
 
         ///> Returns true if the set is empty (no polygons at all)
@@ -378,12 +397,35 @@ class SHAPE_POLY_SET : public SHAPE
 
         bool pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN& aPath ) const;
 
+        ///> Index of the edges of an outline, for Contains()
+        struct OUTLINE_INDEX;
+        typedef boost::shared_ptr<const OUTLINE_INDEX> OUTLINE_INDEX_PTR;
+
+        ///> Returns the index of the outline of the aIndex-th polygon, building it if needed,
+        ///> or NULL if the outline is too small to be indexed
+        const OUTLINE_INDEX* outlineIndex( int aIndex ) const;
+
+        ///> Returns true if aSeg is closer than aClearance to an edge of the outline of
+        ///> the aIndex-th polygon
+        bool collideOutlineEdges( int aIndex, const SEG& aSeg, int aClearance ) const;
+
+        ///> Drops the outline indexes: must be called by all the methods which can
+        ///> modify the polygons
+        void invalidateIndex()
+        {
+            m_outlineIndex.clear();
+        }
+
         const ClipperLib::Path convertToClipper( const SHAPE_LINE_CHAIN& aPath, bool aRequiredOrientation );
         const SHAPE_LINE_CHAIN convertFromClipper( const ClipperLib::Path& aPath );
 
         typedef std::vector<POLYGON> Polyset;
 
         Polyset m_polys;
+
+        ///> The index of each outline, built by Contains(). A copy of a set shares
+        ///> the indexes with the original, until one of them is modified.
+        mutable std::vector<OUTLINE_INDEX_PTR> m_outlineIndex;
 };
 
 #endif
@@ -51,6 +51,7 @@ class PCB_TARGET;
 class DIMENSION;
 class EDGE_MODULE;
 class DRC;
+class ZONE_CLEARANCE_CACHE;
 class ZONE_CONTAINER;
 class DRAWSEGMENT;
 class GENERAL_COLLECTOR;
@@ -95,6 +96,9 @@ protected:
 
     DRC* m_drc;                                 ///< the DRC controller, see drc.cpp
 
+    /// the pad and track clearance polygons kept between zone fills
+    ZONE_CLEARANCE_CACHE* m_zoneClearanceCache;
+
     PARAM_CFG_ARRAY   m_configSettings;         ///< List of Pcbnew configuration settings.
 
     wxString          m_lastNetListRead;        ///< Last net list read with relative path.
@@ -1422,6 +1426,19 @@ public:
      */
     int Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose = true );
 
+    /**
+     * Function Fill_Zones_In_Areas
+     * refills only the zones which can be modified by a change of the board items
+     * inside aDirtyAreas, for instance the old and new bounding boxes of moved items.
+     * The other zones keep their filled areas.
+     * Used by the incremental DRC, and by the point editor when a zone outline is edited.
+     * @param aDirtyAreas = the areas of the board which were modified
+     * @param aFilledOnly = true to leave unfilled the zones which are not filled
+     * @return the number of refilled zones
+     */
+    int Fill_Zones_In_Areas( const std::vector<EDA_RECT>& aDirtyAreas,
+                             bool aFilledOnly = false );
+
 
     /**
      * Function Add_Zone_Cutout
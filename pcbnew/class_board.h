@@ -1205,13 +1205,6 @@ public:
 
     /****** function relative to ratsnest calculations: */
 
-    /**
-     * Function Test_Connection_To_Copper_Areas
-     * init .m_ZoneSubnet parameter in tracks and pads according to the connections to areas found
-     * @param aNetcode = netcode to analyze. if -1, analyze all nets
-     */
-    void Test_Connections_To_Copper_Areas( int aNetcode = -1 );
-
     /**
      * Function GetViaByPosition
      * finds the first via at \a aPosition on \a aLayer.
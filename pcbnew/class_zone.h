@@ -48,6 +48,7 @@ class PCB_EDIT_FRAME;
 class BOARD;
 class ZONE_CONTAINER;
 class MSG_PANEL_ITEM;
+class ZONE_OBSTACLES_INDEX;
 
 
 /**
@@ -282,8 +283,20 @@ public:
      * When aOutlineBuffer is not null, his function calls
      * AddClearanceAreasPolygonsToPolysList() to add holes for pads and tracks
      * and other items not in net.
+     * @param aObstacles: an index of the items of aPcb, used to find the items
+     * near the zone, or NULL to test all the items of aPcb
      */
-    bool BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET* aOutlineBuffer = NULL );
+    bool BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET* aOutlineBuffer = NULL,
+                                        const ZONE_OBSTACLES_INDEX* aObstacles = NULL );
+
+    /**
+     * Function BuildSmoothedPoly
+     * creates the corner-smoothed version of m_Poly, using the current corner
+     * smoothing settings.  The zone is not modified, so this can be used on a zone
+     * while another thread fills it.
+     * @return CPolyLine* - the new polygon, owned by the caller.
+     */
+    CPolyLine* BuildSmoothedPoly() const;
 
     /**
      * Function AddClearanceAreasPolygonsToPolysList
@@ -298,7 +311,8 @@ public:
      * _NG version uses SHAPE_POLY_SET instead of Boost.Polygon
      */
     void AddClearanceAreasPolygonsToPolysList( BOARD* aPcb );
-    void AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb );
+    void AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb,
+                                                  const ZONE_OBSTACLES_INDEX* aObstacles = NULL );
 
 
      /**
@@ -547,7 +561,8 @@ public:
 
 
 private:
-    void buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeatures );
+    void buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeatures,
+                               const ZONE_OBSTACLES_INDEX* aObstacles );
 
     CPolyLine*            m_Poly;                ///< Outline of the zone.
     CPolyLine*            m_smoothedPoly;        // Corner-smoothed version of m_Poly
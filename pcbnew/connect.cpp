@@ -29,18 +29,17 @@
  */
 
 #include <fctsys.h>
+#include <map>
 #include <common.h>
 #include <macros.h>
 #include <wxBasePcbFrame.h>
 
 #include <pcbnew.h>
+#include <ratsnest_data.h>
 
 // Helper classes to handle connection points
 #include <connect.h>
 
-extern void Merge_SubNets_Connected_By_CopperAreas( BOARD* aPcb );
-extern void Merge_SubNets_Connected_By_CopperAreas( BOARD* aPcb, int aNetcode );
-
 // Local functions
 static void RebuildTrackChain( BOARD* pcb );
 
@@ -64,45 +63,6 @@ void CONNECTIONS::BuildPadsList( int aNetcode )
     m_brd->GetSortedPadListByXthenYCoord( m_sortedPads, aNetcode < 0 ? -1 : aNetcode );
 }
 
-/* Explores the list of pads and adds to m_PadsConnected member
- * of each pad pads connected to
- * Here, connections are due to intersecting pads, not tracks
- */
-void CONNECTIONS::SearchConnectionsPadsToIntersectingPads()
-{
-    std::vector<CONNECTED_POINT*> candidates;
-
-    BuildPadsCandidatesList();
-
-    for( unsigned ii = 0; ii < m_sortedPads.size(); ii++ )
-    {
-        D_PAD* pad = m_sortedPads[ii];
-
-        pad->m_PadsConnected.clear();
-        candidates.clear();
-
-        CollectItemsNearTo( candidates, pad->ShapePos(), pad->GetBoundingRadius() );
-
-        // add pads to pad.m_PadsConnected, if they are connected
-        for( unsigned jj = 0; jj < candidates.size(); jj++ )
-        {
-            CONNECTED_POINT* item = candidates[jj];
-
-            D_PAD* candidate_pad = item->GetPad();
-
-            if( pad == candidate_pad )
-                continue;
-
-            if( !( pad->GetLayerSet() & candidate_pad->GetLayerSet() ).any() )
-                continue;
-            if( pad->HitTest( item->GetPoint() ) )
-            {
-                pad->m_PadsConnected.push_back( candidate_pad );
-            }
-        }
-    }
-}
-
 /* Explores the list of pads
  * Adds to m_PadsConnected member of each track the pad(s) connected to
  * Adds to m_TracksConnected member of each pad the track(s) connected to
@@ -222,18 +182,6 @@ void CONNECTIONS::CollectItemsNearTo( std::vector<CONNECTED_POINT*>& aList,
 }
 
 
-void CONNECTIONS::BuildPadsCandidatesList()
-{
-    m_candidates.clear();
-    m_candidates.reserve( m_sortedPads.size() );
-    for( unsigned ii = 0; ii < m_sortedPads.size(); ii++ )
-    {
-        D_PAD * pad = m_sortedPads[ii];
-        CONNECTED_POINT candidate( pad, pad->GetPosition() );
-        m_candidates.push_back( candidate );
-    }
-}
-
 /* sort function used to sort .m_Connected by X the Y values
  * items are sorted by X coordinate value,
  * and for same X value, by Y coordinate value.
@@ -449,278 +397,68 @@ int CONNECTIONS::searchEntryPointInCandidatesList( const wxPoint& aPoint )
     return -1;
 }
 
-/* Used after a track change (delete a track ou add a track)
- * Connections to pads are recalculated
- * Note also aFirstTrack (and aLastTrack ) can be NULL
- */
-void CONNECTIONS::Build_CurrNet_SubNets_Connections( TRACK* aFirstTrack, TRACK* aLastTrack, int aNetcode )
-{
-    m_firstTrack = aFirstTrack;     // The first track used to build m_Candidates
-    m_lastTrack = aLastTrack;       // The last track used to build m_Candidates
-
-    // Pads subnets are expected already cleared, because this function
-    // does not know the full list of pads
-    BuildTracksCandidatesList( aFirstTrack, aLastTrack );
-    TRACK* curr_track;
-    for( curr_track = aFirstTrack; curr_track != NULL; curr_track = curr_track->Next() )
-    {
-        // Clear track subnet id (Pads subnets are cleared outside this function)
-        curr_track->SetSubNet( 0 );
-        curr_track->m_TracksConnected.clear();
-        curr_track->m_PadsConnected.clear();
-
-        // Update connections between tracks:
-        SearchConnectedTracks( curr_track );
-        curr_track->m_TracksConnected = m_connected;
-
-        if( curr_track == aLastTrack )
-            break;
-    }
-
-    // Update connections between tracks and pads
-    BuildPadsList( aNetcode );
-    SearchTracksConnectedToPads();
-
-    // Update connections between intersecting pads (no tracks)
-    SearchConnectionsPadsToIntersectingPads();
-
-    // Creates sub nets (clusters) for the current net:
-    Propagate_SubNets();
-}
-
 
-/**
- * Change a subnet value to a new value, in m_sortedPads pad list
- * After that, 2 cluster (or subnets) are merged into only one.
- * Note: the resulting subnet value is the smallest between aOldSubNet et aNewSubNet
+/*
+ * Set the subnet of the pads and the tracks of a net (of all nets if aNetCode < 0)
+ * from the groups of connected items found by the board ratsnest.
+ * Subnets are numbered from 1 in each net. Items not connected to an other pad or
+ * track get no subnet (0), as expected by TestForActiveLinksInRatsnest()
  */
-int CONNECTIONS::Merge_PadsSubNets( int aOldSubNet, int aNewSubNet )
+static void setSubNetsFromRatsnest( BOARD* aPcb, int aNetCode )
 {
-    int    change_count = 0;
-
-    if( aOldSubNet == aNewSubNet )
-        return 0;
-
-    if( (aOldSubNet > 0) && (aOldSubNet < aNewSubNet) )
-        std::swap( aOldSubNet, aNewSubNet );
+    RN_DATA* ratsnest = aPcb->GetRatsnest();
+    std::vector<BOARD_CONNECTED_ITEM*> items;
 
-    // Examine connections between intersecting pads
-    for( unsigned ii = 0; ii < m_sortedPads.size(); ii++ )
+    for( unsigned i = 0; i < aPcb->GetPadCount(); ++i )
     {
-        D_PAD * curr_pad = m_sortedPads[ii];
-        if( curr_pad->GetSubNet() != aOldSubNet )
-            continue;
+        D_PAD* pad = aPcb->GetPad( i );
 
-        change_count++;
-        curr_pad->SetSubNet( aNewSubNet );
+        if( aNetCode < 0 || pad->GetNetCode() == aNetCode )
+            items.push_back( pad );
     }
 
-    return change_count;
-}
-
-/*
- * Change a subnet value to a new value, for tracks and pads which are connected to.
- * The result is merging 2 clusters (or subnets) into only one cluster.
- * Note: the resulting sub net value is the smallest between aOldSubNet et aNewSubNet
- */
-int CONNECTIONS::Merge_SubNets( int aOldSubNet, int aNewSubNet )
-{
-    TRACK* curr_track;
-    int    change_count = 0;
-
-    if( aOldSubNet == aNewSubNet )
-        return 0;
-
-    if( (aOldSubNet > 0) && (aOldSubNet < aNewSubNet) )
-        std::swap( aOldSubNet, aNewSubNet );
-
-    curr_track = (TRACK*)m_firstTrack;
-
-    for( ; curr_track != NULL; curr_track = curr_track->Next() )
+    for( TRACK* track = aPcb->m_Track; track; track = track->Next() )
     {
-        if( curr_track->GetSubNet() != aOldSubNet )
-        {
-            if( curr_track == m_lastTrack )
-                break;
-
-            continue;
-        }
-
-        change_count++;
-        curr_track->SetSubNet( aNewSubNet );
-
-        for( unsigned ii = 0; ii < curr_track->m_PadsConnected.size(); ii++ )
-        {
-            D_PAD * pad = curr_track->m_PadsConnected[ii];
-            if( pad->GetSubNet() == aOldSubNet )
-            {
-                pad->SetSubNet( curr_track->GetSubNet() );
-            }
-        }
-
-        if( curr_track == m_lastTrack )
-            break;
+        if( aNetCode < 0 || track->GetNetCode() == aNetCode )
+            items.push_back( track );
     }
 
-    return change_count;
-}
+    // Count the items of each group, identified by the net code and the ratsnest tag
+    typedef std::map< std::pair<int, int>, int > SUBNET_MAP;
+    SUBNET_MAP subnets;
+    std::vector< std::pair<int, int> > keys( items.size() );
 
+    for( unsigned i = 0; i < items.size(); ++i )
+    {
+        keys[i] = std::make_pair( items[i]->GetNetCode(), ratsnest->GetCluster( items[i] ) );
 
-/* Test a list of track segments, to create or propagate a sub netcode to pads and
- * segments connected together.
- * The track list must be sorted by nets, and all segments
- * from m_firstTrack to m_lastTrack have the same net
- * When 2 items are connected (a track to a pad, or a track to an other track),
- * they are grouped in a cluster.
- * The .m_Subnet member is the cluster identifier (subnet id)
- * For a given net, if all tracks are created, there is only one cluster.
- * but if not all tracks are created, there are more than one cluster,
- * and some ratsnests will be left active.
- * A ratsnest is active when it "connect" 2 items having different subnet id
- */
-void CONNECTIONS::Propagate_SubNets()
-{
-    int sub_netcode = 1;
+        if( keys[i].second >= 0 )
+            subnets[keys[i]]++;
+    }
 
-    TRACK* curr_track = (TRACK*)m_firstTrack;
-    if( curr_track )
-        curr_track->SetSubNet( sub_netcode );
+    // Then replace the counts by the subnet of the groups
+    int netcode = -1;
+    int subnet = 0;
 
-    // Examine connections between tracks and pads
-    for( ; curr_track != NULL; curr_track = curr_track->Next() )
+    for( SUBNET_MAP::iterator it = subnets.begin(); it != subnets.end(); ++it )
     {
-        // First: handling connections to pads
-        for( unsigned ii = 0; ii < curr_track->m_PadsConnected.size(); ii++ )
-        {
-            D_PAD * pad = curr_track->m_PadsConnected[ii];
-
-            if( curr_track->GetSubNet() )        // the track segment is already a cluster member
-            {
-                if( pad->GetSubNet() > 0 )
-                {
-                    // The pad is already a cluster member, so we can merge the 2 clusters
-                    Merge_SubNets( pad->GetSubNet(), curr_track->GetSubNet() );
-                }
-                else
-                {
-                    /* The pad is not yet attached to a cluster , so we can add this pad to
-                     * the cluster */
-                    pad->SetSubNet( curr_track->GetSubNet() );
-                }
-            }
-            else                              // the track segment is not attached to a cluster
-            {
-                if( pad->GetSubNet() > 0 )
-                {
-                    // it is connected to a pad in a cluster, merge this track
-                    curr_track->SetSubNet( pad->GetSubNet() );
-                }
-                else
-                {
-                    /* it is connected to a pad not in a cluster, so we must create a new
-                     * cluster (only with the 2 items: the track and the pad) */
-                    sub_netcode++;
-                    curr_track->SetSubNet( sub_netcode );
-                    pad->SetSubNet( curr_track->GetSubNet() );
-                }
-            }
-        }
-
-        // Test connections between segments
-        for( unsigned ii = 0; ii < curr_track->m_TracksConnected.size(); ii++ )
+        if( it->first.first != netcode )
         {
-            BOARD_CONNECTED_ITEM* track = curr_track->m_TracksConnected[ii];
-
-            if( curr_track->GetSubNet() )   // The current track is already a cluster member
-            {
-                // The other track is already a cluster member, so we can merge the 2 clusters
-                if( track->GetSubNet() )
-                {
-                    Merge_SubNets( track->GetSubNet(), curr_track->GetSubNet() );
-                }
-                else
-                {
-                    // The other track is not yet attached to a cluster , so we can add this
-                    // other track to the cluster
-                    track->SetSubNet( curr_track->GetSubNet() );
-                }
-            }
-            else        // the current track segment is not yet attached to a cluster
-            {
-                if( track->GetSubNet() )
-                {
-                    // The other track is already a cluster member, so we can add
-                    // the current segment to the cluster
-                    curr_track->SetSubNet( track->GetSubNet() );
-                }
-                else
-                {
-                    // it is connected to an other segment not in a cluster, so we must
-                    // create a new cluster (only with the 2 track segments)
-                    sub_netcode++;
-                    curr_track->SetSubNet( sub_netcode );
-                    track->SetSubNet( curr_track->GetSubNet() );
-                }
-            }
+            netcode = it->first.first;
+            subnet = 0;
         }
 
-        if( curr_track == m_lastTrack )
-            break;
+        it->second = it->second > 1 ? ++subnet : 0;
     }
 
-    // Examine connections between intersecting pads, and propagate
-    // sub_netcodes to intersecting pads
-    for( unsigned ii = 0; ii < m_sortedPads.size(); ii++ )
+    for( unsigned i = 0; i < items.size(); ++i )
     {
-        D_PAD* curr_pad = m_sortedPads[ii];
-
-        for( unsigned jj = 0; jj < curr_pad->m_PadsConnected.size(); jj++ )
-        {
-            D_PAD* pad = curr_pad->m_PadsConnected[jj];
-
-            if( curr_pad->GetSubNet() )   // the current pad is already attached to a cluster
-            {
-                if( pad->GetSubNet() > 0 )
-                {
-                    // The pad is already a cluster member, so we can merge the 2 clusters
-                    // Store the initial subnets, which will be modified by Merge_PadsSubNets
-                    int subnet1 = pad->GetSubNet();
-                    int subnet2 = curr_pad->GetSubNet();
-
-                    // merge subnets of pads only, even those not connected by tracks
-                    Merge_PadsSubNets( subnet1, subnet2 );
-
-                    // merge subnets of tracks (and pads, which are already merged)
-                    Merge_SubNets( subnet1, subnet2 );
-                }
-                else
-                {
-                    // The pad is not yet attached to a cluster,
-                    // so we can add this pad to the cluster
-                    pad->SetSubNet( curr_pad->GetSubNet() );
-                }
-            }
-            else   // the current pad is not attached to a cluster
-            {
-                if( pad->GetSubNet() > 0 )
-                {
-                    // the connected pad is in a cluster,
-                    // so we can add the current pad to the cluster
-                    curr_pad->SetSubNet( pad->GetSubNet() );
-                }
-                else
-                {
-                    // the connected pad is not in a cluster,
-                    // so we must create a new cluster, with the 2 pads.
-                    sub_netcode++;
-                    curr_pad->SetSubNet( sub_netcode );
-                    pad->SetSubNet( curr_pad->GetSubNet() );
-                }
-            }
-        }
+        items[i]->SetZoneSubNet( 0 );
+        items[i]->SetSubNet( keys[i].second >= 0 ? subnets[keys[i]] : 0 );
     }
 }
 
+
 /*
  * Test all connections of the board,
  * and update subnet variable of pads and tracks
@@ -729,54 +467,13 @@ void CONNECTIONS::Propagate_SubNets()
  */
 void PCB_BASE_FRAME::TestConnections()
 {
-    // Clear the cluster identifier for all pads
-    for( unsigned i = 0;  i< m_Pcb->GetPadCount();  ++i )
-    {
-        D_PAD* pad = m_Pcb->GetPad(i);
-
-        pad->SetZoneSubNet( 0 );
-        pad->SetSubNet( 0 );
-    }
-
-    m_Pcb->Test_Connections_To_Copper_Areas();
-
-    // Test existing connections net by net
-    // note some nets can have no tracks, and pads intersecting
-    // so Build_CurrNet_SubNets_Connections must be called for each net
-    CONNECTIONS connections( m_Pcb );
-
-    int last_net_tested = 0;
-    int current_net_code = 0;
-
-    for( TRACK* track = m_Pcb->m_Track; track; )
-    {
-        // At this point, track is the first track of a given net
-        current_net_code = track->GetNetCode();
-
-        // Get last track of the current net
-        TRACK* lastTrack = track->GetEndNetCode( current_net_code );
-
-        if( current_net_code > 0 )  // do not spend time if net code = 0 ( dummy net )
-        {
-            // Test all previous nets having no tracks
-            for( int net = last_net_tested+1; net < current_net_code; net++ )
-                connections.Build_CurrNet_SubNets_Connections( NULL, NULL, net );
+    // The connections made by tracks, vias, zones and intersecting pads are found by
+    // the board ratsnest, so the legacy ratsnest, the DRC and the GAL ratsnest agree.
+    // Legacy tools can modify items without updating it, so the nets whose items
+    // have changed are built again.
+    m_Pcb->GetRatsnest()->ProcessChangedNets();
 
-            connections.Build_CurrNet_SubNets_Connections( track, lastTrack, current_net_code );
-            last_net_tested = current_net_code;
-        }
-
-        track = lastTrack->Next();    // this is now the first track of the next net
-    }
-
-    // Test last nets without tracks, if any
-    int netsCount = m_Pcb->GetNetCount();
-    for( int net = last_net_tested+1; net < netsCount; net++ )
-        connections.Build_CurrNet_SubNets_Connections( NULL, NULL, net );
-
-    Merge_SubNets_Connected_By_CopperAreas( m_Pcb );
-
-    return;
+    setSubNetsFromRatsnest( m_Pcb, -1 );
 }
 
 
@@ -789,36 +486,9 @@ void PCB_BASE_FRAME::TestNetConnection( wxDC* aDC, int aNetCode )
     if( (m_Pcb->m_Status_Pcb & LISTE_RATSNEST_ITEM_OK) == 0 )
         Compile_Ratsnest( aDC, true );
 
-    // Clear the cluster identifier (subnet) of pads for this net
-    // Pads are grouped by netcode (and in netname alphabetic order)
-    for( unsigned i = 0; i < m_Pcb->GetPadCount(); ++i )
-    {
-        D_PAD* pad = m_Pcb->GetPad(i);
-
-        if( m_Pcb->GetPad(i)->GetNetCode() == aNetCode )
-            pad->SetSubNet( 0 );
-    }
-
-    m_Pcb->Test_Connections_To_Copper_Areas( aNetCode );
-
-    // Search for the first and the last segment relative to the given net code
-    if( m_Pcb->m_Track )
-    {
-        CONNECTIONS connections( m_Pcb );
-
-        TRACK* lastTrack = NULL;
-        TRACK* firstTrack = m_Pcb->m_Track.GetFirst()->GetStartNetCode( aNetCode );
-
-        if( firstTrack )
-            lastTrack = firstTrack->GetEndNetCode( aNetCode );
-
-        if( firstTrack && lastTrack ) // i.e. if there are segments
-        {
-            connections.Build_CurrNet_SubNets_Connections( firstTrack, lastTrack, aNetCode );
-        }
-    }
-
-    Merge_SubNets_Connected_By_CopperAreas( m_Pcb, aNetCode );
+    // Update the pads and tracks subnets of this net
+    m_Pcb->GetRatsnest()->ProcessNet( aNetCode );
+    setSubNetsFromRatsnest( m_Pcb, aNetCode );
 
     // rebuild the active ratsnest for this net
     DrawGeneralRatsnest( aDC, aNetCode );
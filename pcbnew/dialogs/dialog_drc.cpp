@@ -159,6 +159,28 @@ void DIALOG_DRC_CONTROL::OnStartdrcClick( wxCommandEvent& event )
 }
 
 
+void DIALOG_DRC_CONTROL::OnUpdatedrcClick( wxCommandEvent& event )
+{
+    SetDrcParmeters();
+
+    // Markers of the items far from the changes are kept, so the lists are not cleared
+    m_Parent->SetCurItem( NULL );           // clear curr item, because it could be a DRC marker
+    m_DeleteCurrentMarkerButton->Enable( false );
+
+    wxBeginBusyCursor();
+
+    m_Messages->Clear();
+    wxSafeYield();                          // Allows time slice to refresh the m_Messages window
+    m_tester->RunIncrementalTests( m_Messages );
+
+    m_Notebook->ChangeSelection( 0 );       // display the 1at tab "...Markers ..."
+
+    wxEndBusyCursor();
+
+    RedrawDrawPanel();
+}
+
+
 void DIALOG_DRC_CONTROL::OnDeleteAllClick( wxCommandEvent& event )
 {
     DelDRCMarkers();
@@ -516,6 +538,9 @@ void DIALOG_DRC_CONTROL::DelDRCMarkers()
     m_ClearanceListBox->DeleteAllItems();
     m_UnconnectedListBox->DeleteAllItems();
     m_DeleteCurrentMarkerButton->Enable( false );
+
+    // The markers of the last test are deleted
+    m_tester->ClearIncrementalState();
 }
 
 
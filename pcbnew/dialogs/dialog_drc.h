@@ -82,6 +82,9 @@ private:
     /// wxEVT_COMMAND_BUTTON_CLICKED event handler for ID_STARTDRC
     void OnStartdrcClick( wxCommandEvent& event );
 
+    /// wxEVT_COMMAND_BUTTON_CLICKED event handler for m_buttonUpdateDRC
+    void OnUpdatedrcClick( wxCommandEvent& event );
+
     /// wxEVT_COMMAND_BUTTON_CLICKED event handler for ID_LIST_UNCONNECTED
     void OnListUnconnectedClick( wxCommandEvent& event );
 
@@ -61,6 +61,7 @@ class DIALOG_DRC_CONTROL_BASE : public DIALOG_SHIM
 		wxStaticText* m_staticText6;
 		wxTextCtrl* m_Messages;
 		wxButton* m_buttonRunDRC;
+		wxButton* m_buttonUpdateDRC;
 		wxButton* m_buttonListUnconnected;
 		wxButton* m_DeleteAllButton;
 		wxButton* m_DeleteCurrentMarkerButton;
@@ -76,6 +77,7 @@ class DIALOG_DRC_CONTROL_BASE : public DIALOG_SHIM
 		virtual void OnReportCheckBoxClicked( wxCommandEvent& event ) { event.Skip(); }
 		virtual void OnButtonBrowseRptFileClick( wxCommandEvent& event ) { event.Skip(); }
 		virtual void OnStartdrcClick( wxCommandEvent& event ) { event.Skip(); }
+		virtual void OnUpdatedrcClick( wxCommandEvent& event ) { event.Skip(); }
 		virtual void OnListUnconnectedClick( wxCommandEvent& event ) { event.Skip(); }
 		virtual void OnDeleteAllClick( wxCommandEvent& event ) { event.Skip(); }
 		virtual void OnDeleteOneClick( wxCommandEvent& event ) { event.Skip(); }
@@ -42,11 +42,15 @@
 #include <class_draw_panel_gal.h>
 #include <view/view.h>
 #include <geometry/seg.h>
+#include <ratsnest_data.h>
+#include <profile.h>
 
 #include <tool/tool_manager.h>
 #include <tools/common_actions.h>
 
 #include <pcbnew.h>
+#include <zones.h>
+#include <zone_obstacles_index.h>
 #include <drc_stuff.h>
 
 #include <dialog_drc.h>
@@ -101,6 +105,22 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
 {
     m_mainWindow = aPcbWindow;
     m_pcb = aPcbWindow->GetBoard();
+
+    init();
+}
+
+
+DRC::DRC( BOARD* aBoard )
+{
+    m_mainWindow = NULL;
+    m_pcb = aBoard;
+
+    init();
+}
+
+
+void DRC::init()
+{
     m_ui  = 0;
 
     // establish initial values for everything:
@@ -116,6 +136,8 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
     // m_rptFilename set to empty by its constructor
 
     m_currentMarker = NULL;
+    m_itemsIndex = NULL;
+    m_snapshotValid = false;
 
     m_segmAngle  = 0;
     m_segmLength = 0;
@@ -177,7 +199,8 @@ int DRC::Drc( ZONE_CONTAINER* aArea, int aCornerIndex )
 void DRC::RunTests( wxTextCtrl* aMessages )
 {
     // Ensure ratsnest is up to date:
-    if( (m_pcb->m_Status_Pcb & LISTE_RATSNEST_ITEM_OK) == 0 )
+    // (without a frame, testUnconnected() uses the board connectivity data instead)
+    if( m_mainWindow && (m_pcb->m_Status_Pcb & LISTE_RATSNEST_ITEM_OK) == 0 )
     {
         if( aMessages )
         {
@@ -190,6 +213,10 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 
     // someone should have cleared the two lists before calling this.
 
+    // This is a full test: forget the state of the previous incremental test
+    ClearIncrementalState();
+    m_phaseTimes.clear();
+
     if( !testNetClasses() )
     {
         // testing the netclasses is a special case because if the netclasses
@@ -205,6 +232,8 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         return;
     }
 
+    prof_counter phase;
+
     // test pad to pad clearances, nothing to do with tracks, vias or zones.
     if( m_doPad2PadTest )
     {
@@ -214,7 +243,9 @@ void DRC::RunTests( wxTextCtrl* aMessages )
             wxSafeYield();
         }
 
+        prof_start( &phase );
         testPad2Pad();
+        addPhaseTime( wxT( "pad2pad" ), phase );
     }
 
     // test track and via clearances to other tracks, pads, and vias
@@ -224,7 +255,9 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
-    testTracks( aMessages ? aMessages->GetParent() : m_mainWindow, true );
+    prof_start( &phase );
+    testTracks( aMessages ? aMessages->GetParent() : m_mainWindow, m_mainWindow != NULL );
+    addPhaseTime( wxT( "tracks" ), phase );
 
     // Before testing segments and unconnected, refill all zones:
     // this is a good caution, because filled areas can be outdated.
@@ -234,8 +267,9 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
-    m_mainWindow->Fill_All_Zones( aMessages ? aMessages->GetParent() : m_mainWindow,
-                                  false );
+    prof_start( &phase );
+    fillAllZones( aMessages ? aMessages->GetParent() : m_mainWindow );
+    addPhaseTime( wxT( "zone fill" ), phase );
 
     // test zone clearances to other zones
     if( aMessages )
@@ -244,7 +278,9 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
+    prof_start( &phase );
     testZones();
+    addPhaseTime( wxT( "zones" ), phase );
 
     // find and gather unconnected pads.
     if( m_doUnconnectedTest )
@@ -255,7 +291,9 @@ void DRC::RunTests( wxTextCtrl* aMessages )
             aMessages->Refresh();
         }
 
+        prof_start( &phase );
         testUnconnected();
+        addPhaseTime( wxT( "unconnected" ), phase );
     }
 
     // find and gather vias, tracks, pads inside keepout areas.
@@ -267,7 +305,9 @@ void DRC::RunTests( wxTextCtrl* aMessages )
             aMessages->Refresh();
         }
 
+        prof_start( &phase );
         testKeepoutAreas();
+        addPhaseTime( wxT( "keepout" ), phase );
     }
 
     // find and gather vias, tracks, pads inside text boxes.
@@ -277,7 +317,13 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
+    prof_start( &phase );
     testTexts();
+    addPhaseTime( wxT( "texts" ), phase );
+
+    // Remember the board state, for the next incremental test
+    takeSnapshot( m_snapshot );
+    m_snapshotValid = true;
 
     // update the m_ui listboxes
     updatePointers();
@@ -291,6 +337,58 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 }
 
 
+void DRC::addPhaseTime( const wxString& aPhase, prof_counter& aCounter )
+{
+    prof_end( &aCounter );
+    m_phaseTimes.push_back( DRC_PHASE_TIME( aPhase, aCounter.msecs() ) );
+}
+
+
+void DRC::fillAllZones( wxWindow* aActiveWindow )
+{
+    if( m_mainWindow )
+    {
+        m_mainWindow->Fill_All_Zones( aActiveWindow, false );
+        return;
+    }
+
+    // Same as PCB_EDIT_FRAME::Fill_All_Zones(), without the progress dialog,
+    // the view and the legacy ratsnest
+    m_pcb->m_Zone.DeleteAll();
+
+    std::vector<ZONE_CONTAINER*> zones;
+
+    for( int ii = 0; ii < m_pcb->GetAreaCount(); ii++ )
+    {
+        ZONE_CONTAINER* zone = m_pcb->GetArea( ii );
+
+        if( !zone->GetIsKeepout() )
+            zones.push_back( zone );
+    }
+
+    FillZones( m_pcb, zones );
+}
+
+
+void DRC::fillZonesInAreas( const std::vector<EDA_RECT>& aDirtyAreas )
+{
+    if( m_mainWindow )
+    {
+        m_mainWindow->Fill_Zones_In_Areas( aDirtyAreas );
+        return;
+    }
+
+    ZONE_OBSTACLES_INDEX obstacles;
+    obstacles.Build( m_pcb );
+
+    std::vector<ZONE_CONTAINER*> zones;
+    FindZonesToRefill( m_pcb, aDirtyAreas, obstacles, zones );
+
+    if( !zones.empty() )
+        FillZones( m_pcb, zones, &obstacles );
+}
+
+
 void DRC::ListUnconnectedPads()
 {
     testUnconnected();
@@ -303,7 +401,9 @@ void DRC::ListUnconnectedPads()
 void DRC::updatePointers()
 {
     // update my pointers, m_mainWindow is the only unchangeable one
-    m_pcb = m_mainWindow->GetBoard();
+    // (without a frame, the board given to the constructor is used)
+    if( m_mainWindow )
+        m_pcb = m_mainWindow->GetBoard();
 
     if( m_ui )  // Use diag list boxes only in DRC dialog
     {
@@ -331,8 +431,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_CLEARANCE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -347,8 +446,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_TRACKWIDTH, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -362,8 +460,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_VIASIZE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -377,8 +474,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_VIADRILLSIZE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -392,8 +488,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_uVIASIZE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -407,8 +502,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_uVIADRILLSIZE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -454,6 +548,7 @@ void DRC::testPad2Pad()
         D_PAD* pad = sortedPads[i];
 
         // GetBoundingRadius() is the radius of the minimum sized circle fully containing the pad
+        // (this also computes the cached value before the pads are shared between threads)
         int radius = pad->GetBoundingRadius();
         if( radius > max_size )
             max_size = radius;
@@ -462,21 +557,38 @@ void DRC::testPad2Pad()
     // Test the pads
     D_PAD** listEnd = &sortedPads[ sortedPads.size() ];
 
-    for( unsigned i = 0; i< sortedPads.size(); ++i )
-    {
-        D_PAD* pad = sortedPads[i];
+    // One slot per reference pad, to add the markers in the pad order
+    std::vector<MARKER_PCB*> markers( sortedPads.size(), (MARKER_PCB*) NULL );
+    int padCount = sortedPads.size();
+    int i;
 
-        int    x_limit = max_size + pad->GetClearance() +
-                         pad->GetBoundingRadius() + pad->GetPosition().x;
+#ifdef USE_OPENMP
+    #pragma omp parallel private(i)
+#endif
+    {
+        DRC worker( m_pcb );
+        worker.initWorker( *this );
 
-        if( !doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit ) )
+#ifdef USE_OPENMP
+        #pragma omp for schedule(dynamic, 16)
+#endif
+        for( i = 0; i < padCount; ++i )
         {
-            wxASSERT( m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-            m_currentMarker = 0;
+            D_PAD* pad = sortedPads[i];
+
+            int    x_limit = max_size + pad->GetClearance() +
+                             pad->GetBoundingRadius() + pad->GetPosition().x;
+
+            if( !worker.doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit ) )
+            {
+                wxASSERT( worker.m_currentMarker );
+                markers[i] = worker.m_currentMarker;
+                worker.m_currentMarker = 0;
+            }
         }
-    }
+    }   /* end of parallel section */
+
+    addMarkers( std::vector<BOARD_ITEM*>( sortedPads.begin(), sortedPads.end() ), markers );
 }
 
 
@@ -485,10 +597,14 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
     wxProgressDialog * progressDialog = NULL;
     const int delta = 500;  // This is the number of tests between 2 calls to the
                             // progress bar
-    int count = 0;
+
+    // Each segment is tested against the segments following it in the list
+    std::vector<TRACK*> refSegments;
+
     for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
-        count++;
+        refSegments.push_back( segm );
 
+    int count = refSegments.size();
     int deltamax = count/delta;
 
     if( aShowProgressBar && deltamax > 3 )
@@ -500,44 +616,126 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
         progressDialog->Update( 0, wxEmptyString );
     }
 
-    int ii = 0;
+    // Build the broadphase once: each segment is then tested only against
+    // the pads and tracks which are close to it.
+    DRC_ITEMS_INDEX itemsIndex;
+    itemsIndex.Build( m_pcb );
+    m_itemsIndex = &itemsIndex;
+
+    // One slot per reference segment.  Markers are added in the segment order,
+    // whatever the thread which found them, so the result is the same as a
+    // single threaded run.
+    std::vector<MARKER_PCB*> markers( refSegments.size(), (MARKER_PCB*) NULL );
+
     count = 0;
 
-    for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
+    // The segments are tested by blocks of delta segments, and the progress bar
+    // is updated (from this thread) between two blocks
+    for( int first = 0; first < (int) refSegments.size(); first += delta )
     {
-        if ( ii++ > delta )
-        {
-            ii = 0;
-            count++;
+        int last = std::min( first + delta, (int) refSegments.size() );
 
-            if( progressDialog )
-            {
-                if( !progressDialog->Update( count, wxEmptyString ) )
-                    break;  // Aborted by user
+        testTracksRange( refSegments, first, last, markers );
+
+        count++;
+
+        if( progressDialog )
+        {
+            if( !progressDialog->Update( std::min( count, deltamax ), wxEmptyString ) )
+                break;  // Aborted by user
 #ifdef __WXMAC__
-                // Work around a dialog z-order issue on OS X
-                if( count == deltamax )
-                    aActiveWindow->Raise();
+            // Work around a dialog z-order issue on OS X
+            if( count == deltamax )
+                aActiveWindow->Raise();
 #endif
-            }
         }
+    }
+
+    // The index is a snapshot of the board, do not keep it for the online DRC
+    m_itemsIndex = NULL;
+
+    addMarkers( std::vector<BOARD_ITEM*>( refSegments.begin(), refSegments.end() ), markers );
+
+    if( progressDialog )
+        progressDialog->Destroy();
+}
 
-        if( !doTrackDrc( segm, segm->Next(), true ) )
+
+void DRC::testTracksRange( const std::vector<TRACK*>& aSegments, int aFirst, int aLast,
+                           std::vector<MARKER_PCB*>& aMarkers )
+{
+    int i;
+
+#ifdef USE_OPENMP
+    #pragma omp parallel private(i)
+#endif
+    {
+        DRC worker( m_pcb );
+        worker.initWorker( *this );
+
+#ifdef USE_OPENMP
+        #pragma omp for schedule(dynamic, 16)
+#endif
+        for( i = aFirst; i < aLast; ++i )
         {
-            wxASSERT( m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-            m_currentMarker = 0;
+            TRACK* segm = aSegments[i];
+
+            if( !worker.doTrackDrc( segm, segm->Next(), true ) )
+            {
+                wxASSERT( worker.m_currentMarker );
+                aMarkers[i] = worker.m_currentMarker;
+                worker.m_currentMarker = 0;
+            }
         }
+    }   /* end of parallel section */
+}
+
+
+void DRC::initWorker( const DRC& aParent )
+{
+    m_pcb           = aParent.m_pcb;
+    m_itemsIndex    = aParent.m_itemsIndex;
+    m_currentMarker = NULL;
+}
+
+
+void DRC::addMarkers( const std::vector<BOARD_ITEM*>& aRefItems,
+                      std::vector<MARKER_PCB*>& aMarkers )
+{
+    for( unsigned ii = 0; ii < aMarkers.size(); ++ii )
+    {
+        if( aMarkers[ii] )
+            addMarkerToPcb( aRefItems[ii], aMarkers[ii] );
     }
 
-    if( progressDialog )
-        progressDialog->Destroy();
+    aMarkers.clear();
+}
+
+
+void DRC::addMarkerToPcb( const BOARD_ITEM* aRefItem, MARKER_PCB* aMarker )
+{
+    addMarkerToPcb( aMarker );
+    m_itemMarkers.insert( std::make_pair( aRefItem, aMarker ) );
+}
+
+
+void DRC::addMarkerToPcb( MARKER_PCB* aMarker )
+{
+    m_pcb->Add( aMarker );
+
+    if( m_mainWindow )
+        m_mainWindow->GetGalCanvas()->GetView()->Add( aMarker );
 }
 
 
 void DRC::testUnconnected()
 {
+    if( !m_mainWindow )
+    {
+        testUnconnectedRatsnest();
+        return;
+    }
+
     if( (m_pcb->m_Status_Pcb & LISTE_RATSNEST_ITEM_OK) == 0 )
     {
         wxClientDC dc( m_mainWindow->GetCanvas() );
@@ -571,6 +769,43 @@ void DRC::testUnconnected()
 }
 
 
+void DRC::testUnconnectedRatsnest()
+{
+    // The legacy ratsnest is built by the frame, so use the connectivity data of the board
+    RN_DATA* ratsnest = m_pcb->GetRatsnest();
+
+    ratsnest->ProcessBoard();
+    ratsnest->Recalculate();
+
+    wxString msg;
+
+    for( int netcode = 1; netcode < ratsnest->GetNetCount(); ++netcode )
+    {
+        const std::vector<RN_EDGE_MST_PTR>* edges = ratsnest->GetNet( netcode ).GetUnconnected();
+
+        if( edges == NULL )
+            continue;
+
+        NETINFO_ITEM* net = m_pcb->FindNet( netcode );
+
+        for( unsigned ii = 0; ii < edges->size(); ++ii )
+        {
+            const RN_NODE_PTR& source = (*edges)[ii]->GetSourceNode();
+            const RN_NODE_PTR& target = (*edges)[ii]->GetTargetNode();
+
+            wxPoint start( source->GetX(), source->GetY() );
+            wxPoint end( target->GetX(), target->GetY() );
+
+            msg = wxT( "net " ) + ( net ? net->GetNetname() : wxString() );
+
+            DRC_ITEM* uncItem = new DRC_ITEM( DRCE_UNCONNECTED_PADS, msg, msg, start, end );
+
+            m_unconnected.push_back( uncItem );
+        }
+    }
+}
+
+
 void DRC::testZones()
 {
     // Test copper areas for valid netcodes
@@ -600,8 +835,7 @@ void DRC::testZones()
         {
             m_currentMarker = fillMarker( test_area,
                                           DRCE_SUSPICIOUS_NET_FOR_ZONE_OUTLINE, m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+            addMarkerToPcb( m_currentMarker );
             m_currentMarker = NULL;
         }
     }
@@ -623,40 +857,10 @@ void DRC::testKeepoutAreas()
 
         for( TRACK* segm = m_pcb->m_Track; segm != NULL; segm = segm->Next() )
         {
-            if( segm->Type() == PCB_TRACE_T )
+            if( !doKeepoutDrc( area, segm ) )
             {
-                if( ! area->GetDoNotAllowTracks()  )
-                    continue;
-
-                if( segm->GetLayer() != area->GetLayer() )
-                    continue;
-
-                if( area->Outline()->Distance( segm->GetStart(), segm->GetEnd(),
-                                               segm->GetWidth() ) == 0 )
-                {
-                    m_currentMarker = fillMarker( segm, NULL,
-                                                  DRCE_TRACK_INSIDE_KEEPOUT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-                    m_currentMarker = 0;
-                }
-            }
-            else if( segm->Type() == PCB_VIA_T )
-            {
-                if( ! area->GetDoNotAllowVias()  )
-                    continue;
-
-                if( ! ((VIA*)segm)->IsOnLayer( area->GetLayer() ) )
-                    continue;
-
-                if( area->Outline()->Distance( segm->GetPosition() ) < segm->GetWidth()/2 )
-                {
-                    m_currentMarker = fillMarker( segm, NULL,
-                                                  DRCE_VIA_INSIDE_KEEPOUT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-                    m_currentMarker = 0;
-                }
+                addMarkerToPcb( segm, m_currentMarker );
+                m_currentMarker = 0;
             }
         }
         // Test pads: TODO
@@ -714,8 +918,7 @@ void DRC::testTexts()
                         m_currentMarker = fillMarker( track, text,
                                                       DRCE_TRACK_INSIDE_TEXT,
                                                       m_currentMarker );
-                        m_pcb->Add( m_currentMarker );
-                        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                        addMarkerToPcb( m_currentMarker );
                         m_currentMarker = NULL;
                         break;
                     }
@@ -733,8 +936,7 @@ void DRC::testTexts()
                     {
                         m_currentMarker = fillMarker( track, text,
                                                       DRCE_VIA_INSIDE_TEXT, m_currentMarker );
-                        m_pcb->Add( m_currentMarker );
-                        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                        addMarkerToPcb( m_currentMarker );
                         m_currentMarker = NULL;
                         break;
                     }
@@ -783,8 +985,7 @@ void DRC::testTexts()
                 {
                     m_currentMarker = fillMarker( pad, text,
                                                   DRCE_PAD_INSIDE_TEXT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                    addMarkerToPcb( m_currentMarker );
                     m_currentMarker = NULL;
                     break;
                 }
@@ -804,36 +1005,45 @@ bool DRC::doTrackKeepoutDrc( TRACK* aRefSeg )
         if( !area->GetIsKeepout() )
             continue;
 
-        if( aRefSeg->Type() == PCB_TRACE_T )
-        {
-            if( ! area->GetDoNotAllowTracks()  )
-                continue;
+        if( !doKeepoutDrc( area, aRefSeg ) )
+            return false;
+    }
 
-            if( aRefSeg->GetLayer() != area->GetLayer() )
-                continue;
+    return true;
+}
 
-            if( area->Outline()->Distance( aRefSeg->GetStart(), aRefSeg->GetEnd(),
-                                           aRefSeg->GetWidth() ) == 0 )
-            {
-                m_currentMarker = fillMarker( aRefSeg, NULL,
-                                              DRCE_TRACK_INSIDE_KEEPOUT, m_currentMarker );
-                return false;
-            }
-        }
-        else if( aRefSeg->Type() == PCB_VIA_T )
+
+bool DRC::doKeepoutDrc( ZONE_CONTAINER* aArea, TRACK* aRefSeg )
+{
+    if( aRefSeg->Type() == PCB_TRACE_T )
+    {
+        if( ! aArea->GetDoNotAllowTracks()  )
+            return true;
+
+        if( aRefSeg->GetLayer() != aArea->GetLayer() )
+            return true;
+
+        if( aArea->Outline()->Distance( aRefSeg->GetStart(), aRefSeg->GetEnd(),
+                                        aRefSeg->GetWidth() ) == 0 )
         {
-            if( ! area->GetDoNotAllowVias()  )
-                continue;
+            m_currentMarker = fillMarker( aRefSeg, NULL,
+                                          DRCE_TRACK_INSIDE_KEEPOUT, m_currentMarker );
+            return false;
+        }
+    }
+    else if( aRefSeg->Type() == PCB_VIA_T )
+    {
+        if( ! aArea->GetDoNotAllowVias()  )
+            return true;
 
-            if( ! ((VIA*)aRefSeg)->IsOnLayer( area->GetLayer() ) )
-                continue;
+        if( ! ((VIA*)aRefSeg)->IsOnLayer( aArea->GetLayer() ) )
+            return true;
 
-            if( area->Outline()->Distance( aRefSeg->GetPosition() ) < aRefSeg->GetWidth()/2 )
-            {
-                m_currentMarker = fillMarker( aRefSeg, NULL,
-                                              DRCE_VIA_INSIDE_KEEPOUT, m_currentMarker );
-                return false;
-            }
+        if( aArea->Outline()->Distance( aRefSeg->GetPosition() ) < aRefSeg->GetWidth()/2 )
+        {
+            m_currentMarker = fillMarker( aRefSeg, NULL,
+                                          DRCE_VIA_INSIDE_KEEPOUT, m_currentMarker );
+            return false;
         }
     }
 
@@ -272,11 +272,16 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     // Compute the min distance to pads
     if( testPads )
     {
-        unsigned pad_count = m_pcb->GetPadCount();
+        // When the broadphase index is available, only the pads near the reference
+        // segment are tested.  They come in the same order as the full pad list.
+        if( m_itemsIndex )
+            m_itemsIndex->QueryPads( aRefSeg, m_padCandidates, m_foundOrdinals );
+        else
+            m_padCandidates = m_pcb->GetPads();
 
-        for( unsigned ii = 0;  ii<pad_count;  ++ii )
+        for( unsigned ii = 0;  ii < m_padCandidates.size();  ++ii )
         {
-            D_PAD* pad = m_pcb->GetPad( ii );
+            D_PAD* pad = m_padCandidates[ii];
 
             /* No problem if pads are on an other layer,
              * But if a drill hole exists	(a pad on a single layer can have a hole!)
@@ -338,8 +343,23 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     // Test the reference segment with other track segments
     wxPoint segStartPoint;
     wxPoint segEndPoint;
-    for( track = aStart; track; track = track->Next() )
+
+    m_trackCandidates.clear();
+
+    if( m_itemsIndex )
+    {
+        m_itemsIndex->QueryTracks( aRefSeg, aStart, m_trackCandidates, m_foundOrdinals );
+    }
+    else
     {
+        for( track = aStart; track; track = track->Next() )
+            m_trackCandidates.push_back( track );
+    }
+
+    for( unsigned ii = 0; ii < m_trackCandidates.size(); ++ii )
+    {
+        track = m_trackCandidates[ii];
+
         // No problem if segments have the same net code:
         if( net_code_ref == track->GetNetCode() )
             continue;
@@ -0,0 +1,442 @@
+/**
+ * @file drc_incremental.cpp
+ * @brief Incremental DRC: re-test only the items near the board changes.
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <fctsys.h>
+#include <wxPcbStruct.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_pad.h>
+#include <class_zone.h>
+#include <class_drawsegment.h>
+#include <class_marker_pcb.h>
+#include <class_draw_panel_gal.h>
+#include <view/view.h>
+
+#include <pcbnew.h>
+#include <drc_stuff.h>
+
+#include <boost/functional/hash.hpp>
+
+
+static DRC_ITEM_SNAPSHOT padSnapshot( const D_PAD* aPad )
+{
+    DRC_ITEM_SNAPSHOT snapshot;
+
+    snapshot.m_BBox        = DRC_ITEMS_INDEX::PadBoundingBox( aPad );
+    snapshot.m_Start       = aPad->ShapePos();
+    snapshot.m_End         = aPad->GetPosition();
+    snapshot.m_Layers      = aPad->GetLayerSet();
+    snapshot.m_NetCode     = aPad->GetNetCode();
+    snapshot.m_Shape       = aPad->GetShape();
+    snapshot.m_Orientation = aPad->GetOrientation();
+    snapshot.m_Size        = aPad->GetSize();
+    snapshot.m_Drill       = aPad->GetDrillSize();
+    snapshot.m_DrillShape  = aPad->GetDrillShape();
+    snapshot.m_Clearance   = aPad->GetLocalClearance();
+    snapshot.m_OutlineHash = 0;
+
+    return snapshot;
+}
+
+
+static DRC_ITEM_SNAPSHOT trackSnapshot( const TRACK* aTrack )
+{
+    DRC_ITEM_SNAPSHOT snapshot;
+
+    snapshot.m_BBox        = DRC_ITEMS_INDEX::TrackBoundingBox( aTrack );
+    snapshot.m_Start       = aTrack->GetStart();
+    snapshot.m_End         = aTrack->GetEnd();
+    snapshot.m_Layers      = aTrack->GetLayerSet();
+    snapshot.m_NetCode     = aTrack->GetNetCode();
+    snapshot.m_Shape       = aTrack->GetWidth();
+    snapshot.m_Orientation = 0.0;
+    snapshot.m_DrillShape  = 0;
+    snapshot.m_Clearance   = 0;
+    snapshot.m_OutlineHash = 0;
+
+    if( aTrack->Type() == PCB_VIA_T )
+    {
+        int drill = static_cast<const VIA*>( aTrack )->GetDrillValue();
+        snapshot.m_Drill = wxSize( drill, drill );
+    }
+
+    return snapshot;
+}
+
+
+static DRC_ITEM_SNAPSHOT zoneSnapshot( const ZONE_CONTAINER* aZone )
+{
+    DRC_ITEM_SNAPSHOT snapshot;
+
+    snapshot.m_BBox        = aZone->GetBoundingBox();
+    snapshot.m_Start       = aZone->GetNumCorners() ? aZone->GetCornerPosition( 0 ) : wxPoint();
+    snapshot.m_End         = wxPoint();
+    snapshot.m_Layers      = aZone->GetLayerSet();
+    snapshot.m_NetCode     = aZone->GetNetCode();
+    snapshot.m_Shape       = aZone->GetNumCorners();
+    snapshot.m_Orientation = 0.0;
+    snapshot.m_DrillShape  = 0;
+    snapshot.m_Clearance   = 0;
+    snapshot.m_OutlineHash = 0;
+
+    // An inner corner can be moved without changing the bounding box
+    for( int ii = 0; ii < aZone->GetNumCorners(); ii++ )
+    {
+        const wxPoint& corner = aZone->GetCornerPosition( ii );
+        boost::hash_combine( snapshot.m_OutlineHash, corner.x );
+        boost::hash_combine( snapshot.m_OutlineHash, corner.y );
+    }
+
+    boost::hash_combine( snapshot.m_OutlineHash, aZone->GetZoneClearance() );
+    boost::hash_combine( snapshot.m_OutlineHash, aZone->GetMinThickness() );
+
+    // Keepout options change what is tested, not the outline
+    if( aZone->GetIsKeepout() )
+        snapshot.m_Shape |= ( aZone->GetDoNotAllowTracks() << 30 )
+                          | ( aZone->GetDoNotAllowVias() << 29 );
+
+    return snapshot;
+}
+
+
+// Copper graphics and texts, and the board edges, knock out the zones
+static bool isZoneObstacle( const BOARD_ITEM* aItem )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_LINE_T:
+    case PCB_TEXT_T:
+    case PCB_MODULE_EDGE_T:
+        return IsCopperLayer( aItem->GetLayer() ) || aItem->GetLayer() == Edge_Cuts;
+
+    default:
+        return false;
+    }
+}
+
+
+static DRC_ITEM_SNAPSHOT graphicSnapshot( const BOARD_ITEM* aItem )
+{
+    DRC_ITEM_SNAPSHOT snapshot;
+
+    snapshot.m_BBox        = aItem->GetBoundingBox();
+    snapshot.m_Start       = aItem->GetPosition();
+    snapshot.m_End         = wxPoint();
+    snapshot.m_Layers      = aItem->GetLayerSet();
+    snapshot.m_NetCode     = 0;
+    snapshot.m_Shape       = 0;
+    snapshot.m_Orientation = 0.0;
+    snapshot.m_DrillShape  = 0;
+    snapshot.m_Clearance   = 0;
+    snapshot.m_OutlineHash = 0;
+
+    // Texts knock out their bounding box, but an arc or a polygon can change
+    // inside the same bounding box
+    if( aItem->Type() != PCB_TEXT_T )
+    {
+        const DRAWSEGMENT* segment = static_cast<const DRAWSEGMENT*>( aItem );
+        const std::vector<wxPoint>& points = segment->GetPolyPoints();
+
+        snapshot.m_Start       = segment->GetStart();
+        snapshot.m_End         = segment->GetEnd();
+        snapshot.m_Shape       = segment->GetWidth();
+        snapshot.m_Orientation = segment->GetAngle();
+        snapshot.m_DrillShape  = segment->GetShape();
+
+        for( unsigned ii = 0; ii < points.size(); ii++ )
+        {
+            boost::hash_combine( snapshot.m_OutlineHash, points[ii].x );
+            boost::hash_combine( snapshot.m_OutlineHash, points[ii].y );
+        }
+    }
+
+    return snapshot;
+}
+
+
+void DRC::takeSnapshot( DRC_SNAPSHOT_MAP& aSnapshot )
+{
+    aSnapshot.clear();
+
+    for( unsigned ii = 0; ii < m_pcb->GetPadCount(); ++ii )
+    {
+        D_PAD* pad = m_pcb->GetPad( ii );
+        aSnapshot[pad] = padSnapshot( pad );
+    }
+
+    for( TRACK* track = m_pcb->m_Track; track; track = track->Next() )
+        aSnapshot[track] = trackSnapshot( track );
+
+    for( int ii = 0; ii < m_pcb->GetAreaCount(); ii++ )
+    {
+        ZONE_CONTAINER* zone = m_pcb->GetArea( ii );
+        aSnapshot[zone] = zoneSnapshot( zone );
+    }
+
+    for( BOARD_ITEM* item = m_pcb->m_Drawings; item; item = item->Next() )
+    {
+        if( isZoneObstacle( item ) )
+            aSnapshot[item] = graphicSnapshot( item );
+    }
+
+    for( MODULE* module = m_pcb->m_Modules; module; module = module->Next() )
+    {
+        for( BOARD_ITEM* item = module->GraphicalItems(); item; item = item->Next() )
+        {
+            if( isZoneObstacle( item ) )
+                aSnapshot[item] = graphicSnapshot( item );
+        }
+    }
+}
+
+
+void DRC::removeItemMarkers( const boost::unordered_set<const BOARD_ITEM*>& aItems )
+{
+    // Markers can have been deleted by the user since they were created, so only
+    // the ones still owned by the board are removed
+    boost::unordered_set<MARKER_PCB*> obsolete;
+
+    for( DRC_ITEM_MARKERS::iterator it = m_itemMarkers.begin(); it != m_itemMarkers.end(); )
+    {
+        if( aItems.count( it->first ) )
+        {
+            obsolete.insert( it->second );
+            m_itemMarkers.erase( it++ );
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if( obsolete.empty() )
+        return;
+
+    for( int ii = m_pcb->GetMARKERCount() - 1; ii >= 0; --ii )
+    {
+        MARKER_PCB* marker = m_pcb->GetMARKER( ii );
+
+        if( obsolete.count( marker ) )
+        {
+            if( m_mainWindow )
+                m_mainWindow->GetGalCanvas()->GetView()->Remove( marker );
+
+            m_pcb->Delete( marker );
+        }
+    }
+}
+
+
+void DRC::ClearIncrementalState()
+{
+    m_snapshot.clear();
+    m_itemMarkers.clear();
+    m_snapshotValid = false;
+}
+
+
+void DRC::RunIncrementalTests( wxTextCtrl* aMessages )
+{
+    if( !m_snapshotValid )
+    {
+        RunTests( aMessages );
+        return;
+    }
+
+    if( aMessages )
+    {
+        aMessages->AppendText( _( "Find changes...\n" ) );
+        wxSafeYield();
+    }
+
+    // Compare the board to the snapshot of the last test to find the dirty areas:
+    // the old and the new areas of the modified items, the area of the new items
+    // and the area of the removed items.
+    DRC_SNAPSHOT_MAP current;
+    takeSnapshot( current );
+
+    std::vector<EDA_RECT> dirtyAreas;
+    boost::unordered_set<const BOARD_ITEM*> staleItems;    // items whose markers are obsolete
+
+    for( DRC_SNAPSHOT_MAP::const_iterator it = current.begin(); it != current.end(); ++it )
+    {
+        DRC_SNAPSHOT_MAP::const_iterator previous = m_snapshot.find( it->first );
+
+        if( previous == m_snapshot.end() )
+        {
+            dirtyAreas.push_back( it->second.m_BBox );
+        }
+        else if( previous->second != it->second )
+        {
+            dirtyAreas.push_back( previous->second.m_BBox );
+            dirtyAreas.push_back( it->second.m_BBox );
+        }
+    }
+
+    for( DRC_SNAPSHOT_MAP::const_iterator it = m_snapshot.begin(); it != m_snapshot.end(); ++it )
+    {
+        if( current.find( it->first ) == current.end() )
+        {
+            dirtyAreas.push_back( it->second.m_BBox );
+            staleItems.insert( it->first );
+        }
+    }
+
+    m_snapshot.swap( current );
+
+    // RunTests() refills all the zones: only the ones near the changes can be outdated
+    if( !dirtyAreas.empty() )
+    {
+        if( aMessages )
+        {
+            aMessages->AppendText( _( "Fill zones...\n" ) );
+            wxSafeYield();
+        }
+
+        fillZonesInAreas( dirtyAreas );
+    }
+
+    // Collect the pads and the tracks close enough to a dirty area to have a
+    // different test result.  They are the reference items to test again.
+    DRC_ITEMS_INDEX itemsIndex;
+    itemsIndex.Build( m_pcb );
+
+    std::vector<D_PAD*> pads;
+    std::vector<TRACK*> tracks;
+    boost::unordered_set<const BOARD_ITEM*> dirtyItems;
+
+    // The other item of a test can be at its clearance distance plus the size of the
+    // largest pad, which is already part of the pad bounding box.
+    int margin = itemsIndex.GetMaxClearance() + 1;
+
+    for( unsigned ii = 0; ii < dirtyAreas.size(); ++ii )
+    {
+        EDA_RECT area = dirtyAreas[ii];
+        area.Inflate( margin );
+
+        itemsIndex.QueryArea( area, pads, tracks, m_foundOrdinals );
+
+        dirtyItems.insert( pads.begin(), pads.end() );
+        dirtyItems.insert( tracks.begin(), tracks.end() );
+    }
+
+    staleItems.insert( dirtyItems.begin(), dirtyItems.end() );
+    removeItemMarkers( staleItems );
+
+    if( dirtyItems.empty() )
+    {
+        updatePointers();
+
+        if( aMessages )
+            aMessages->AppendText( _( "Finished" ) );
+
+        return;
+    }
+
+    // Pad to pad clearances: same test as testPad2Pad(), restricted to the dirty pads.
+    if( m_doPad2PadTest )
+    {
+        if( aMessages )
+        {
+            aMessages->AppendText( _( "Pad clearances...\n" ) );
+            wxSafeYield();
+        }
+
+        std::vector<D_PAD*> sortedPads;
+        m_pcb->GetSortedPadListByXthenYCoord( sortedPads );
+
+        int max_size = 0;
+
+        for( unsigned i = 0; i < sortedPads.size(); ++i )
+            max_size = std::max( max_size, sortedPads[i]->GetBoundingRadius() );
+
+        D_PAD** listEnd = &sortedPads[ sortedPads.size() ];
+
+        for( unsigned i = 0; i < sortedPads.size(); ++i )
+        {
+            D_PAD* pad = sortedPads[i];
+
+            if( !dirtyItems.count( pad ) )
+                continue;
+
+            int x_limit = max_size + pad->GetClearance() +
+                          pad->GetBoundingRadius() + pad->GetPosition().x;
+
+            if( !doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit ) )
+            {
+                addMarkerToPcb( pad, m_currentMarker );
+                m_currentMarker = 0;
+            }
+        }
+    }
+
+    // Track clearances and keepout areas, restricted to the dirty tracks
+    if( aMessages )
+    {
+        aMessages->AppendText( _( "Track clearances...\n" ) );
+        wxSafeYield();
+    }
+
+    m_itemsIndex = &itemsIndex;
+
+    for( TRACK* segm = m_pcb->m_Track; segm; segm = segm->Next() )
+    {
+        if( !dirtyItems.count( segm ) )
+            continue;
+
+        if( segm->Next() && !doTrackDrc( segm, segm->Next(), true ) )
+        {
+            addMarkerToPcb( segm, m_currentMarker );
+            m_currentMarker = 0;
+        }
+
+        if( !m_doKeepoutTest )
+            continue;
+
+        for( int ii = 0; ii < m_pcb->GetAreaCount(); ii++ )
+        {
+            ZONE_CONTAINER* area = m_pcb->GetArea( ii );
+
+            if( area->GetIsKeepout() && !doKeepoutDrc( area, segm ) )
+            {
+                addMarkerToPcb( segm, m_currentMarker );
+                m_currentMarker = 0;
+            }
+        }
+    }
+
+    m_itemsIndex = NULL;
+
+    // update the m_ui listboxes
+    updatePointers();
+
+    if( aMessages )
+        aMessages->AppendText( _( "Finished" ) );
+}
@@ -0,0 +1,277 @@
+/**
+ * @file drc_items_index.cpp
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <fctsys.h>
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_pad.h>
+#include <class_track.h>
+
+#include <drc_items_index.h>
+
+
+/**
+ * Visitor used with RTree::Search(): stores every ordinal it is given.
+ */
+struct ORDINAL_COLLECTOR
+{
+    ORDINAL_COLLECTOR( std::vector<int>& aFound ) :
+        m_found( aFound )
+    {
+    }
+
+    bool operator()( int aOrdinal )
+    {
+        m_found.push_back( aOrdinal );
+        return true;
+    }
+
+    std::vector<int>& m_found;
+};
+
+
+EDA_RECT DRC_ITEMS_INDEX::PadBoundingBox( const D_PAD* aPad )
+{
+    EDA_RECT bbox( aPad->ShapePos(), wxSize( 0, 0 ) );
+    bbox.Inflate( aPad->GetBoundingRadius() );
+
+    const wxSize& drill = aPad->GetDrillSize();
+
+    if( drill.x || drill.y )
+    {
+        EDA_RECT hole( aPad->GetPosition(), wxSize( 0, 0 ) );
+        hole.Inflate( ( std::max( drill.x, drill.y ) + 1 ) / 2 );
+        bbox.Merge( hole );
+    }
+
+    return bbox;
+}
+
+
+EDA_RECT DRC_ITEMS_INDEX::TrackBoundingBox( const TRACK* aTrack )
+{
+    EDA_RECT bbox( aTrack->GetStart(), wxSize( 0, 0 ) );
+
+    if( aTrack->Type() != PCB_VIA_T )
+        bbox.Merge( aTrack->GetEnd() );
+
+    bbox.Inflate( ( aTrack->GetWidth() + 1 ) / 2 );
+
+    return bbox;
+}
+
+
+DRC_ITEMS_INDEX::DRC_ITEMS_INDEX()
+{
+    for( int layer = 0; layer < LAYER_ID_COUNT; ++layer )
+        m_trees[layer] = NULL;
+
+    m_maxClearance = 0;
+}
+
+
+DRC_ITEMS_INDEX::~DRC_ITEMS_INDEX()
+{
+    for( int layer = 0; layer < LAYER_ID_COUNT; ++layer )
+        delete m_trees[layer];
+}
+
+
+void DRC_ITEMS_INDEX::Clear()
+{
+    for( int layer = 0; layer < LAYER_ID_COUNT; ++layer )
+    {
+        delete m_trees[layer];
+        m_trees[layer] = NULL;
+    }
+
+    m_pads.clear();
+    m_tracks.clear();
+    m_trackOrdinals.clear();
+    m_maxClearance = 0;
+}
+
+
+void DRC_ITEMS_INDEX::Build( BOARD* aBoard )
+{
+    Clear();
+
+    const LSET all_cu = LSET::AllCuMask();
+
+    m_pads = aBoard->GetPads();
+
+    for( unsigned ii = 0; ii < m_pads.size(); ++ii )
+    {
+        D_PAD* pad = m_pads[ii];
+        LSET layers = pad->GetLayerSet() & all_cu;
+
+        // A hole goes through all the copper layers, even if the pad does not
+        if( pad->GetDrillSize().x )
+            layers = all_cu;
+
+        if( layers.none() )
+            continue;
+
+        m_maxClearance = std::max( m_maxClearance, pad->GetClearance() );
+        insert( ii, PadBoundingBox( pad ), layers );
+    }
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        int ordinal = m_pads.size() + m_tracks.size();
+
+        m_tracks.push_back( track );
+        m_trackOrdinals[track] = ordinal;
+
+        m_maxClearance = std::max( m_maxClearance, track->GetClearance() );
+        insert( ordinal, TrackBoundingBox( track ), track->GetLayerSet() & all_cu );
+    }
+}
+
+
+void DRC_ITEMS_INDEX::insert( int aOrdinal, const EDA_RECT& aBBox, LSET aLayers )
+{
+    EDA_RECT bbox = aBBox;
+    bbox.Normalize();
+
+    const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+    const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+    for( LSEQ cu_stack = aLayers.CuStack(); cu_stack; ++cu_stack )
+    {
+        LAYER_ID layer = *cu_stack;
+
+        if( !m_trees[layer] )
+            m_trees[layer] = new ORDINAL_RTREE();
+
+        m_trees[layer]->Insert( mmin, mmax, aOrdinal );
+    }
+}
+
+
+void DRC_ITEMS_INDEX::query( const TRACK* aRefSeg, std::vector<int>& aFound ) const
+{
+    // The narrow phase tests use the largest of the two clearances, plus the half widths
+    // of both items.  The other item half width is already included in its box, and one
+    // more unit is added to stay on the safe side of rounding in the narrow phase.
+    int margin = std::max( m_maxClearance, aRefSeg->GetClearance() ) + 1;
+
+    EDA_RECT area = TrackBoundingBox( aRefSeg );
+    area.Inflate( margin );
+
+    queryRect( area, aRefSeg->GetLayerSet(), aFound );
+}
+
+
+void DRC_ITEMS_INDEX::queryRect( const EDA_RECT& aArea, LSET aLayers,
+                                 std::vector<int>& aFound ) const
+{
+    aFound.clear();
+
+    EDA_RECT area = aArea;
+    area.Normalize();
+
+    const int mmin[2] = { area.GetX(), area.GetY() };
+    const int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+    ORDINAL_COLLECTOR collector( aFound );
+    LSET layers = aLayers & LSET::AllCuMask();
+
+    for( LSEQ cu_stack = layers.CuStack(); cu_stack; ++cu_stack )
+    {
+        ORDINAL_RTREE* tree = m_trees[*cu_stack];
+
+        if( tree )
+            tree->Search( mmin, mmax, collector );
+    }
+
+    // Items on several layers (vias, through hole pads) are found more than once
+    std::sort( aFound.begin(), aFound.end() );
+    aFound.erase( std::unique( aFound.begin(), aFound.end() ), aFound.end() );
+}
+
+
+void DRC_ITEMS_INDEX::QueryPads( const TRACK* aRefSeg, std::vector<D_PAD*>& aPads,
+                                 std::vector<int>& aScratch ) const
+{
+    aPads.clear();
+
+    query( aRefSeg, aScratch );
+
+    int padCount = m_pads.size();
+
+    for( unsigned ii = 0; ii < aScratch.size() && aScratch[ii] < padCount; ++ii )
+        aPads.push_back( m_pads[ aScratch[ii] ] );
+}
+
+
+void DRC_ITEMS_INDEX::QueryTracks( const TRACK* aRefSeg, const TRACK* aStart,
+                                   std::vector<TRACK*>& aTracks,
+                                   std::vector<int>& aScratch ) const
+{
+    aTracks.clear();
+
+    if( !aStart )
+        return;
+
+    boost::unordered_map<const TRACK*, int>::const_iterator it = m_trackOrdinals.find( aStart );
+
+    if( it == m_trackOrdinals.end() )
+        return;
+
+    int first = it->second;
+    int padCount = m_pads.size();
+
+    query( aRefSeg, aScratch );
+
+    std::vector<int>::const_iterator found = std::lower_bound( aScratch.begin(), aScratch.end(),
+                                                                first );
+
+    for( ; found != aScratch.end(); ++found )
+        aTracks.push_back( m_tracks[ *found - padCount ] );
+}
+
+
+void DRC_ITEMS_INDEX::QueryArea( const EDA_RECT& aArea, std::vector<D_PAD*>& aPads,
+                                 std::vector<TRACK*>& aTracks, std::vector<int>& aScratch ) const
+{
+    aPads.clear();
+    aTracks.clear();
+
+    queryRect( aArea, LSET::AllCuMask(), aScratch );
+
+    int padCount = m_pads.size();
+
+    for( unsigned ii = 0; ii < aScratch.size(); ++ii )
+    {
+        if( aScratch[ii] < padCount )
+            aPads.push_back( m_pads[ aScratch[ii] ] );
+        else
+            aTracks.push_back( m_tracks[ aScratch[ii] - padCount ] );
+    }
+}
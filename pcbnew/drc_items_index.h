@@ -0,0 +1,184 @@
+/**
+ * @file drc_items_index.h
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef _DRC_ITEMS_INDEX_H
+#define _DRC_ITEMS_INDEX_H
+
+#include <vector>
+#include <boost/unordered_map.hpp>
+
+#include <layers_id_colors_and_visibility.h>
+#include <class_eda_rect.h>
+#include <geometry/rtree.h>
+
+class BOARD;
+class D_PAD;
+class TRACK;
+
+
+/**
+ * Class DRC_ITEMS_INDEX
+ * is the broadphase used by the track clearance tests.  It keeps one R-tree per
+ * copper layer containing the pads and the track segments of a BOARD, so that a
+ * reference segment only runs the (expensive) narrow phase tests against items
+ * whose bounding box, inflated by the worst case clearance, overlaps its own.
+ *
+ * Items are stored by their ordinal in the board lists (pads in BOARD::GetPad()
+ * order, tracks in BOARD::m_Track order) and candidates are always returned
+ * sorted by this ordinal, so the narrow phase visits them in exactly the order
+ * a plain list walk would, and reports the same first error.
+ *
+ * The index is a snapshot: it must be rebuilt if the board is modified.
+ * Once built, it is only read by the queries, which can run concurrently.
+ */
+class DRC_ITEMS_INDEX
+{
+public:
+    DRC_ITEMS_INDEX();
+    ~DRC_ITEMS_INDEX();
+
+    /**
+     * Function Build
+     * (re)creates the index from the pads and the tracks of aBoard.
+     */
+    void Build( BOARD* aBoard );
+
+    /**
+     * Function Clear
+     * removes all the items from the index.
+     */
+    void Clear();
+
+    /**
+     * Function QueryPads
+     * collects the pads which can be too close to aRefSeg, either because they share
+     * a copper layer with it, or because they have a hole (which exists on all layers).
+     * @param aRefSeg The reference segment.
+     * @param aPads The vector to fill, sorted by pad ordinal.
+     * @param aScratch A buffer used internally, owned by the caller so that several
+     *                 threads can query the same index.
+     */
+    void QueryPads( const TRACK* aRefSeg, std::vector<D_PAD*>& aPads,
+                    std::vector<int>& aScratch ) const;
+
+    /**
+     * Function QueryTracks
+     * collects the track segments which can be too close to aRefSeg, restricted to
+     * aStart and the segments following it in the board track list.
+     * @param aRefSeg The reference segment.
+     * @param aStart The first segment of the list to test against.  Nothing is
+     *               returned if it is NULL or is not known by the index.
+     * @param aTracks The vector to fill, sorted by track list order.
+     * @param aScratch A buffer used internally, see QueryPads().
+     */
+    void QueryTracks( const TRACK* aRefSeg, const TRACK* aStart, std::vector<TRACK*>& aTracks,
+                      std::vector<int>& aScratch ) const;
+
+    /**
+     * Function QueryArea
+     * collects the pads and the track segments, on any copper layer, whose bounding
+     * box intersects aArea.
+     * @param aArea The area to search.
+     * @param aPads The vector to fill with the found pads, sorted by pad ordinal.
+     * @param aTracks The vector to fill with the found tracks, sorted by track list order.
+     * @param aScratch A buffer used internally, see QueryPads().
+     */
+    void QueryArea( const EDA_RECT& aArea, std::vector<D_PAD*>& aPads,
+                    std::vector<TRACK*>& aTracks, std::vector<int>& aScratch ) const;
+
+    /**
+     * Function GetMaxClearance
+     * @return the largest clearance of the indexed items.
+     */
+    int GetMaxClearance() const
+    {
+        return m_maxClearance;
+    }
+
+    /**
+     * Function PadBoundingBox
+     * @return a box containing both the copper shape and the hole of aPad.
+     * D_PAD::GetBoundingBox() ignores the pad offset, so it cannot be used here.
+     */
+    static EDA_RECT PadBoundingBox( const D_PAD* aPad );
+
+    /**
+     * Function TrackBoundingBox
+     * @return the area covered by the copper of aTrack (TRACK::GetBoundingBox() also
+     * adds the clearance, which is accounted for separately here).
+     */
+    static EDA_RECT TrackBoundingBox( const TRACK* aTrack );
+
+    /**
+     * Function IsEmpty
+     * @return true if nothing is indexed.
+     */
+    bool IsEmpty() const
+    {
+        return m_pads.empty() && m_tracks.empty();
+    }
+
+private:
+    typedef RTree<int, int, 2, float>   ORDINAL_RTREE;
+
+    /**
+     * Function insert
+     * adds the ordinal aOrdinal with bounding box aBBox to the trees of all the
+     * copper layers in aLayers.
+     */
+    void insert( int aOrdinal, const EDA_RECT& aBBox, LSET aLayers );
+
+    /**
+     * Function query
+     * collects the ordinals of the items overlapping the area around aRefSeg into
+     * aFound, sorted and without duplicates.
+     */
+    void query( const TRACK* aRefSeg, std::vector<int>& aFound ) const;
+
+    /**
+     * Function queryRect
+     * collects the ordinals of the items overlapping aArea on the layers aLayers
+     * into aFound, sorted and without duplicates.
+     */
+    void queryRect( const EDA_RECT& aArea, LSET aLayers, std::vector<int>& aFound ) const;
+
+    ORDINAL_RTREE*          m_trees[LAYER_ID_COUNT];
+
+    ///> Pads, ordinals 0 .. m_pads.size() - 1
+    std::vector<D_PAD*>     m_pads;
+
+    ///> Tracks, ordinals m_pads.size() .. m_pads.size() + m_tracks.size() - 1
+    std::vector<TRACK*>     m_tracks;
+
+    ///> Ordinal of each indexed track, used to honor the aStart parameter of QueryTracks()
+    boost::unordered_map<const TRACK*, int> m_trackOrdinals;
+
+    ///> Largest clearance of any indexed item, used to inflate the search area
+    int                     m_maxClearance;
+};
+
+#endif  // _DRC_ITEMS_INDEX_H
@@ -0,0 +1,206 @@
+/**
+ * @file drc_report.cpp
+ * @brief Machine readable (JSON and CSV) DRC reports.
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <fctsys.h>
+#include <common.h>
+#include <macros.h>
+#include <kicad_string.h>
+#include <convert_to_biu.h>
+
+#include <class_board.h>
+#include <class_marker_pcb.h>
+
+#include <pcbnew.h>
+#include <drc_stuff.h>
+
+
+/**
+ * Function csvQuoted
+ * @return aText in double quotes, with its double quotes doubled.
+ */
+static std::string csvQuoted( const wxString& aText )
+{
+    std::string utf8 = TO_UTF8( aText );
+    std::string ret = "\"";
+
+    for( std::string::const_iterator it = utf8.begin(); it != utf8.end(); ++it )
+    {
+        if( *it == '"' )
+            ret += '"';
+
+        ret += *it;
+    }
+
+    ret += '"';
+
+    return ret;
+}
+
+
+/**
+ * Function jsonQuoted
+ * @return aText as a JSON string: in double quotes, with the double quotes, the
+ *         backslashes and the control characters escaped.
+ */
+static std::string jsonQuoted( const wxString& aText )
+{
+    std::string utf8 = TO_UTF8( aText );
+    std::string ret = "\"";
+
+    for( std::string::const_iterator it = utf8.begin(); it != utf8.end(); ++it )
+    {
+        unsigned char c = *it;
+
+        if( c == '"' || c == '\\' )
+        {
+            ret += '\\';
+            ret += c;
+        }
+        else if( c < 0x20 )
+        {
+            char escaped[8];
+            sprintf( escaped, "\\u%04x", c );
+            ret += escaped;
+        }
+        else
+        {
+            ret += c;
+        }
+    }
+
+    ret += '"';
+
+    return ret;
+}
+
+
+/**
+ * Function collectItems
+ * fills aItems with the DRC_ITEMs of the markers of aBoard, then with aUnconnected.
+ * @return the number of DRC_ITEMs coming from markers.
+ */
+static int collectItems( BOARD* aBoard, const DRC_LIST& aUnconnected,
+                         std::vector<const DRC_ITEM*>& aItems )
+{
+    for( int ii = 0; ii < aBoard->GetMARKERCount(); ++ii )
+        aItems.push_back( &aBoard->GetMARKER( ii )->GetReporter() );
+
+    int markerCount = aItems.size();
+
+    aItems.insert( aItems.end(), aUnconnected.begin(), aUnconnected.end() );
+
+    return markerCount;
+}
+
+
+void DRC::WriteJsonReport( FILE* aFile ) const
+{
+    LOCALE_IO   toggle;     // use a dot as decimal separator
+
+    std::vector<const DRC_ITEM*> items;
+    int markerCount = collectItems( m_pcb, m_unconnected, items );
+
+    fprintf( aFile, "{\n  \"board\": %s,\n",
+             jsonQuoted( m_pcb->GetFileName() ).c_str() );
+    fprintf( aFile, "  \"units\": \"mm\",\n" );
+
+    fprintf( aFile, "  \"phases\": [" );
+
+    for( unsigned ii = 0; ii < m_phaseTimes.size(); ++ii )
+    {
+        fprintf( aFile, "%s\n    { \"name\": %s, \"ms\": %.3f }", ii ? "," : "",
+                 jsonQuoted( m_phaseTimes[ii].first ).c_str(), m_phaseTimes[ii].second );
+    }
+
+    fprintf( aFile, "\n  ],\n  \"items\": [" );
+
+    for( unsigned ii = 0; ii < items.size(); ++ii )
+    {
+        const DRC_ITEM* item = items[ii];
+
+        fprintf( aFile, "%s\n    { \"kind\": \"%s\", \"code\": %d, \"error\": %s,\n",
+                 ii ? "," : "",
+                 (int) ii < markerCount ? "marker" : "unconnected",
+                 item->GetErrorCode(), jsonQuoted( item->GetErrorText() ).c_str() );
+
+        fprintf( aFile, "      \"a\": { \"text\": %s, \"x\": %.6f, \"y\": %.6f }",
+                 jsonQuoted( item->GetTextA() ).c_str(),
+                 item->GetPointA().x / IU_PER_MM, item->GetPointA().y / IU_PER_MM );
+
+        if( item->HasSecondItem() )
+        {
+            fprintf( aFile, ",\n      \"b\": { \"text\": %s, \"x\": %.6f, \"y\": %.6f }",
+                     jsonQuoted( item->GetTextB() ).c_str(),
+                     item->GetPointB().x / IU_PER_MM, item->GetPointB().y / IU_PER_MM );
+        }
+
+        fprintf( aFile, " }" );
+    }
+
+    fprintf( aFile, "\n  ]\n}\n" );
+}
+
+
+void DRC::WriteCsvReport( FILE* aFile ) const
+{
+    LOCALE_IO   toggle;     // use a dot as decimal separator
+
+    std::vector<const DRC_ITEM*> items;
+    int markerCount = collectItems( m_pcb, m_unconnected, items );
+
+    fprintf( aFile, "kind,code,error,text_a,x_a_mm,y_a_mm,text_b,x_b_mm,y_b_mm\n" );
+
+    for( unsigned ii = 0; ii < items.size(); ++ii )
+    {
+        const DRC_ITEM* item = items[ii];
+
+        fprintf( aFile, "%s,%d,%s,%s,%.6f,%.6f",
+                 (int) ii < markerCount ? "marker" : "unconnected",
+                 item->GetErrorCode(), csvQuoted( item->GetErrorText() ).c_str(),
+                 csvQuoted( item->GetTextA() ).c_str(),
+                 item->GetPointA().x / IU_PER_MM, item->GetPointA().y / IU_PER_MM );
+
+        if( item->HasSecondItem() )
+        {
+            fprintf( aFile, ",%s,%.6f,%.6f\n",
+                     csvQuoted( item->GetTextB() ).c_str(),
+                     item->GetPointB().x / IU_PER_MM, item->GetPointB().y / IU_PER_MM );
+        }
+        else
+        {
+            fprintf( aFile, ",,,\n" );
+        }
+    }
+
+    // The phase times use the same columns: the phase name, and the time in ms
+    for( unsigned ii = 0; ii < m_phaseTimes.size(); ++ii )
+    {
+        fprintf( aFile, "phase,,%s,,%.3f,,,,\n",
+                 csvQuoted( m_phaseTimes[ii].first ).c_str(), m_phaseTimes[ii].second );
+    }
+}
@@ -30,7 +30,14 @@
 #define _DRC_STUFF_H
 
 #include <vector>
+#include <map>
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+#include <drc_items_index.h>
+
+struct prof_counter;
 
 #define OK_DRC  0
 #define BAD_DRC 1
@@ -139,6 +146,57 @@ public:
 
 typedef std::vector<DRC_ITEM*> DRC_LIST;
 
+/// Wall time of a DRC phase, in milliseconds, by phase name
+typedef std::pair<wxString, double>     DRC_PHASE_TIME;
+typedef std::vector<DRC_PHASE_TIME>     DRC_PHASE_TIMES;
+
+
+/**
+ * Struct DRC_ITEM_SNAPSHOT
+ * is what the incremental DRC remembers of a pad, a track or a zone from the last
+ * run, to find the items which were added, removed or modified since.
+ */
+struct DRC_ITEM_SNAPSHOT
+{
+    EDA_RECT    m_BBox;             ///< copper area of the item
+    wxPoint     m_Start;            ///< track or graphic start, pad shape position or
+                                    ///< zone first corner
+    wxPoint     m_End;              ///< track or graphic end, pad position
+    LSET        m_Layers;
+    int         m_NetCode;
+    int         m_Shape;            ///< track or graphic width, pad shape or zone corner count
+    double      m_Orientation;      ///< pad orientation or graphic arc angle
+    wxSize      m_Size;             ///< pad size
+    wxSize      m_Drill;            ///< pad or via drill size
+    int         m_DrillShape;       ///< pad drill shape or graphic shape
+    int         m_Clearance;        ///< pad local clearance
+    std::size_t m_OutlineHash;      ///< zone corners, clearance and min thickness, or
+                                    ///< graphic polygon points
+
+    bool operator==( const DRC_ITEM_SNAPSHOT& aOther ) const
+    {
+        return m_BBox.GetOrigin() == aOther.m_BBox.GetOrigin()
+            && m_BBox.GetSize() == aOther.m_BBox.GetSize()
+            && m_Start == aOther.m_Start && m_End == aOther.m_End
+            && m_Layers == aOther.m_Layers && m_NetCode == aOther.m_NetCode
+            && m_Shape == aOther.m_Shape && m_Orientation == aOther.m_Orientation
+            && m_Size == aOther.m_Size && m_Drill == aOther.m_Drill
+            && m_DrillShape == aOther.m_DrillShape && m_Clearance == aOther.m_Clearance
+            && m_OutlineHash == aOther.m_OutlineHash;
+    }
+
+    bool operator!=( const DRC_ITEM_SNAPSHOT& aOther ) const
+    {
+        return !( *this == aOther );
+    }
+};
+
+
+typedef boost::unordered_map<const BOARD_ITEM*, DRC_ITEM_SNAPSHOT> DRC_SNAPSHOT_MAP;
+
+/// Markers created by the pad, track and keepout tests, by reference item.
+typedef std::multimap<const BOARD_ITEM*, MARKER_PCB*> DRC_ITEM_MARKERS;
+
 
 /**
  * Class DRC
@@ -199,11 +257,37 @@ private:
 
     DRC_LIST            m_unconnected;  ///< list of unconnected pads, as DRC_ITEMs
 
+    /* Broadphase used by doTrackDrc() during a full board test (see testTracks()).
+     * When NULL, doTrackDrc() tests the reference segment against all the pads
+     * and all the tracks, which is what the online DRC does.
+     * The index is shared (read only) by the worker DRC objects of parallel tests.
+     */
+    const DRC_ITEMS_INDEX* m_itemsIndex;
+    std::vector<D_PAD*>  m_padCandidates;      // pads to test in doTrackDrc()
+    std::vector<TRACK*>  m_trackCandidates;    // tracks to test in doTrackDrc()
+    std::vector<int>     m_foundOrdinals;      // scratch buffer for m_itemsIndex queries
+
+    /* State of the incremental DRC (see RunIncrementalTests()):
+     * the pads, tracks and zones as they were when the last full or incremental test
+     * was run, and the markers found for each of them by the item tests.
+     */
+    DRC_SNAPSHOT_MAP    m_snapshot;
+    bool                m_snapshotValid;
+    DRC_ITEM_MARKERS    m_itemMarkers;
+
+    DRC_PHASE_TIMES     m_phaseTimes;   ///< wall times of the phases of the last RunTests()
+
+    /**
+     * Function init
+     * sets the default test settings, used by the constructors.
+     */
+    void init();
 
     /**
      * Function updatePointers
      * is a private helper function used to update needed pointers from the
      * one pointer which is known not to change, m_mainWindow.
+     * Without a frame, m_pcb is the board given to the constructor and is kept.
      */
     void updatePointers();
 
@@ -277,16 +361,102 @@ private:
      */
     void testTracks( wxWindow * aActiveWindow, bool aShowProgressBar );
 
+    /**
+     * Function testTracksRange
+     * runs doTrackDrc() for the segments aSegments[aFirst] to aSegments[aLast - 1].
+     * When OpenMP is available, the segments are spread over several threads, each one
+     * working with its own DRC object so that no test state is shared.
+     * @param aSegments The reference segments; each one is tested against the segments
+     *                  following it in the board track list.
+     * @param aFirst The first segment to test.
+     * @param aLast The end of the range (excluded).
+     * @param aMarkers The found markers, stored at the index of their reference segment.
+     */
+    void testTracksRange( const std::vector<TRACK*>& aSegments, int aFirst, int aLast,
+                          std::vector<MARKER_PCB*>& aMarkers );
+
     void testPad2Pad();
 
     void testUnconnected();
 
+    /**
+     * Function testUnconnectedRatsnest
+     * gathers the unconnected items from the board connectivity data (RN_DATA),
+     * used instead of the legacy ratsnest when there is no frame.
+     */
+    void testUnconnectedRatsnest();
+
+    /**
+     * Function fillAllZones
+     * refills all the zones of the board, using the frame if there is one.
+     * @param aActiveWindow = the parent of the progress dialog, if a frame is used
+     */
+    void fillAllZones( wxWindow* aActiveWindow );
+
+    /**
+     * Function fillZonesInAreas
+     * refills the zones which can be modified by the changes inside aDirtyAreas,
+     * using the frame if there is one.
+     */
+    void fillZonesInAreas( const std::vector<EDA_RECT>& aDirtyAreas );
+
+    /**
+     * Function addPhaseTime
+     * stops aCounter, and records its time as the wall time of the phase aPhase.
+     */
+    void addPhaseTime( const wxString& aPhase, prof_counter& aCounter );
+
     void testZones();
 
     void testKeepoutAreas();
 
     void testTexts();
 
+    /**
+     * Function initWorker
+     * prepares this DRC to run tests on behalf of aParent in a worker thread: it
+     * shares the board and the broadphase of aParent, but has its own test state
+     * and its own current marker.
+     */
+    void initWorker( const DRC& aParent );
+
+    /**
+     * Function addMarkers
+     * adds aMarkers to the board and to the view, in the order of the vector (NULL
+     * entries are skipped), and clears the vector.  aRefItems[i] is the item which
+     * was tested when aMarkers[i] was found.
+     * Markers are found in parallel but always added here, from the main thread.
+     */
+    void addMarkers( const std::vector<BOARD_ITEM*>& aRefItems,
+                     std::vector<MARKER_PCB*>& aMarkers );
+
+    /**
+     * Function addMarkerToPcb
+     * adds aMarker to the board and to the view, and remembers it was found when
+     * testing aRefItem, so that an incremental DRC can replace it.
+     */
+    void addMarkerToPcb( const BOARD_ITEM* aRefItem, MARKER_PCB* aMarker );
+
+    /**
+     * Function addMarkerToPcb
+     * adds aMarker to the board, and to the view if there is a frame.
+     */
+    void addMarkerToPcb( MARKER_PCB* aMarker );
+
+    /**
+     * Function removeItemMarkers
+     * deletes the markers found by a previous run for the reference items aItems,
+     * if they are still on the board.
+     */
+    void removeItemMarkers( const boost::unordered_set<const BOARD_ITEM*>& aItems );
+
+    /**
+     * Function takeSnapshot
+     * fills aSnapshot with the current state of the pads, tracks and zones of the board,
+     * and of the copper graphics and board edges, which knock out the zones.
+     */
+    void takeSnapshot( DRC_SNAPSHOT_MAP& aSnapshot );
+
     //-----<single "item" tests>-----------------------------------------
 
     bool doNetClass( boost::shared_ptr<NETCLASS> aNetClass, wxString& msg );
@@ -322,6 +492,16 @@ private:
      */
     bool doTrackKeepoutDrc( TRACK* aRefSeg );
 
+    /**
+     * Function doKeepoutDrc
+     * tests the current segment or via against one keepout area.
+     * @param aArea The keepout area.
+     * @param aRefSeg The segment to test
+     * @return bool - true if no poblems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool doKeepoutDrc( ZONE_CONTAINER* aArea, TRACK* aRefSeg );
+
 
     /**
      * Function doEdgeZoneDrc
@@ -393,6 +573,13 @@ private:
 public:
     DRC( PCB_EDIT_FRAME* aPcbWindow );
 
+    /**
+     * Constructor
+     * creates a DRC without any window, to test aBoard from scripts or command
+     * line tools.  Only RunTests() and the report functions can be used then.
+     */
+    DRC( BOARD* aBoard );
+
     ~DRC();
 
     /**
@@ -484,6 +671,28 @@ public:
      */
     void RunTests( wxTextCtrl* aMessages = NULL );
 
+    /**
+     * Function RunIncrementalTests
+     * re-runs the pad to pad, track and keepout tests, but only for the items which can
+     * be affected by the pads, tracks, zones, copper graphics and board edges added,
+     * modified or removed since the last call to RunTests() or RunIncrementalTests().
+     * Markers of the other items are kept.  Only the zones near the changed items are
+     * refilled (see PCB_EDIT_FRAME::Fill_Zones_In_Areas()), and the zone, unconnected
+     * and text tests are not run.  Falls back to RunTests() if no test was run before.
+     * Changes of the design rules are not detected: RunTests() must be used then.
+     * @param aMessages = a wxTextControl where to display some activity messages. Can be NULL
+     */
+    void RunIncrementalTests( wxTextCtrl* aMessages = NULL );
+
+    /**
+     * Function ClearIncrementalState
+     * forgets the items and markers remembered by the last test, so the next
+     * RunIncrementalTests() runs all the tests.  To be called when the board is replaced
+     * or when the markers are deleted: the items are known by their address, which can
+     * be reused by new items.
+     */
+    void ClearIncrementalState();
+
     /**
      * Function ListUnconnectedPad
      * gathers a list of all the unconnected pads and shows them in the
@@ -499,6 +708,41 @@ public:
         return m_currentMarker;
     }
 
+    /**
+     * Function GetUnconnectedCount
+     * @return the number of unconnected items found by the last test.
+     */
+    int GetUnconnectedCount() const
+    {
+        return m_unconnected.size();
+    }
+
+    /**
+     * Function GetPhaseTimes
+     * @return the wall times of the phases (pad2pad, tracks, zone fill, zones,
+     *         unconnected, keepout, texts) of the last RunTests().
+     */
+    const DRC_PHASE_TIMES& GetPhaseTimes() const
+    {
+        return m_phaseTimes;
+    }
+
+    /**
+     * Function WriteJsonReport
+     * writes the markers of the board, the unconnected items and the phase times
+     * of the last RunTests() as a JSON object.
+     * @param aFile = the opened file to write to
+     */
+    void WriteJsonReport( FILE* aFile ) const;
+
+    /**
+     * Function WriteCsvReport
+     * writes the markers of the board and the unconnected items, one per line,
+     * as comma separated values.  Phase times are written as "phase" lines.
+     * @param aFile = the opened file to write to
+     */
+    void WriteCsvReport( FILE* aFile ) const;
+
 };
 
 
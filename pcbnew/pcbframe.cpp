@@ -65,6 +65,7 @@
 #include <worksheet_viewitem.h>
 #include <ratsnest_data.h>
 #include <ratsnest_viewitem.h>
+#include <zone_clearance_cache.h>
 
 #include <tool/tool_manager.h>
 #include <tool/tool_dispatcher.h>
@@ -322,6 +323,8 @@ PCB_EDIT_FRAME::PCB_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent ) :
     m_SelLayerBox = NULL;
     m_show_microwave_tools = false;
     m_show_layer_manager_tools = true;
+    m_zoneClearanceCache = new ZONE_CLEARANCE_CACHE();  // used by SetBoard()
+    m_drc = NULL;                       // created after the first SetBoard()
     m_hotkeysDescrList = g_Board_Editor_Hokeys_Descr;
     m_hasAutoSave = true;
     m_RecordingMacros = -1;
@@ -480,6 +483,7 @@ PCB_EDIT_FRAME::~PCB_EDIT_FRAME()
         m_Macros[i].m_Record.clear();
 
     delete m_drc;
+    delete m_zoneClearanceCache;
 }
 
 
@@ -487,6 +491,12 @@ void PCB_EDIT_FRAME::SetBoard( BOARD* aBoard )
 {
     PCB_BASE_EDIT_FRAME::SetBoard( aBoard );
 
+    m_zoneClearanceCache->Clear();
+
+    // The items of the previous board are deleted, their addresses can be reused
+    if( m_drc )
+        m_drc->ClearIncrementalState();
+
     if( IsGalCanvasActive() )
     {
         aBoard->GetRatsnest()->Recalculate();
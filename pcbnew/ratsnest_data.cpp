@@ -43,6 +43,7 @@
 #include <boost/scoped_ptr.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/bind.hpp>
+#include <boost/functional/hash.hpp>
 
 #include <geometry/shape_poly_set.h>
 
@@ -65,19 +66,6 @@ static uint64_t getDistance( const RN_NODE_PTR& aNode1, const RN_NODE_PTR& aNode
 }
 
 
-static bool sortDistance( const RN_NODE_PTR& aOrigin, const RN_NODE_PTR& aNode1,
-                   const RN_NODE_PTR& aNode2 )
-{
-    return getDistance( aOrigin, aNode1 ) < getDistance( aOrigin, aNode2 );
-}
-
-
-static bool sortWeight( const RN_EDGE_PTR& aEdge1, const RN_EDGE_PTR& aEdge2 )
-{
-    return aEdge1->GetWeight() < aEdge2->GetWeight();
-}
-
-
 bool sortArea( const RN_POLY& aP1, const RN_POLY& aP2 )
 {
     return aP1.m_bbox.GetArea() < aP2.m_bbox.GetArea();
@@ -114,10 +102,15 @@ static bool isEdgeConnectingNode( const RN_EDGE_PTR& aEdge, const RN_NODE_PTR& a
 }
 
 
-static std::vector<RN_EDGE_MST_PTR>* kruskalMST( RN_LINKS::RN_EDGE_LIST& aEdges,
-                                                 std::vector<RN_NODE_PTR>& aNodes )
+std::vector<RN_EDGE_MST_PTR>* RN_NET::kruskalMST()
 {
-    unsigned int nodeNumber = aNodes.size();
+    std::vector<RN_NODE_PTR>& nodes = m_arena.m_Nodes;
+    std::vector<int>& tags = m_arena.m_Tags;
+    std::vector<int>& next = m_arena.m_NextInTree;
+    std::vector<int>& first = m_arena.m_TreeFirst;
+    std::vector<int>& last = m_arena.m_TreeLast;
+
+    unsigned int nodeNumber = nodes.size();
     unsigned int mstExpectedSize = nodeNumber - 1;
     unsigned int mstSize = 0;
     bool ratsnestLines = false;
@@ -126,82 +119,77 @@ static std::vector<RN_EDGE_MST_PTR>* kruskalMST( RN_LINKS::RN_EDGE_LIST& aEdges,
     std::vector<RN_EDGE_MST_PTR>* mst = new std::vector<RN_EDGE_MST_PTR>;
     mst->reserve( mstExpectedSize );
 
-    // Set tags for marking cycles
-    boost::unordered_map<RN_NODE_PTR, int> tags;
-    unsigned int tag = 0;
-    BOOST_FOREACH( RN_NODE_PTR& node, aNodes )
+    // Set tags for marking cycles. Every node starts as a subtree of its own, nodes
+    // connected together (subtrees) are chained to detect cycles in the graph
+    tags.resize( nodeNumber );
+    next.assign( nodeNumber, -1 );
+    first.resize( nodeNumber );
+    last.resize( nodeNumber );
+
+    for( unsigned int i = 0; i < nodeNumber; ++i )
     {
-        node->SetTag( tag );
-        tags[node] = tag++;
+        nodes[i]->SetTag( i );
+        tags[i] = i;
+        first[i] = i;
+        last[i] = i;
     }
 
-    // Lists of nodes connected together (subtrees) to detect cycles in the graph
-    std::vector<std::list<int> > cycles( nodeNumber );
-    for( unsigned int i = 0; i < nodeNumber; ++i )
-        cycles[i].push_back( i );
+    // Kruskal algorithm requires edges to be sorted by their weight. The edge index is
+    // a part of the key, so edges of the same weight are processed in their original order.
+    std::vector<std::pair<uint64_t, int> >& order = m_arena.m_Order;
+    order.resize( m_arena.m_EdgeWeight.size() );
 
-    // Kruskal algorithm requires edges to be sorted by their weight
-    aEdges.sort( sortWeight );
+    for( unsigned int i = 0; i < order.size(); ++i )
+        order[i] = std::make_pair( (uint64_t) m_arena.m_EdgeWeight[i], (int) i );
 
-    while( mstSize < mstExpectedSize && !aEdges.empty() )
-    {
-        RN_EDGE_PTR& dt = aEdges.front();
+    std::sort( order.begin(), order.end() );
 
-        int srcTag = tags[dt->GetSourceNode()];
-        int trgTag = tags[dt->GetTargetNode()];
+    for( unsigned int i = 0; i < order.size() && mstSize < mstExpectedSize; ++i )
+    {
+        int edge = order[i].second;
+        int srcTag = tags[m_arena.m_EdgeSource[edge]];
+        int trgTag = tags[m_arena.m_EdgeTarget[edge]];
 
         // Check if by adding this edge we are going to join two different forests
-        if( srcTag != trgTag )
-        {
-            // Because edges are sorted by their weight, first we always process connected
-            // items (weight == 0). Once we stumble upon an edge with non-zero weight,
-            // it means that the rest of the lines are ratsnest.
-            if( !ratsnestLines && dt->GetWeight() != 0 )
-                ratsnestLines = true;
+        if( srcTag == trgTag )
+            continue;
 
-            // Update tags
-            std::list<int>::iterator it, itEnd;
+        unsigned int weight = m_arena.m_EdgeWeight[edge];
 
-            if( ratsnestLines )
-            {
-                for( it = cycles[trgTag].begin(), itEnd = cycles[trgTag].end(); it != itEnd; ++it )
-                    tags[aNodes[*it]] = srcTag;
-            }
-            else
-            {
-                for( it = cycles[trgTag].begin(), itEnd = cycles[trgTag].end(); it != itEnd; ++it ) {
-                    tags[aNodes[*it]] = srcTag;
-                    aNodes[*it]->SetTag( srcTag );
-                }
-            }
+        // Because edges are sorted by their weight, first we always process connected
+        // items (weight == 0). Once we stumble upon an edge with non-zero weight,
+        // it means that the rest of the lines are ratsnest.
+        if( !ratsnestLines && weight != 0 )
+            ratsnestLines = true;
 
-            // Move nodes that were marked with old tag to the list marked with the new tag
-            cycles[srcTag].splice( cycles[srcTag].end(), cycles[trgTag] );
+        // Update tags
+        for( int node = first[trgTag]; node >= 0; node = next[node] )
+        {
+            tags[node] = srcTag;
 
-            if( ratsnestLines )
-            {
-                // Do a copy of edge, but make it RN_EDGE_MST. In contrary to RN_EDGE,
-                // RN_EDGE_MST saves both source and target node and does not require any other
-                // edges to exist for getting source/target nodes
-                RN_EDGE_MST_PTR newEdge = boost::make_shared<RN_EDGE_MST>( dt->GetSourceNode(),
-                                                                           dt->GetTargetNode(),
-                                                                           dt->GetWeight() );
-                mst->push_back( newEdge );
-                ++mstSize;
-            }
-            else
-            {
-                // Processing a connection, decrease the expected size of the ratsnest MST
-                --mstExpectedSize;
-            }
+            if( !ratsnestLines )
+                nodes[node]->SetTag( srcTag );
         }
 
-        // Remove the edge that was just processed
-        aEdges.erase( aEdges.begin() );
-    }
+        // Move nodes that were marked with old tag to the list marked with the new tag
+        next[last[srcTag]] = first[trgTag];
+        last[srcTag] = last[trgTag];
 
-    // Probably we have discarded some of edges, so reduce the size
-    mst->resize( mstSize );
+        if( ratsnestLines )
+        {
+            // RN_EDGE_MST saves both source and target node and does not require any other
+            // edges to exist for getting source/target nodes
+            mst->push_back( boost::make_shared<RN_EDGE_MST>( nodes[m_arena.m_EdgeSource[edge]],
+                                                             nodes[m_arena.m_EdgeTarget[edge]],
+                                                             weight ) );
+            ++mstSize;
+        }
+        else
+        {
+            // Processing a connection, decrease the expected size of the ratsnest MST
+            --mstExpectedSize;
+        }
+    }
 
     return mst;
 }
@@ -342,31 +330,289 @@ void RN_NET::compute()
             m_rnEdges->push_back( boost::make_shared<RN_EDGE_MST>( *boardNodes.begin(), *last ) );
         }
 
-        // Set tags to nodes as connected
+        // Tag the nodes as connected, unless the only possible connection is missing
+        int tag = 0;
+
         BOOST_FOREACH( RN_NODE_PTR node, boardNodes )
-            node->SetTag( 0 );
+        {
+            node->SetTag( tag );
+
+            if( boardEdges.empty() )
+                ++tag;
+        }
+
+        m_delaunay.Clear();
 
         return;
     }
 
     // Move and sort (sorting speeds up) all nodes to a vector for the Delaunay triangulation
-    std::vector<RN_NODE_PTR> nodes( boardNodes.size() );
-    std::partial_sort_copy( boardNodes.begin(), boardNodes.end(), nodes.begin(), nodes.end() );
+    std::vector<RN_NODE_PTR>& nodes = m_arena.m_Nodes;
+    nodes.assign( boardNodes.begin(), boardNodes.end() );
+    std::sort( nodes.begin(), nodes.end() );
+
+    // Tags are used to find the index of the edge nodes
+    for( unsigned int i = 0; i < nodes.size(); ++i )
+        nodes[i]->SetTag( i );
+
+    if( !updateDelaunay() )
+        createDelaunay();
+
+    // The currently existing connections come first (in reverse order, as they used to be
+    // inserted at the front of the triangulation results)
+    RN_LINKS::RN_EDGE_LIST::const_reverse_iterator rit, ritEnd;
+    for( rit = boardEdges.rbegin(), ritEnd = boardEdges.rend(); rit != ritEnd; ++rit )
+    {
+        int source = nodeIndex( (*rit)->GetSourceNode() );
+        int target = nodeIndex( (*rit)->GetTargetNode() );
+
+        if( source >= 0 && target >= 0 )
+            addEdge( source, target, (*rit)->GetWeight() );
+    }
+
+    // Then the triangulation edges with their weight/distance
+    for( unsigned int i = 0; i < m_delaunay.m_EdgeSource.size(); ++i )
+    {
+        int source = m_delaunay.m_EdgeSource[i];
+        int target = m_delaunay.m_EdgeTarget[i];
+
+        addEdge( source, target, getDistance( nodes[source], nodes[target] ) );
+    }
+
+    // Get the minimal spanning tree
+    m_rnEdges.reset( kruskalMST() );
+
+    // Keep the buffers, but do not hold the nodes
+    m_arena.Clear();
+}
+
+
+int RN_NET::nodeIndex( const RN_NODE_PTR& aNode ) const
+{
+    const std::vector<RN_NODE_PTR>& nodes = m_arena.m_Nodes;
+    int index = aNode->GetTag();
+
+    if( index < 0 || index >= (int) nodes.size() || nodes[index].get() != aNode.get() )
+        return -1;
+
+    return index;
+}
+
+
+void RN_NET::createDelaunay()
+{
+    m_delaunay.Clear();
+    addDelaunayEdges( m_arena.m_Nodes );
+    m_delaunay.m_Nodes = m_arena.m_Nodes;
+}
+
+
+void RN_NET::addDelaunayEdges( std::vector<RN_NODE_PTR>& aNodes )
+{
+    if( aNodes.size() < 2 )
+        return;
+
+    if( aNodes.size() == 2 )
+    {
+        m_delaunay.m_EdgeSource.push_back( nodeIndex( aNodes[0] ) );
+        m_delaunay.m_EdgeTarget.push_back( nodeIndex( aNodes[1] ) );
+        return;
+    }
 
     TRIANGULATOR triangulator;
-    triangulator.CreateDelaunay( nodes.begin(), nodes.end() );
+    triangulator.CreateDelaunay( aNodes.begin(), aNodes.end() );
     boost::scoped_ptr<RN_LINKS::RN_EDGE_LIST> triangEdges( triangulator.GetEdges() );
 
-    // Compute weight/distance for edges resulting from triangulation
-    RN_LINKS::RN_EDGE_LIST::iterator eit, eitEnd;
-    for( eit = (*triangEdges).begin(), eitEnd = (*triangEdges).end(); eit != eitEnd; ++eit )
-        (*eit)->SetWeight( getDistance( (*eit)->GetSourceNode(), (*eit)->GetTargetNode() ) );
+    RN_LINKS::RN_EDGE_LIST::const_iterator eit, eitEnd;
+    for( eit = triangEdges->begin(), eitEnd = triangEdges->end(); eit != eitEnd; ++eit )
+    {
+        int source = nodeIndex( (*eit)->GetSourceNode() );
+        int target = nodeIndex( (*eit)->GetTargetNode() );
 
-    // Add the currently existing connections list to the results of triangulation
-    std::copy( boardEdges.begin(), boardEdges.end(), std::front_inserter( *triangEdges ) );
+        if( source >= 0 && target >= 0 )
+        {
+            m_delaunay.m_EdgeSource.push_back( source );
+            m_delaunay.m_EdgeTarget.push_back( target );
+        }
+    }
+}
 
-    // Get the minimal spanning tree
-    m_rnEdges.reset( kruskalMST( *triangEdges, nodes ) );
+
+///> Nets with less nodes are always fully triangulated
+static const unsigned int MIN_INCREMENTAL_NODES = 128;
+
+///> Number of incremental updates after which the triangulation is fully recomputed
+static const int MAX_INCREMENTAL_UPDATES = 32;
+
+///> Number of the closest unchanged nodes triangulated again with an added node
+static const int NEIGHBOUR_COUNT = 8;
+
+bool RN_NET::updateDelaunay()
+{
+    const std::vector<RN_NODE_PTR>& nodes = m_arena.m_Nodes;
+    const std::vector<RN_NODE_PTR>& oldNodes = m_delaunay.m_Nodes;
+    std::vector<int>& oldToNew = m_arena.m_OldToNew;
+    std::vector<int>& marks = m_arena.m_Marks;
+    std::vector<int>& sources = m_delaunay.m_EdgeSource;
+    std::vector<int>& targets = m_delaunay.m_EdgeTarget;
+
+    enum { UNCHANGED = 0, ADDED, SEED, NEIGHBOUR };
+
+    if( oldNodes.empty() || nodes.size() < MIN_INCREMENTAL_NODES
+            || m_delaunay.m_Updates >= MAX_INCREMENTAL_UPDATES )
+        return false;
+
+    // Both node lists are sorted, so the nodes which have been added or removed are
+    // found by walking them together
+    oldToNew.assign( oldNodes.size(), -1 );
+    marks.assign( nodes.size(), UNCHANGED );
+
+    unsigned int changes = 0;
+    unsigned int i = 0, j = 0;
+
+    while( i < oldNodes.size() || j < nodes.size() )
+    {
+        if( i < oldNodes.size() && j < nodes.size() && oldNodes[i].get() == nodes[j].get() )
+        {
+            oldToNew[i++] = j++;
+        }
+        else if( j == nodes.size() || ( i < oldNodes.size() && oldNodes[i] < nodes[j] ) )
+        {
+            ++i;        // removed
+            ++changes;
+        }
+        else
+        {
+            marks[j++] = ADDED;
+            ++changes;
+        }
+    }
+
+    if( changes * 4 > nodes.size() )
+        return false;
+
+    // The neighbours of a removed node have to be connected again
+    for( unsigned int e = 0; e < sources.size(); ++e )
+    {
+        int source = oldToNew[sources[e]];
+        int target = oldToNew[targets[e]];
+
+        if( source < 0 && target >= 0 )
+            marks[target] = SEED;
+        else if( target < 0 && source >= 0 )
+            marks[source] = SEED;
+    }
+
+    // An added node is connected to the closest unchanged nodes
+    for( j = 0; j < nodes.size(); ++j )
+    {
+        if( marks[j] != ADDED )
+            continue;
+
+        uint64_t distances[NEIGHBOUR_COUNT];
+        int closest[NEIGHBOUR_COUNT];
+        int count = 0;
+
+        for( unsigned int k = 0; k < nodes.size(); ++k )
+        {
+            if( marks[k] == ADDED )
+                continue;
+
+            uint64_t distance = getDistance( nodes[j], nodes[k] );
+            int pos = count;
+
+            if( count < NEIGHBOUR_COUNT )
+                ++count;
+            else if( distance >= distances[count - 1] )
+                continue;
+            else
+                --pos;
+
+            // Insertion sort of the closest nodes
+            for( ; pos > 0 && distances[pos - 1] > distance; --pos )
+            {
+                distances[pos] = distances[pos - 1];
+                closest[pos] = closest[pos - 1];
+            }
+
+            distances[pos] = distance;
+            closest[pos] = (int) k;
+        }
+
+        for( int k = 0; k < count; ++k )
+            marks[closest[k]] = SEED;
+    }
+
+    // Keep the edges between the remaining nodes, and triangulate again the neighbours of
+    // the seeds too, so the new triangles are joined to the unchanged ones
+    unsigned int kept = 0;
+
+    for( unsigned int e = 0; e < sources.size(); ++e )
+    {
+        int source = oldToNew[sources[e]];
+        int target = oldToNew[targets[e]];
+
+        if( source < 0 || target < 0 )
+            continue;
+
+        if( marks[source] == SEED && marks[target] == UNCHANGED )
+            marks[target] = NEIGHBOUR;
+        else if( marks[target] == SEED && marks[source] == UNCHANGED )
+            marks[source] = NEIGHBOUR;
+
+        sources[kept] = source;
+        targets[kept] = target;
+        ++kept;
+    }
+
+    sources.resize( kept );
+    targets.resize( kept );
+
+    // Triangulate the changed area
+    std::vector<RN_NODE_PTR>& local = m_arena.m_LocalNodes;
+
+    for( j = 0; j < nodes.size(); ++j )
+    {
+        if( marks[j] != UNCHANGED )
+            local.push_back( nodes[j] );
+    }
+
+    addDelaunayEdges( local );
+    local.clear();
+
+    // Remove the duplicated edges
+    std::vector<std::pair<uint64_t, int> >& order = m_arena.m_Order;
+    order.clear();
+
+    for( unsigned int e = 0; e < sources.size(); ++e )
+    {
+        uint64_t first = std::min( sources[e], targets[e] );
+        uint64_t second = std::max( sources[e], targets[e] );
+
+        order.push_back( std::make_pair( ( first << 32 ) | second, (int) e ) );
+    }
+
+    std::sort( order.begin(), order.end() );
+    kept = 0;
+
+    for( unsigned int e = 0; e < order.size(); ++e )
+    {
+        if( e > 0 && order[e].first == order[e - 1].first )
+            continue;
+
+        sources[kept] = order[e].first >> 32;
+        targets[kept] = order[e].first & 0xffffffff;
+        ++kept;
+    }
+
+    sources.resize( kept );
+    targets.resize( kept );
+    order.clear();
+
+    m_delaunay.m_Nodes = nodes;
+    ++m_delaunay.m_Updates;
+
+    return true;
 }
 
 
@@ -413,8 +659,10 @@ bool RN_POLY::HitTest( const RN_NODE_PTR& aNode ) const
 void RN_NET::Update()
 {
     // Add edges resulting from nodes being connected by zones
+    sortNodes();
     processZones();
     processPads();
+    m_arena.Clear();
 
     compute();
 
@@ -558,7 +806,7 @@ const RN_NODE_PTR RN_NET::GetClosestNode( const RN_NODE_PTR& aNode ) const
 
     for( it = nodes.begin(), itEnd = nodes.end(); it != itEnd; ++it )
     {
-        RN_NODE_PTR node = *it;
+        const RN_NODE_PTR& node = *it;
 
         // Obviously the distance between node and itself is the shortest,
         // that's why we have to skip it
@@ -588,7 +836,7 @@ const RN_NODE_PTR RN_NET::GetClosestNode( const RN_NODE_PTR& aNode,
 
     for( it = nodes.begin(), itEnd = nodes.end(); it != itEnd; ++it )
     {
-        RN_NODE_PTR node = *it;
+        const RN_NODE_PTR& node = *it;
 
         // Obviously the distance between node and itself is the shortest,
         // that's why we have to skip it
@@ -610,49 +858,41 @@ const RN_NODE_PTR RN_NET::GetClosestNode( const RN_NODE_PTR& aNode,
 
 std::list<RN_NODE_PTR> RN_NET::GetClosestNodes( const RN_NODE_PTR& aNode, int aNumber ) const
 {
-    std::list<RN_NODE_PTR> closest;
-    const RN_LINKS::RN_NODE_SET& nodes = m_links.GetNodes();
-
-    // Copy nodes
-    BOOST_FOREACH( const RN_NODE_PTR& node, nodes )
-        closest.push_back( node );
-
-    // Sort by the distance from aNode
-    closest.sort( boost::bind( sortDistance, boost::cref( aNode ), _1, _2 ) );
-
-    // aNode should not be returned in the results
-    closest.remove( aNode );
-
-    // Trim the result to the asked size
-    if( aNumber > 0 )
-        closest.resize( std::min( (size_t)aNumber, nodes.size() ) );
-
-    return closest;
+    return GetClosestNodes( aNode, RN_NODE_FILTER(), aNumber );
 }
 
 
 std::list<RN_NODE_PTR> RN_NET::GetClosestNodes( const RN_NODE_PTR& aNode,
                                                 const RN_NODE_FILTER& aFilter, int aNumber ) const
 {
-    std::list<RN_NODE_PTR> closest;
     const RN_LINKS::RN_NODE_SET& nodes = m_links.GetNodes();
+    std::vector<RN_NODE_PTR>& candidates = m_arena.m_Nodes;
+    std::vector<std::pair<uint64_t, int> >& order = m_arena.m_Order;
 
-    // Copy nodes
+    // Copy nodes, except aNode and the ones filtered out, with their distance from aNode
     BOOST_FOREACH( const RN_NODE_PTR& node, nodes )
-        closest.push_back( node );
-
-    // Sort by the distance from aNode
-    closest.sort( boost::bind( sortDistance, boost::cref( aNode ), _1, _2 ) );
+    {
+        if( node.get() == aNode.get() || !aFilter( node ) )
+            continue;
 
-    // aNode should not be returned in the results
-    closest.remove( aNode );
+        order.push_back( std::make_pair( getDistance( aNode, node ), (int) candidates.size() ) );
+        candidates.push_back( node );
+    }
 
-    // Filter out by condition
-    std::remove_if( closest.begin(), closest.end(), aFilter );
+    // Sort by the distance from aNode, only the asked number of nodes is needed
+    size_t count = order.size();
 
-    // Trim the result to the asked size
     if( aNumber > 0 )
-        closest.resize( std::min( static_cast<size_t>( aNumber ), nodes.size() ) );
+        count = std::min( static_cast<size_t>( aNumber ), count );
+
+    std::partial_sort( order.begin(), order.begin() + count, order.end() );
+
+    std::list<RN_NODE_PTR> closest;
+
+    for( size_t i = 0; i < count; ++i )
+        closest.push_back( candidates[order[i].second] );
+
+    m_arena.Clear();
 
     return closest;
 }
@@ -821,6 +1061,20 @@ void RN_NET::GetConnectedItems( const BOARD_CONNECTED_ITEM* aItem,
 }
 
 
+int RN_NET::GetCluster( const BOARD_CONNECTED_ITEM* aItem ) const
+{
+    if( aItem->Type() == PCB_ZONE_AREA_T )
+        return -1;
+
+    std::list<RN_NODE_PTR> nodes = GetNodes( aItem );
+
+    if( nodes.empty() )
+        return -1;
+
+    return nodes.front()->GetTag();
+}
+
+
 void RN_DATA::AddSimple( const BOARD_ITEM* aItem )
 {
     int net;
@@ -926,6 +1180,17 @@ bool RN_DATA::AreConnected( const BOARD_CONNECTED_ITEM* aItem, const BOARD_CONNE
 }
 
 
+int RN_DATA::GetCluster( const BOARD_CONNECTED_ITEM* aItem ) const
+{
+    int net = aItem->GetNetCode();
+
+    if( net < 1 || net >= (int) m_nets.size() )
+        return -1;
+
+    return m_nets[net].GetCluster( aItem );
+}
+
+
 int RN_DATA::GetUnconnectedCount() const
 {
     int count = 0;
@@ -942,9 +1207,60 @@ int RN_DATA::GetUnconnectedCount() const
 }
 
 
+///> Compares the x coordinate of nodes, for sorting and searching the nodes by position.
+struct RN_NODE_X_LESS
+{
+    bool operator()( const RN_NODE_PTR* aNode1, const RN_NODE_PTR* aNode2 ) const
+    {
+        return (*aNode1)->GetX() < (*aNode2)->GetX();
+    }
+
+    bool operator()( const RN_NODE_PTR* aNode, int aX ) const
+    {
+        return (*aNode)->GetX() < aX;
+    }
+
+    bool operator()( int aX, const RN_NODE_PTR* aNode ) const
+    {
+        return aX < (*aNode)->GetX();
+    }
+};
+
+
+void RN_NET::sortNodes()
+{
+    const RN_LINKS::RN_NODE_SET& nodes = m_links.GetNodes();
+    std::vector<const RN_NODE_PTR*>& byX = m_arena.m_ByX;
+
+    byX.clear();
+
+    BOOST_FOREACH( const RN_NODE_PTR& node, nodes )
+        byX.push_back( &node );
+
+    // Stable, so nodes with the same x coordinate are processed in the node set order
+    std::stable_sort( byX.begin(), byX.end(), RN_NODE_X_LESS() );
+}
+
+
+void RN_NET::findNodes( int aMinX, int aMaxX, unsigned int& aFirst, unsigned int& aLast ) const
+{
+    const std::vector<const RN_NODE_PTR*>& byX = m_arena.m_ByX;
+
+    aFirst = std::lower_bound( byX.begin(), byX.end(), aMinX, RN_NODE_X_LESS() ) - byX.begin();
+    aLast = std::upper_bound( byX.begin() + aFirst, byX.end(), aMaxX, RN_NODE_X_LESS() )
+            - byX.begin();
+}
+
+
 void RN_NET::processZones()
 {
-    for( ZONE_DATA_MAP::iterator it = m_zones.begin(); it != m_zones.end(); ++it )
+    const std::vector<const RN_NODE_PTR*>& candidates = m_arena.m_ByX;
+    std::vector<int>& claimed = m_arena.m_Claimed;
+    int zoneIndex = 0;
+
+    claimed.assign( candidates.size(), -1 );
+
+    for( ZONE_DATA_MAP::iterator it = m_zones.begin(); it != m_zones.end(); ++it, ++zoneIndex )
     {
         const ZONE_CONTAINER* zone = it->first;
         RN_ZONE_DATA& zoneData = it->second;
@@ -956,10 +1272,6 @@ void RN_NET::processZones()
         zoneData.m_Edges.clear();
         LSET layers = zone->GetLayerSet();
 
-        // Compute new connections
-        RN_LINKS::RN_NODE_SET candidates = m_links.GetNodes();
-        RN_LINKS::RN_NODE_SET::iterator point, pointEnd;
-
         // Sorting by area should speed up the processing, as smaller polygons are computed
         // faster and may reduce the number of points for further checks
         std::sort( zoneData.m_Polygons.begin(), zoneData.m_Polygons.end(), sortArea );
@@ -968,27 +1280,34 @@ void RN_NET::processZones()
                 polyEnd = zoneData.m_Polygons.end(); poly != polyEnd; ++poly )
         {
             const RN_NODE_PTR& node = poly->GetNode();
+            const BOX2I& bbox = poly->GetBBox();
+            unsigned int first, last;
 
-            point = candidates.begin();
-            pointEnd = candidates.end();
+            // Compute new connections, only the nodes inside the polygon bounding box
+            // may be connected
+            findNodes( bbox.GetX(), bbox.GetRight(), first, last );
 
-            while( point != pointEnd )
+            for( unsigned int i = first; i < last; ++i )
             {
-                if( *point != node && ( (*point)->GetLayers() & layers ).any()
-                        && poly->HitTest( *point ) )
+                // This point already belongs to a polygon of the zone
+                if( claimed[i] == zoneIndex )
+                    continue;
+
+                const RN_NODE_PTR& point = *candidates[i];
+
+                if( point->GetY() < bbox.GetY() || point->GetY() > bbox.GetBottom() )
+                    continue;
+
+                if( point != node && ( point->GetLayers() & layers ).any()
+                        && poly->HitTest( point ) )
                 {
-                    //(*point)->AddParent( zone );  // do not assign parent for helper links
+                    //point->AddParent( zone );  // do not assign parent for helper links
 
-                    RN_EDGE_MST_PTR connection = m_links.AddConnection( node, *point );
+                    RN_EDGE_MST_PTR connection = m_links.AddConnection( node, point );
                     zoneData.m_Edges.push_back( connection );
 
-                    // This point already belongs to a polygon, we do not need to check it anymore
-                    point = candidates.erase( point );
-                    pointEnd = candidates.end();
-                }
-                else
-                {
-                    ++point;
+                    // We do not need to check this point anymore for this zone
+                    claimed[i] = zoneIndex;
                 }
             }
         }
@@ -998,6 +1317,8 @@ void RN_NET::processZones()
 
 void RN_NET::processPads()
 {
+    const std::vector<const RN_NODE_PTR*>& candidates = m_arena.m_ByX;
+
     for( PAD_NODE_MAP::iterator it = m_pads.begin(); it != m_pads.end(); ++it )
     {
         const D_PAD* pad = it->first;
@@ -1008,25 +1329,32 @@ void RN_NET::processPads()
         BOOST_FOREACH( RN_EDGE_MST_PTR edge, edges )
             m_links.RemoveConnection( edge );
 
+        edges.clear();
+
         LSET layers = pad->GetLayerSet();
-        const RN_LINKS::RN_NODE_SET& candidates = m_links.GetNodes();
-        RN_LINKS::RN_NODE_SET::iterator point, pointEnd;
 
-        point = candidates.begin();
-        pointEnd = candidates.end();
+        // Only the nodes within the bounding radius of the pad may hit it
+        const wxPoint center = pad->ShapePos();
+        int radius = pad->GetBoundingRadius();
+        unsigned int first, last;
 
-        while( point != pointEnd )
+        findNodes( center.x - radius, center.x + radius, first, last );
+
+        for( unsigned int i = first; i < last; ++i )
         {
-            if( *point != node && ( (*point)->GetLayers() & layers ).any() &&
-                    pad->HitTest( wxPoint( (*point)->GetX(), (*point)->GetY() ) ) )
+            const RN_NODE_PTR& point = *candidates[i];
+
+            if( point->GetY() < center.y - radius || point->GetY() > center.y + radius )
+                continue;
+
+            if( point != node && ( point->GetLayers() & layers ).any() &&
+                    pad->HitTest( wxPoint( point->GetX(), point->GetY() ) ) )
             {
-                //(*point)->AddParent( pad );   // do not assign parent for helper links
+                //point->AddParent( pad );   // do not assign parent for helper links
 
-                RN_EDGE_MST_PTR connection = m_links.AddConnection( node, *point );
+                RN_EDGE_MST_PTR connection = m_links.AddConnection( node, point );
                 edges.push_back( connection );
             }
-
-            ++point;
         }
     }
 }
@@ -1218,10 +1546,181 @@ void RN_DATA::ProcessBoard()
             m_nets[netCode].AddItem( zone );
     }
 
+    computeSignatures( m_signatures );
+
     Recalculate();
 }
 
 
+void RN_DATA::ProcessNet( int aNetCode )
+{
+    unsigned int netCount = m_board->GetNetCount();
+
+    if( netCount > m_nets.size() )
+        m_nets.resize( netCount );
+
+    if( aNetCode < 1 || aNetCode >= (int) m_nets.size() )
+        return;
+
+    RN_NET& net = m_nets[aNetCode];
+    bool visible = net.IsVisible();
+    net = RN_NET();
+    net.SetVisible( visible );
+
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads().GetFirst(); pad; pad = pad->Next() )
+        {
+            if( pad->GetNetCode() == aNetCode )
+                net.AddItem( pad );
+        }
+    }
+
+    for( TRACK* track = m_board->m_Track; track; track = track->Next() )
+    {
+        if( track->GetNetCode() != aNetCode )
+            continue;
+
+        if( track->Type() == PCB_VIA_T )
+            net.AddItem( static_cast<VIA*>( track ) );
+        else if( track->Type() == PCB_TRACE_T )
+            net.AddItem( track );
+    }
+
+    for( int i = 0; i < m_board->GetAreaCount(); ++i )
+    {
+        ZONE_CONTAINER* zone = m_board->GetArea( i );
+
+        if( zone->GetNetCode() == aNetCode )
+            net.AddItem( zone );
+    }
+
+    updateNet( aNetCode );
+}
+
+
+static void hashPoint( std::size_t& aSeed, const wxPoint& aPoint )
+{
+    boost::hash_combine( aSeed, aPoint.x );
+    boost::hash_combine( aSeed, aPoint.y );
+}
+
+
+static void hashPath( std::size_t& aSeed, const SHAPE_LINE_CHAIN& aPath )
+{
+    boost::hash_combine( aSeed, aPath.PointCount() );
+
+    for( int i = 0; i < aPath.PointCount(); ++i )
+    {
+        const VECTOR2I& point = aPath.CPoint( i );
+
+        boost::hash_combine( aSeed, point.x );
+        boost::hash_combine( aSeed, point.y );
+    }
+}
+
+
+void RN_DATA::computeSignatures( std::vector<std::size_t>& aSignatures ) const
+{
+    int netCount = m_board->GetNetCount();
+    aSignatures.assign( netCount, 0 );
+
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads().GetFirst(); pad; pad = pad->Next() )
+        {
+            int netCode = pad->GetNetCode();
+
+            if( netCode <= 0 || netCode >= netCount )
+                continue;
+
+            std::size_t& seed = aSignatures[netCode];
+            const LSEQ layers = pad->GetLayerSet().Seq();
+
+            boost::hash_combine( seed, pad );
+            hashPoint( seed, pad->ShapePos() );
+            hashPoint( seed, wxPoint( pad->GetSize().x, pad->GetSize().y ) );
+            boost::hash_combine( seed, pad->GetOrientation() );
+            boost::hash_combine( seed, (int) pad->GetShape() );
+            boost::hash_combine( seed, layers.size() );
+
+            for( unsigned j = 0; j < layers.size(); ++j )
+                boost::hash_combine( seed, (int) layers[j] );
+        }
+    }
+
+    for( TRACK* track = m_board->m_Track; track; track = track->Next() )
+    {
+        int netCode = track->GetNetCode();
+
+        if( netCode <= 0 || netCode >= netCount )
+            continue;
+
+        std::size_t& seed = aSignatures[netCode];
+
+        boost::hash_combine( seed, track );
+        hashPoint( seed, track->GetStart() );
+        hashPoint( seed, track->GetEnd() );
+        boost::hash_combine( seed, track->GetWidth() );
+
+        if( track->Type() == PCB_VIA_T )
+        {
+            LAYER_ID top, bottom;
+            static_cast<const VIA*>( track )->LayerPair( &top, &bottom );
+            boost::hash_combine( seed, (int) top );
+            boost::hash_combine( seed, (int) bottom );
+        }
+        else
+        {
+            boost::hash_combine( seed, (int) track->GetLayer() );
+        }
+    }
+
+    for( int i = 0; i < m_board->GetAreaCount(); ++i )
+    {
+        const ZONE_CONTAINER* zone = m_board->GetArea( i );
+        int netCode = zone->GetNetCode();
+
+        if( netCode <= 0 || netCode >= netCount )
+            continue;
+
+        std::size_t& seed = aSignatures[netCode];
+        const SHAPE_POLY_SET& polySet = zone->GetFilledPolysList();
+
+        boost::hash_combine( seed, zone );
+        boost::hash_combine( seed, (int) zone->GetLayer() );
+
+        // Refilling a zone changes its polygons, not the zone itself
+        for( int j = 0; j < polySet.OutlineCount(); ++j )
+        {
+            hashPath( seed, polySet.COutline( j ) );
+
+            for( int k = 0; k < polySet.HoleCount( j ); ++k )
+                hashPath( seed, polySet.CHole( j, k ) );
+        }
+    }
+}
+
+
+void RN_DATA::ProcessChangedNets()
+{
+    std::vector<std::size_t> signatures;
+    computeSignatures( signatures );
+
+    if( m_signatures.size() < signatures.size() )
+        m_signatures.resize( signatures.size(), 0 );
+
+    for( unsigned i = 1; i < signatures.size(); ++i )
+    {
+        if( signatures[i] != m_signatures[i] )
+        {
+            ProcessNet( i );
+            m_signatures[i] = signatures[i];
+        }
+    }
+}
+
+
 void RN_DATA::Recalculate( int aNet )
 {
     unsigned int netCount = m_board->GetNetCount();
@@ -35,6 +35,8 @@
 
 #include <math/box2.h>
 
+#include <stdint.h>
+
 #include <boost/unordered_set.hpp>
 #include <boost/unordered_map.hpp>
 #include <boost/foreach.hpp>
@@ -284,6 +286,15 @@ public:
         return m_node;
     }
 
+    /**
+     * Function GetBBox()
+     * Returns the bounding box of the polygon.
+     */
+    inline const BOX2I& GetBBox() const
+    {
+        return m_bbox;
+    }
+
     /**
      * Function HitTest()
      * Tests if selected node is located within polygon boundaries.
@@ -545,6 +556,15 @@ public:
                             std::list<BOARD_CONNECTED_ITEM*>& aOutput,
                             RN_ITEM_TYPE aTypes = RN_ALL ) const;
 
+    /**
+     * Function GetCluster()
+     * Returns the tag of the group of connected items a pad, a via or a track belongs to.
+     * After an update, items of the net are connected if and only if they have the same tag.
+     * @param aItem is the item to be checked.
+     * @return The tag of the group, or -1 if the item is not handled by the net.
+     */
+    int GetCluster( const BOARD_CONNECTED_ITEM* aItem ) const;
+
 protected:
     ///> Validates edge, i.e. modifies source and target nodes for an edge
     ///> to make sure that they are not ones with the flag set.
@@ -561,6 +581,13 @@ protected:
     ///> Removes all ratsnest edges for a given node.
     void clearNode( const RN_NODE_PTR& aNode );
 
+    ///> Sorts the nodes by their x coordinate in m_arena, for findNodes().
+    void sortNodes();
+
+    ///> Finds the range [aFirst, aLast) of the nodes sorted by sortNodes() which have
+    ///> their x coordinate between aMinX and aMaxX.
+    void findNodes( int aMinX, int aMaxX, unsigned int& aFirst, unsigned int& aLast ) const;
+
     ///> Adds appropriate edges for nodes that are connected by zones.
     void processZones();
 
@@ -570,6 +597,136 @@ protected:
     ///> Recomputes ratsnset from scratch.
     void compute();
 
+    ///> Computes the minimum spanning tree of the nodes and the edges stored in m_arena,
+    ///> and returns its edges which are not existing connections.
+    std::vector<RN_EDGE_MST_PTR>* kruskalMST();
+
+    ///> Returns the index of a node in m_arena (the nodes are tagged with their index),
+    ///> or -1 if the node is not processed.
+    int nodeIndex( const RN_NODE_PTR& aNode ) const;
+
+    ///> Stores in m_arena an edge between two nodes of m_arena.
+    void addEdge( int aSource, int aTarget, unsigned int aWeight )
+    {
+        m_arena.m_EdgeSource.push_back( aSource );
+        m_arena.m_EdgeTarget.push_back( aTarget );
+        m_arena.m_EdgeWeight.push_back( aWeight );
+    }
+
+    ///> Triangulates all the nodes of m_arena and stores the result in m_delaunay.
+    void createDelaunay();
+
+    ///> Updates m_delaunay for the nodes of m_arena, by triangulating again only the
+    ///> neighbourhood of the nodes added or removed since the last computation.
+    ///> Returns false if too many nodes have changed, so it is not done.
+    bool updateDelaunay();
+
+    ///> Triangulates aNodes (tagged with their index in m_arena) and adds the edges
+    ///> to m_delaunay.
+    void addDelaunayEdges( std::vector<RN_NODE_PTR>& aNodes );
+
+    /**
+     * Struct RN_ARENA
+     * holds the buffers used by compute() and GetClosestNodes(). Nodes are referred to
+     * by their index in m_Nodes and edges are stored as arrays of node indexes and weights,
+     * so the algorithms walk contiguous memory. The buffers are only cleared after use,
+     * so once they are large enough, updating the net does not allocate them again.
+     */
+    struct RN_ARENA
+    {
+        ///> Nodes being processed, the index of a node is its initial tag
+        std::vector<RN_NODE_PTR> m_Nodes;
+
+        ///> Index of the source node, target node and the weight of each edge
+        std::vector<int> m_EdgeSource;
+        std::vector<int> m_EdgeTarget;
+        std::vector<unsigned int> m_EdgeWeight;
+
+        ///> Sort key (weight or distance) and index of the edges or nodes, in processing order
+        std::vector<std::pair<uint64_t, int> > m_Order;
+
+        ///> Subtree tag of each node
+        std::vector<int> m_Tags;
+
+        ///> Next node in the same subtree (-1 for the last one)
+        std::vector<int> m_NextInTree;
+
+        ///> First and last node of the subtree of a given tag
+        std::vector<int> m_TreeFirst;
+        std::vector<int> m_TreeLast;
+
+        ///> Index in m_Nodes of the nodes of the last triangulation (-1 if removed)
+        std::vector<int> m_OldToNew;
+
+        ///> Nodes to triangulate again, marked by their index in m_Nodes
+        std::vector<int> m_Marks;
+        std::vector<RN_NODE_PTR> m_LocalNodes;
+
+        ///> Nodes of the net sorted by their x coordinate, valid while the node set is
+        ///> not modified
+        std::vector<const RN_NODE_PTR*> m_ByX;
+
+        ///> Last zone which has been connected to each node of m_ByX
+        std::vector<int> m_Claimed;
+
+        void Clear()
+        {
+            m_Nodes.clear();
+            m_EdgeSource.clear();
+            m_EdgeTarget.clear();
+            m_EdgeWeight.clear();
+            m_Order.clear();
+            m_Tags.clear();
+            m_NextInTree.clear();
+            m_TreeFirst.clear();
+            m_TreeLast.clear();
+            m_OldToNew.clear();
+            m_Marks.clear();
+            m_LocalNodes.clear();
+            m_ByX.clear();
+            m_Claimed.clear();
+        }
+    };
+
+    ///> Buffers owned by the net, so nets can be updated by different threads
+    mutable RN_ARENA m_arena;
+
+    /**
+     * Struct RN_DELAUNAY
+     * keeps the nodes and the Delaunay triangulation edges of the last computation. When
+     * only a few nodes are added or removed (e.g. while dragging a footprint), the edges
+     * are reused and only the neighbourhood of the changed nodes is triangulated again.
+     * The result is a superset of the triangulation edges of the current nodes, so the
+     * spanning tree remains valid, and the triangulation is fully recomputed after a
+     * number of updates.
+     */
+    struct RN_DELAUNAY
+    {
+        RN_DELAUNAY() : m_Updates( 0 )
+        {}
+
+        ///> Triangulated nodes, sorted the same way as RN_ARENA::m_Nodes
+        std::vector<RN_NODE_PTR> m_Nodes;
+
+        ///> Index of the source and the target node of each edge
+        std::vector<int> m_EdgeSource;
+        std::vector<int> m_EdgeTarget;
+
+        ///> Number of incremental updates since the last full triangulation
+        int m_Updates;
+
+        void Clear()
+        {
+            m_Nodes.clear();
+            m_EdgeSource.clear();
+            m_EdgeTarget.clear();
+            m_Updates = 0;
+        }
+    };
+
+    ///> Triangulation of the last computation
+    RN_DELAUNAY m_delaunay;
+
     ////> Stores information about connections for a given net.
     RN_LINKS m_links;
 
@@ -696,6 +853,23 @@ public:
      */
     void ProcessBoard();
 
+    /**
+     * Function ProcessNet()
+     * Rebuilds the data of a single net from the board items and recomputes its ratsnest.
+     * It is used when the items of the net have been modified without updating the ratsnest.
+     * @param aNetCode is the net number to be processed.
+     */
+    void ProcessNet( int aNetCode );
+
+    /**
+     * Function ProcessChangedNets()
+     * Rebuilds only the nets whose items have been added, removed or modified since they
+     * were last processed, for the tools which modify items without updating the ratsnest.
+     * The changes are found by comparing a signature of the position, size, layers and net
+     * of the items of each net. The other nets keep their ratsnest data.
+     */
+    void ProcessChangedNets();
+
     /**
      * Function Recalculate()
      * Recomputes ratsnest for selected net number or all nets that need updating.
@@ -756,6 +930,15 @@ public:
      */
     bool AreConnected( const BOARD_CONNECTED_ITEM* aItem, const BOARD_CONNECTED_ITEM* aOther );
 
+    /**
+     * Function GetCluster()
+     * Returns the tag of the group of connected items a pad, a via or a track belongs to.
+     * Tags are only comparable for items of the same net.
+     * @param aItem is the item to be checked.
+     * @return The tag of the group, or -1 if the item is not handled by the ratsnest.
+     */
+    int GetCluster( const BOARD_CONNECTED_ITEM* aItem ) const;
+
     /**
      * Function GetUnconnectedCount()
      * Returns the number of missing connections.
@@ -771,11 +954,22 @@ protected:
      */
     void updateNet( int aNetCode );
 
+    /**
+     * Function computeSignatures()
+     * Computes for each net a signature of its board items, which changes when an item
+     * of the net is added, removed or modified.
+     * @param aSignatures receives the signatures, indexed by net number.
+     */
+    void computeSignatures( std::vector<std::size_t>& aSignatures ) const;
+
     ///> Board to be processed.
     const BOARD* m_board;
 
     ///> Stores information about ratsnest grouped by net numbers.
     std::vector<RN_NET> m_nets;
+
+    ///> Signatures of the items of the nets when they were last processed.
+    std::vector<std::size_t> m_signatures;
 };
 
 #endif /* RATSNEST_DATA_H */
@@ -0,0 +1,164 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2013-2015 CERN
+ * Author: Tomasz Wlostowski <tomasz.wlostowski@cern.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
+#include <algorithm>
+
+#include "pns_collision_cache.h"
+#include "pns_item.h"
+#include "pns_node.h"
+
+bool PNS_COLLISION_CACHE::HULL_KEY::operator<( const HULL_KEY& aOther ) const
+{
+    if( m_item != aOther.m_item )
+        return m_item < aOther.m_item;
+
+    if( m_clearance != aOther.m_clearance )
+        return m_clearance < aOther.m_clearance;
+
+    return m_thickness < aOther.m_thickness;
+}
+
+
+bool PNS_COLLISION_CACHE::COLLISION_KEY::operator<( const COLLISION_KEY& aOther ) const
+{
+    if( m_itemA != aOther.m_itemA )
+        return m_itemA < aOther.m_itemA;
+
+    if( m_itemB != aOther.m_itemB )
+        return m_itemB < aOther.m_itemB;
+
+    if( m_clearance != aOther.m_clearance )
+        return m_clearance < aOther.m_clearance;
+
+    return m_differentNetsOnly < aOther.m_differentNetsOnly;
+}
+
+
+PNS_COLLISION_CACHE::PNS_COLLISION_CACHE() :
+    m_world( NULL ),
+    m_hits( 0 ),
+    m_misses( 0 )
+{
+}
+
+
+bool PNS_COLLISION_CACHE::isStatic( const PNS_ITEM* aItem ) const
+{
+    return m_world && aItem->Owner() == m_world;
+}
+
+
+const SHAPE_LINE_CHAIN PNS_COLLISION_CACHE::Hull( const PNS_ITEM* aItem, int aClearance,
+                                                  int aWalkaroundThickness )
+{
+    if( !isStatic( aItem ) )
+        return aItem->Hull( aClearance, aWalkaroundThickness );
+
+    HULL_KEY key = { aItem, aClearance, aWalkaroundThickness };
+    bool found = false;
+    SHAPE_LINE_CHAIN hull;
+
+#ifdef USE_OPENMP
+    #pragma omp critical( pns_collision_cache )
+#endif
+    {
+        std::map<HULL_KEY, SHAPE_LINE_CHAIN>::const_iterator it = m_hulls.find( key );
+
+        if( it != m_hulls.end() )
+        {
+            hull = it->second;
+            m_hits++;
+            found = true;
+        }
+    }
+
+    if( found )
+        return hull;
+
+    hull = aItem->Hull( aClearance, aWalkaroundThickness );
+
+#ifdef USE_OPENMP
+    #pragma omp critical( pns_collision_cache )
+#endif
+    {
+        m_hulls[key] = hull;
+        m_misses++;
+    }
+
+    return hull;
+}
+
+
+bool PNS_COLLISION_CACHE::Collide( const PNS_ITEM* aItemA, const PNS_ITEM* aItemB,
+                                   int aClearance, bool aDifferentNetsOnly )
+{
+    if( !isStatic( aItemA ) || !isStatic( aItemB ) )
+        return aItemA->Collide( aItemB, aClearance, aDifferentNetsOnly );
+
+    // The test is symmetric, so store each pair once
+    if( aItemB < aItemA )
+        std::swap( aItemA, aItemB );
+
+    COLLISION_KEY key = { aItemA, aItemB, aClearance, aDifferentNetsOnly };
+    bool found = false;
+    bool collides = false;
+
+#ifdef USE_OPENMP
+    #pragma omp critical( pns_collision_cache )
+#endif
+    {
+        std::map<COLLISION_KEY, bool>::const_iterator it = m_collisions.find( key );
+
+        if( it != m_collisions.end() )
+        {
+            collides = it->second;
+            m_hits++;
+            found = true;
+        }
+    }
+
+    if( found )
+        return collides;
+
+    collides = aItemA->Collide( aItemB, aClearance, aDifferentNetsOnly );
+
+#ifdef USE_OPENMP
+    #pragma omp critical( pns_collision_cache )
+#endif
+    {
+        m_collisions[key] = collides;
+        m_misses++;
+    }
+
+    return collides;
+}
+
+
+void PNS_COLLISION_CACHE::Clear()
+{
+    m_hulls.clear();
+    m_collisions.clear();
+    m_hits = 0;
+    m_misses = 0;
+}
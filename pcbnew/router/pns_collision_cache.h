@@ -0,0 +1,113 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2013-2015 CERN
+ * Author: Tomasz Wlostowski <tomasz.wlostowski@cern.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_COLLISION_CACHE_H
+#define __PNS_COLLISION_CACHE_H
+
+#include <map>
+
+#include <geometry/shape_line_chain.h>
+
+class PNS_ITEM;
+class PNS_NODE;
+
+/**
+ * Class PNS_COLLISION_CACHE
+ *
+ * Keeps, for the duration of a routing session, the hulls of the static obstacles
+ * (the items stored in the root node) and the results of the collision tests
+ * between pairs of static items.  The items of the root node are modified only
+ * when a route is committed, so the cache must be cleared after each commit.
+ *
+ * Hulls are found by the item, the clearance and the walkaround thickness.  They do
+ * not depend on the layer of the query, so the layer is not a part of the key.
+ *
+ * The cache can be used by several threads walking around obstacles.
+ */
+class PNS_COLLISION_CACHE
+{
+public:
+    PNS_COLLISION_CACHE();
+
+    ///> Sets the root node, whose items are considered static.
+    void SetWorld( const PNS_NODE* aWorld )
+    {
+        m_world = aWorld;
+        Clear();
+    }
+
+    /**
+     * Function Hull()
+     *
+     * Returns the hull of aItem, as PNS_ITEM::Hull() does, from the cache
+     * if aItem is a static item.
+     */
+    const SHAPE_LINE_CHAIN Hull( const PNS_ITEM* aItem, int aClearance, int aWalkaroundThickness );
+
+    /**
+     * Function Collide()
+     *
+     * Checks for a collision between aItemA and aItemB, as PNS_ITEM::Collide() does,
+     * from the cache if both items are static.
+     */
+    bool Collide( const PNS_ITEM* aItemA, const PNS_ITEM* aItemB, int aClearance,
+                  bool aDifferentNetsOnly );
+
+    ///> Removes all the entries (to be called after the root node has been modified).
+    void Clear();
+
+    ///> Returns the number of results found in the cache since the last Clear().
+    int HitCount() const { return m_hits; }
+
+    ///> Returns the number of results computed since the last Clear().
+    int MissCount() const { return m_misses; }
+
+private:
+    struct HULL_KEY
+    {
+        const PNS_ITEM* m_item;
+        int m_clearance;
+        int m_thickness;
+
+        bool operator<( const HULL_KEY& aOther ) const;
+    };
+
+    struct COLLISION_KEY
+    {
+        const PNS_ITEM* m_itemA;
+        const PNS_ITEM* m_itemB;
+        int m_clearance;
+        bool m_differentNetsOnly;
+
+        bool operator<( const COLLISION_KEY& aOther ) const;
+    };
+
+    bool isStatic( const PNS_ITEM* aItem ) const;
+
+    const PNS_NODE* m_world;
+
+    std::map<HULL_KEY, SHAPE_LINE_CHAIN> m_hulls;
+    std::map<COLLISION_KEY, bool> m_collisions;
+
+    int m_hits;
+    int m_misses;
+};
+
+#endif
@@ -70,6 +70,21 @@ public:
      */
     void Replace( PNS_ITEM* aOldItem, PNS_ITEM* aNewItem );
 
+    /**
+     * Function BeginBulkLoad()
+     *
+     * Starts adding many items at once: the items added until EndBulkLoad() is called
+     * are stored in the R-trees in one go, and cannot be found or removed before.
+     */
+    void BeginBulkLoad();
+
+    /**
+     * Function EndBulkLoad()
+     *
+     * Stores the items added since BeginBulkLoad() in the R-trees.
+     */
+    void EndBulkLoad();
+
     /**
      * Function Query()
      *
@@ -148,19 +163,25 @@ private:
     template <class Visitor>
     int querySingle( int index, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor );
 
+    int getSubindexNumber( const PNS_ITEM* aItem ) const;
     ITEM_SHAPE_INDEX* getSubindex( const PNS_ITEM* aItem );
 
     ITEM_SHAPE_INDEX* m_subIndices[MaxSubIndices];
     std::map<int, NET_ITEMS_LIST> m_netMap;
     ITEM_SET m_allItems;
+
+    ///> items waiting for EndBulkLoad(), for each subindex
+    std::map<int, std::vector<PNS_ITEM*> > m_bulkItems;
+    bool m_bulkLoading;
 };
 
 PNS_INDEX::PNS_INDEX()
 {
     memset( m_subIndices, 0, sizeof( m_subIndices ) );
+    m_bulkLoading = false;
 }
 
-PNS_INDEX::ITEM_SHAPE_INDEX* PNS_INDEX::getSubindex( const PNS_ITEM* aItem )
+int PNS_INDEX::getSubindexNumber( const PNS_ITEM* aItem ) const
 {
     int idx_n = -1;
 
@@ -194,6 +215,14 @@ PNS_INDEX::ITEM_SHAPE_INDEX* PNS_INDEX::getSubindex( const PNS_ITEM* aItem )
 
     assert( idx_n >= 0 && idx_n < MaxSubIndices );
 
+    return idx_n;
+}
+
+
+PNS_INDEX::ITEM_SHAPE_INDEX* PNS_INDEX::getSubindex( const PNS_ITEM* aItem )
+{
+    int idx_n = getSubindexNumber( aItem );
+
     if( !m_subIndices[idx_n] )
         m_subIndices[idx_n] = new ITEM_SHAPE_INDEX;
 
@@ -202,9 +231,11 @@ PNS_INDEX::ITEM_SHAPE_INDEX* PNS_INDEX::getSubindex( const PNS_ITEM* aItem )
 
 void PNS_INDEX::Add( PNS_ITEM* aItem )
 {
-    ITEM_SHAPE_INDEX* idx = getSubindex( aItem );
+    if( m_bulkLoading )
+        m_bulkItems[getSubindexNumber( aItem )].push_back( aItem );
+    else
+        getSubindex( aItem )->Add( aItem );
 
-    idx->Add( aItem );
     m_allItems.insert( aItem );
     int net = aItem->Net();
 
@@ -216,6 +247,8 @@ void PNS_INDEX::Add( PNS_ITEM* aItem )
 
 void PNS_INDEX::Remove( PNS_ITEM* aItem )
 {
+    assert( !m_bulkLoading );
+
     ITEM_SHAPE_INDEX* idx = getSubindex( aItem );
 
     idx->Remove( aItem );
@@ -233,6 +266,37 @@ void PNS_INDEX::Replace( PNS_ITEM* aOldItem, PNS_ITEM* aNewItem )
     Add( aNewItem );
 }
 
+void PNS_INDEX::BeginBulkLoad()
+{
+    m_bulkLoading = true;
+}
+
+
+void PNS_INDEX::EndBulkLoad()
+{
+    m_bulkLoading = false;
+
+    for( std::map<int, std::vector<PNS_ITEM*> >::iterator i = m_bulkItems.begin();
+         i != m_bulkItems.end(); ++i )
+    {
+        std::vector<PNS_ITEM*>& items = i->second;
+
+        if( !m_subIndices[i->first] )
+            m_subIndices[i->first] = new ITEM_SHAPE_INDEX;
+
+        ITEM_SHAPE_INDEX* idx = m_subIndices[i->first];
+
+        // the items stored before are packed again with the new ones
+        for( ITEM_SHAPE_INDEX::Iterator iter = idx->Begin(); !iter.IsNull(); iter++ )
+            items.push_back( *iter );
+
+        idx->BulkLoad( items );
+    }
+
+    m_bulkItems.clear();
+}
+
+
 template<class Visitor>
 int PNS_INDEX::querySingle( int index, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor )
 {
@@ -18,12 +18,17 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
+
+#include <boost/foreach.hpp>
+
 #include "pns_logger.h"
 #include "pns_item.h"
 #include "pns_via.h"
 #include "pns_line.h"
 #include "pns_segment.h"
 #include "pns_solid.h"
+#include "pns_sizes_settings.h"
 
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
@@ -201,3 +206,119 @@ void PNS_LOGGER::Save( const std::string& aFilename )
     fwrite( s.c_str(), 1, s.length(), f );
     fclose( f );
 }
+
+
+PNS_COUNTERS& PNS_Counters()
+{
+    static PNS_COUNTERS counters;
+
+    return counters;
+}
+
+
+static const char* eventNames[] =
+{
+    "start", "drag", "move", "fix", "via", "layer", "stop"
+};
+
+
+const char* PNS_EVENT_LOG::TypeName( EVENT_TYPE aType )
+{
+    return eventNames[aType];
+}
+
+
+void PNS_EVENT_LOG::Add( EVENT_TYPE aType, const VECTOR2I& aP, int aLayer,
+                         const PNS_ITEM* aItem, int aMode, const PNS_SIZES_SETTINGS* aSizes )
+{
+    EVENT evt;
+
+    evt.type = aType;
+    evt.p = aP;
+    evt.layer = aLayer;
+    evt.itemKind = aItem ? aItem->Kind() : 0;
+    evt.mode = aMode;
+    evt.trackWidth = aSizes ? aSizes->TrackWidth() : 0;
+    evt.viaDiameter = aSizes ? aSizes->ViaDiameter() : 0;
+    evt.viaDrill = aSizes ? aSizes->ViaDrill() : 0;
+
+    m_events.push_back( evt );
+}
+
+
+bool PNS_EVENT_LOG::Save( const std::string& aFilename ) const
+{
+    FILE* f = fopen( aFilename.c_str(), "wb" );
+
+    if( !f )
+        return false;
+
+    if( m_hasSettings )
+    {
+        fprintf( f, "settings %d %d\n", (int) m_settings.Mode(),
+                 (int) m_settings.OptimizerEffort() );
+    }
+
+    BOOST_FOREACH( const EVENT& evt, m_events )
+    {
+        fprintf( f, "event %s %d %d %d %d %d %d %d %d\n", TypeName( evt.type ),
+                 evt.p.x, evt.p.y, evt.layer, evt.itemKind, evt.mode,
+                 evt.trackWidth, evt.viaDiameter, evt.viaDrill );
+    }
+
+    fclose( f );
+    return true;
+}
+
+
+bool PNS_EVENT_LOG::Load( const std::string& aFilename )
+{
+    FILE* f = fopen( aFilename.c_str(), "rb" );
+
+    if( !f )
+        return false;
+
+    char line[256];
+
+    Clear();
+
+    while( fgets( line, sizeof( line ), f ) )
+    {
+        char name[32];
+        EVENT evt;
+        int mode, effort;
+
+        if( sscanf( line, "settings %d %d", &mode, &effort ) == 2 )
+        {
+            m_settings.SetMode( (PNS_MODE) mode );
+            m_settings.SetOptimizerEffort( (PNS_OPTIMIZATION_EFFORT) effort );
+            m_hasSettings = true;
+            continue;
+        }
+
+        // the sizes are missing in the logs saved by older versions
+        evt.trackWidth = evt.viaDiameter = evt.viaDrill = 0;
+
+        if( sscanf( line, "event %31s %d %d %d %d %d %d %d %d", name, &evt.p.x, &evt.p.y,
+                    &evt.layer, &evt.itemKind, &evt.mode,
+                    &evt.trackWidth, &evt.viaDiameter, &evt.viaDrill ) < 6 )
+            continue;
+
+        int type;
+
+        for( type = 0; type < EVT_COUNT; type++ )
+        {
+            if( !strcmp( name, eventNames[type] ) )
+                break;
+        }
+
+        if( type == EVT_COUNT )
+            continue;
+
+        evt.type = (EVENT_TYPE) type;
+        m_events.push_back( evt );
+    }
+
+    fclose( f );
+    return true;
+}
@@ -28,7 +28,10 @@
 
 #include <math/vector2d.h>
 
+#include "pns_routing_settings.h"
+
 class PNS_ITEM;
+class PNS_SIZES_SETTINGS;
 class SHAPE_LINE_CHAIN;
 class SHAPE;
 
@@ -56,4 +59,129 @@ private:
     std::stringstream m_theLog;
 };
 
+/**
+ * Struct PNS_COUNTERS
+ *
+ * Counts the work done by the router, for the benchmarks: the branched nodes,
+ * the index queries and the collision checks of the optimizer.
+ */
+struct PNS_COUNTERS
+{
+    long m_branches;
+    long m_queries;
+    long m_optimizerIterations;
+
+    PNS_COUNTERS()
+    {
+        Clear();
+    }
+
+    void Clear()
+    {
+        m_branches = 0;
+        m_queries = 0;
+        m_optimizerIterations = 0;
+    }
+};
+
+///> Returns the global router counters.
+PNS_COUNTERS& PNS_Counters();
+
+///> Increments a router counter (the router may run walkarounds on several threads).
+inline void PNS_CountUp( long& aCounter )
+{
+#ifdef USE_OPENMP
+    #pragma omp atomic
+#endif
+    aCounter++;
+}
+
+
+/**
+ * Class PNS_EVENT_LOG
+ *
+ * Records the interactive events received by the router (routing start, mouse
+ * moves, fixing the route...), so that they can be saved and replayed without the
+ * GUI (see PNS_REPLAY).  Items are not saved: the replay finds them again with
+ * their kind, at the position and on the layer of the event.  The routing settings
+ * and the track and via sizes of the sessions are saved too, as they change the
+ * routed geometry.
+ */
+class PNS_EVENT_LOG
+{
+public:
+    enum EVENT_TYPE
+    {
+        EVT_START_ROUTE = 0,
+        EVT_START_DRAG,
+        EVT_MOVE,
+        EVT_FIX,
+        EVT_TOGGLE_VIA,
+        EVT_SWITCH_LAYER,
+        EVT_STOP,
+        EVT_COUNT
+    };
+
+    struct EVENT
+    {
+        EVENT_TYPE  type;
+        VECTOR2I    p;
+        int         layer;
+        int         itemKind;   ///> kind of the start/end item, 0 if none
+        int         mode;       ///> router mode (PNS_ROUTER_MODE), start events only
+        int         trackWidth; ///> start events only, 0 if unknown
+        int         viaDiameter;///> start events only, 0 if unknown
+        int         viaDrill;   ///> start events only, 0 if unknown
+    };
+
+    PNS_EVENT_LOG() :
+        m_hasSettings( false )
+    {
+    }
+
+    void Add( EVENT_TYPE aType, const VECTOR2I& aP = VECTOR2I( 0, 0 ), int aLayer = -1,
+              const PNS_ITEM* aItem = NULL, int aMode = 0,
+              const PNS_SIZES_SETTINGS* aSizes = NULL );
+
+    void Clear()
+    {
+        m_events.clear();
+        m_hasSettings = false;
+    }
+
+    ///> Sets the routing settings saved in the header of the log.
+    void SetSettings( const PNS_ROUTING_SETTINGS& aSettings )
+    {
+        m_settings = aSettings;
+        m_hasSettings = true;
+    }
+
+    ///> Returns true if the log has routing settings (old logs have none).
+    bool HasSettings() const
+    {
+        return m_hasSettings;
+    }
+
+    const PNS_ROUTING_SETTINGS& Settings() const
+    {
+        return m_settings;
+    }
+
+    const std::vector<EVENT>& Events() const
+    {
+        return m_events;
+    }
+
+    ///> Returns the name of an event type, as written in the saved log
+    static const char* TypeName( EVENT_TYPE aType );
+
+    bool Save( const std::string& aFilename ) const;
+    bool Load( const std::string& aFilename );
+
+private:
+    std::vector<EVENT> m_events;
+    PNS_ROUTING_SETTINGS m_settings;
+    bool m_hasSettings;
+};
+
 #endif
@@ -37,6 +37,8 @@
 #include "pns_joint.h"
 #include "pns_index.h"
 #include "pns_router.h"
+#include "pns_collision_cache.h"
+#include "pns_logger.h"
 
 using boost::unordered_set;
 using boost::unordered_map;
@@ -53,6 +55,7 @@ PNS_NODE::PNS_NODE()
     m_parent = NULL;
     m_maxClearance = 800000;    // fixme: depends on how thick traces are.
     m_clearanceFunctor = NULL;
+    m_collisionCache = NULL;
     m_index = new PNS_INDEX;
     m_collisionFilter = NULL;
 
@@ -105,6 +108,16 @@ int PNS_NODE::GetClearance( const PNS_ITEM* aA, const PNS_ITEM* aB ) const
 }
 
 
+const SHAPE_LINE_CHAIN PNS_NODE::ItemHull( const PNS_ITEM* aItem, int aClearance,
+                                           int aWalkaroundThickness ) const
+{
+    if( !m_collisionCache )
+        return aItem->Hull( aClearance, aWalkaroundThickness );
+
+    return m_collisionCache->Hull( aItem, aClearance, aWalkaroundThickness );
+}
+
+
 PNS_NODE* PNS_NODE::Branch()
 {
     PNS_NODE* child = new PNS_NODE;
@@ -112,29 +125,17 @@ PNS_NODE* PNS_NODE::Branch()
     TRACE( 0, "PNS_NODE::branch %p (parent %p)", child % this );
 
     m_children.insert( child );
+    PNS_CountUp( PNS_Counters().m_branches );
 
     child->m_depth = m_depth + 1;
     child->m_parent = this;
     child->m_clearanceFunctor = m_clearanceFunctor;
+    child->m_collisionCache = m_collisionCache;
     child->m_root = isRoot() ? this : m_root;
     child->m_collisionFilter = m_collisionFilter;
 
-    // immmediate offspring of the root branch needs not copy anything.
-    // For the rest, deep-copy joints, overridden item map and pointers
-    // to stored items.
-    if( !isRoot() )
-    {
-        JOINT_MAP::iterator j;
-
-        for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-            child->m_index->Add( *i );
-
-        child->m_joints = m_joints;
-        child->m_override = m_override;
-    }
-
-    TRACE( 2, "%d items, %d joints, %d overrides",
-            child->m_index->Size() % child->m_joints.size() % child->m_override.size() );
+    // Nothing is copied: the child stores only its own changes (added items, removed
+    // items and touched joints), and looks up everything else in its parents.
 
     return child;
 }
@@ -215,7 +216,7 @@ struct PNS_NODE::OBSTACLE_VISITOR
 
         // check if there is a more recent branch with a newer
         // (possibily modified) version of this item.
-        if( m_override && m_override->overrides( aItem ) )
+        if( m_override && m_override->overrides( aItem, m_node ) )
             return true;
 
         int clearance = m_extraClearance + m_node->GetClearance( aItem, m_item );
@@ -229,7 +230,15 @@ struct PNS_NODE::OBSTACLE_VISITOR
         if( m_forceClearance >= 0 )
             clearance = m_forceClearance;
 
-        if( !aItem->Collide( m_item, clearance, m_differentNetsOnly ) )
+        bool collides;
+
+        if( m_node->m_collisionCache )
+            collides = m_node->m_collisionCache->Collide( aItem, m_item, clearance,
+                                                          m_differentNetsOnly );
+        else
+            collides = aItem->Collide( m_item, clearance, m_differentNetsOnly );
+
+        if( !collides )
             return true;
 
         PNS_OBSTACLE obs;
@@ -257,17 +266,22 @@ int PNS_NODE::QueryColliding( const PNS_ITEM* aItem,
     assert( allocNodes.find( this ) != allocNodes.end() );
 #endif
 
+    PNS_CountUp( PNS_Counters().m_queries );
+
     visitor.SetCountLimit( aLimitCount );
     visitor.SetWorld( this, NULL );
     visitor.m_forceClearance = aForceClearance;
     // first, look for colliding items in the local index
     m_index->Query( aItem, m_maxClearance, visitor );
 
-    // if we haven't found enough items, look in the root branch as well.
-    if( !isRoot() && ( visitor.m_matchCount < aLimitCount || aLimitCount < 0 ) )
+    // if we haven't found enough items, look in the parent branches as well.
+    for( PNS_NODE* node = m_parent; node; node = node->m_parent )
     {
-        visitor.SetWorld( m_root, this );
-        m_root->m_index->Query( aItem, m_maxClearance, visitor );
+        if( visitor.m_matchCount >= aLimitCount && aLimitCount >= 0 )
+            break;
+
+        visitor.SetWorld( node, this );
+        node->m_index->Query( aItem, m_maxClearance, visitor );
     }
 
     return aObstacles.size();
@@ -317,7 +331,7 @@ PNS_NODE::OPT_OBSTACLE PNS_NODE::NearestObstacle(   const PNS_LINE* aItem,
 
         int clearance = GetClearance( obs.m_item, &aLine );
 
-        SHAPE_LINE_CHAIN hull = obs.m_item->Hull( clearance, aItem->Width() );
+        SHAPE_LINE_CHAIN hull = ItemHull( obs.m_item, clearance, aItem->Width() );
 
         if( aLine.EndsWithVia() )
         {
@@ -487,15 +501,15 @@ const PNS_ITEMSET PNS_NODE::HitTest( const VECTOR2I& aPoint ) const
 
     m_index->Query( &s, m_maxClearance, visitor );
 
-    if( !isRoot() )    // fixme: could be made cleaner
+    for( const PNS_NODE* node = m_parent; node; node = node->m_parent )
     {
-        PNS_ITEMSET items_root;
-        HIT_VISITOR  visitor_root( items_root, aPoint, m_root );
-        m_root->m_index->Query( &s, m_maxClearance, visitor_root );
+        PNS_ITEMSET items_parent;
+        HIT_VISITOR  visitor_parent( items_parent, aPoint, node );
+        node->m_index->Query( &s, m_maxClearance, visitor_parent );
 
-        BOOST_FOREACH( PNS_ITEM* item, items_root.Items() )
+        BOOST_FOREACH( PNS_ITEM* item, items_parent.Items() )
         {
-            if( !overrides( item ) )
+            if( !overrides( item, node ) )
                 items.Add( item );
         }
     }
@@ -604,18 +618,28 @@ void PNS_NODE::Add( PNS_ITEM* aItem, bool aAllowRedundant )
 }
 
 
+void PNS_NODE::AddBulk( const ITEM_VECTOR& aItems )
+{
+    m_index->BeginBulkLoad();
+
+    BOOST_FOREACH( PNS_ITEM* item, aItems )
+        Add( item );
+
+    m_index->EndBulkLoad();
+}
+
+
 void PNS_NODE::doRemove( PNS_ITEM* aItem )
 {
-    // case 1: removing an item that is stored in the root node from any branch:
+    // case 1: the item is stored in this branch, or we are the root: remove from the index
+    if( isRoot() || m_index->Contains( aItem ) )
+        m_index->Remove( aItem );
+
+    // case 2: removing an item that is stored in a parent node:
     // mark it as overridden, but do not remove
-    if( aItem->BelongsTo( m_root ) && !isRoot() )
+    else
         m_override.insert( aItem );
 
-    // case 2: the item belongs to this branch or a parent, non-root branch,
-    // or the root itself and we are the root: remove from the index
-    else if( !aItem->BelongsTo( m_root ) || isRoot() )
-        m_index->Remove( aItem );
-
     // the item belongs to this particular branch: un-reference it
     if( aItem->BelongsTo( this ) )
     {
@@ -663,6 +687,14 @@ void PNS_NODE::removeVia( PNS_VIA* aVia )
     tag.net = net;
     tag.pos = p;
 
+    // the joints may be stored in a parent node, copy them here before splitting them
+    copyJoints( tag );
+
+    // from now on this node stores all the joints of the tag, even if none is left
+    // once the via is removed (a via not connected to anything)
+    if( !isRoot() )
+        m_removedJoints.insert( tag );
+
     bool split;
     do
     {
@@ -919,10 +951,15 @@ PNS_JOINT* PNS_NODE::FindJoint( const VECTOR2I& aPos, int aLayer, int aNet )
 
     JOINT_MAP::iterator f = m_joints.find( tag ), end = m_joints.end();
 
-    if( f == end && !isRoot() )
+    // the joints of a given tag are stored by the latest node which has touched them,
+    // and are gone if that node has removed them
+    for( PNS_NODE* node = this; f == end && node->m_parent; node = node->m_parent )
     {
-        end = m_root->m_joints.end();
-        f = m_root->m_joints.find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
+        if( node->m_removedJoints.find( tag ) != node->m_removedJoints.end() )
+            return NULL;
+
+        end = node->m_parent->m_joints.end();
+        f = node->m_parent->m_joints.find( tag );
     }
 
     if( f == end )
@@ -954,23 +991,14 @@ PNS_JOINT& PNS_NODE::touchJoint( const VECTOR2I& aPos, const PNS_LAYERSET& aLaye
     tag.pos = aPos;
     tag.net = aNet;
 
-    // try to find the joint in this node.
-    JOINT_MAP::iterator f = m_joints.find( tag );
-
-    std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
-
-    // not found and we are not root? find in the root and copy results here.
-    if( f == m_joints.end() && !isRoot() )
-    {
-        range = m_root->m_joints.equal_range( tag );
-
-        for( f = range.first; f != range.second; ++f )
-            m_joints.insert( *f );
-    }
+    // not found in this node? find in the parents and copy results here.
+    copyJoints( tag );
 
     // now insert and combine overlapping joints
     PNS_JOINT jt( aPos, aLayers, aNet );
 
+    std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
+    JOINT_MAP::iterator f;
     bool merged;
 
     do
@@ -998,6 +1026,28 @@ PNS_JOINT& PNS_NODE::touchJoint( const VECTOR2I& aPos, const PNS_LAYERSET& aLaye
 }
 
 
+void PNS_NODE::copyJoints( const PNS_JOINT::HASH_TAG& aTag )
+{
+    if( m_joints.find( aTag ) != m_joints.end() )
+        return;
+
+    for( PNS_NODE* node = this; node->m_parent; node = node->m_parent )
+    {
+        if( node->m_removedJoints.find( aTag ) != node->m_removedJoints.end() )
+            return;
+
+        std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range =
+            node->m_parent->m_joints.equal_range( aTag );
+
+        if( range.first != range.second )
+        {
+            m_joints.insert( range.first, range.second );
+            return;
+        }
+    }
+}
+
+
 void PNS_JOINT::Dump() const
 {
     printf( "joint layers %d-%d, net %d, pos %s, links: %d\n", m_layers.Start(),
@@ -1107,19 +1157,46 @@ void PNS_NODE::Dump( bool aLong )
 
 void PNS_NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
 {
-    aRemoved.reserve( m_override.size() );
-    aAdded.reserve( m_index->Size() );
-
     if( isRoot() )
         return;
 
-    BOOST_FOREACH( PNS_ITEM* item, m_override )
-        aRemoved.push_back( item );
+    // root items removed by this branch or its parents
+    boost::unordered_set<PNS_ITEM*> removed;
 
-    for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-        aAdded.push_back( *i );
+    for( PNS_NODE* node = this; node != m_root; node = node->m_parent )
+    {
+        BOOST_FOREACH( PNS_ITEM* item, node->m_override )
+        {
+            if( m_root->m_index->Contains( item ) && removed.insert( item ).second )
+                aRemoved.push_back( item );
+        }
+    }
+
+    branchItems( aAdded );
 }
 
+
+void PNS_NODE::branchItems( ITEM_VECTOR& aItems )
+{
+    if( isRoot() )
+    {
+        aItems.reserve( aItems.size() + m_index->Size() );
+        aItems.insert( aItems.end(), m_index->begin(), m_index->end() );
+        return;
+    }
+
+    for( PNS_NODE* node = this; node != m_root; node = node->m_parent )
+    {
+        for( PNS_INDEX::ITEM_SET::iterator i = node->m_index->begin();
+             i != node->m_index->end(); ++i )
+        {
+            if( !overrides( *i, node ) )
+                aItems.push_back( *i );
+        }
+    }
+}
+
+
 void PNS_NODE::releaseChildren()
 {
     // copy the kids as the PNS_NODE destructor erases the item from the parent node.
@@ -1153,19 +1230,26 @@ void PNS_NODE::Commit( PNS_NODE* aNode )
     if( aNode->isRoot() )
         return;
 
-    BOOST_FOREACH( PNS_ITEM* item, aNode->m_override )
-    Remove( item );
+    ITEM_VECTOR removed, added;
 
-    for( PNS_INDEX::ITEM_SET::iterator i = aNode->m_index->begin();
-         i != aNode->m_index->end(); ++i )
+    aNode->GetUpdatedItems( removed, added );
+
+    BOOST_FOREACH( PNS_ITEM* item, removed )
+        Remove( item );
+
+    BOOST_FOREACH( PNS_ITEM* item, added )
     {
-        (*i)->SetRank( -1 );
-        (*i)->Unmark();
-        Add( *i );
+        item->SetRank( -1 );
+        item->Unmark();
+        Add( item );
     }
 
     releaseChildren();
     releaseGarbage();
+
+    // the root items have changed, so have their hulls and collisions
+    if( m_collisionCache )
+        m_collisionCache->Clear();
 }
 
 
@@ -1186,34 +1270,58 @@ void PNS_NODE::AllItemsInNet( int aNet, std::set<PNS_ITEM*>& aItems )
             aItems.insert( item );
     }
 
-    if( !isRoot() )
+    for( PNS_NODE* node = m_parent; node; node = node->m_parent )
     {
-        PNS_INDEX::NET_ITEMS_LIST* l_root = m_root->m_index->GetItemsForNet( aNet );
+        PNS_INDEX::NET_ITEMS_LIST* l_parent = node->m_index->GetItemsForNet( aNet );
 
-        if( l_root )
-            for( PNS_INDEX::NET_ITEMS_LIST::iterator i = l_root->begin(); i!= l_root->end(); ++i )
-                if( !overrides( *i ) )
+        if( l_parent )
+            for( PNS_INDEX::NET_ITEMS_LIST::iterator i = l_parent->begin(); i!= l_parent->end(); ++i )
+                if( !overrides( *i, node ) )
                     aItems.insert( *i );
     }
 }
 
 
+void PNS_NODE::AllItems( ITEM_VECTOR& aItems )
+{
+    branchItems( aItems );
+
+    if( isRoot() )
+        return;
+
+    for( PNS_INDEX::ITEM_SET::iterator i = m_root->m_index->begin();
+         i != m_root->m_index->end(); ++i )
+    {
+        if( !overrides( *i, m_root ) )
+            aItems.push_back( *i );
+    }
+}
+
+
 void PNS_NODE::ClearRanks( int aMarkerMask )
 {
-    for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    ITEM_VECTOR items;
+
+    branchItems( items );
+
+    BOOST_FOREACH( PNS_ITEM* item, items )
     {
-        (*i)->SetRank( -1 );
-        (*i)->Mark( (*i)->Marker() & (~aMarkerMask) );
+        item->SetRank( -1 );
+        item->Mark( item->Marker() & (~aMarkerMask) );
     }
 }
 
 
 int PNS_NODE::FindByMarker( int aMarker, PNS_ITEMSET& aItems )
 {
-    for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    ITEM_VECTOR items;
+
+    branchItems( items );
+
+    BOOST_FOREACH( PNS_ITEM* item, items )
     {
-        if( (*i)->Marker() & aMarker )
-            aItems.Add( *i );
+        if( item->Marker() & aMarker )
+            aItems.Add( item );
     }
 
     return 0;
@@ -1223,12 +1331,15 @@ int PNS_NODE::FindByMarker( int aMarker, PNS_ITEMSET& aItems )
 int PNS_NODE::RemoveByMarker( int aMarker )
 {
     std::list<PNS_ITEM*> garbage;
+    ITEM_VECTOR items;
 
-    for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    branchItems( items );
+
+    BOOST_FOREACH( PNS_ITEM* item, items )
     {
-        if ( (*i)->Marker() & aMarker )
+        if ( item->Marker() & aMarker )
         {
-            garbage.push_back( *i );
+            garbage.push_back( item );
         }
     }
 
@@ -1278,11 +1389,17 @@ void PNS_NODE::SetCollisionFilter( PNS_COLLISION_FILTER* aFilter )
 
 PNS_ITEM *PNS_NODE::FindItemByParent( const BOARD_CONNECTED_ITEM* aParent )
 {
-    PNS_INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aParent->GetNetCode() );
+    for( PNS_NODE* node = this; node; node = node->m_parent )
+    {
+        PNS_INDEX::NET_ITEMS_LIST* l_cur = node->m_index->GetItemsForNet( aParent->GetNetCode() );
+
+        if( !l_cur )
+            continue;
 
-    BOOST_FOREACH( PNS_ITEM*item, *l_cur )
-        if( item->Parent() == aParent )
-            return item;
+        BOOST_FOREACH( PNS_ITEM*item, *l_cur )
+            if( item->Parent() == aParent && !overrides( item, node ) )
+                return item;
+    }
 
     return NULL;
 }
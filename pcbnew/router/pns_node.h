@@ -43,6 +43,7 @@ class PNS_VIA;
 class PNS_RATSNEST;
 class PNS_INDEX;
 class PNS_ROUTER;
+class PNS_COLLISION_CACHE;
 
 /**
  * Class PNS_CLEARANCE_FUNC
@@ -162,6 +163,16 @@ public:
         m_clearanceFunctor = aFunc;
     }
 
+    ///> Assigns a cache of the hulls and collisions of the root node items
+    void SetCollisionCache( PNS_COLLISION_CACHE* aCache )
+    {
+        m_collisionCache = aCache;
+    }
+
+    ///> Returns the hull of aItem, from the collision cache if possible
+    const SHAPE_LINE_CHAIN ItemHull( const PNS_ITEM* aItem, int aClearance,
+                                     int aWalkaroundThickness ) const;
+
     ///> Returns the number of joints
     int JointCount() const
     {
@@ -264,6 +275,15 @@ public:
      */
     void Add( PNS_ITEM* aItem, bool aAllowRedundant = false );
 
+    /**
+     * Function AddBulk()
+     *
+     * Adds many items to the current node at once, storing them in the spatial index
+     * in a single pass (much faster than calling Add() for each of them).
+     * @param aItems items to add
+     */
+    void AddBulk( const ITEM_VECTOR& aItems );
+
     /**
      * Function Remove()
      *
@@ -294,8 +314,10 @@ public:
      * Function Branch()
      *
      * Creates a lightweight copy (called branch) of self that tracks
-     * the changes (added/removed items) wrs to the root. Note that if there are
-     * any branches in use, their parents must NOT be deleted.
+     * the changes (added/removed items) wrs to the root. The branch stores only
+     * its own changes and looks up the rest in its parents, so creating it does not
+     * depend on the size of the changes made by the parents. Note that if there are
+     * any branches in use, their parents must NOT be deleted (nor modified).
      * @return the new branch
      */
     PNS_NODE* Branch();
@@ -376,6 +398,9 @@ public:
 
     void AllItemsInNet( int aNet, std::set<PNS_ITEM*>& aItems );
 
+    ///> returns all items visible from this node (including the ones inherited from the root)
+    void AllItems( ITEM_VECTOR& aItems );
+
     void ClearRanks( int aMarkerMask = MK_HEAD | MK_VIOLATION );
 
     int FindByMarker( int aMarker, PNS_ITEMSET& aItems );
@@ -393,6 +418,7 @@ private:
     struct OBSTACLE_VISITOR;
     typedef boost::unordered_multimap<PNS_JOINT::HASH_TAG, PNS_JOINT> JOINT_MAP;
     typedef JOINT_MAP::value_type TagJointPair;
+    typedef boost::unordered_set<PNS_JOINT::HASH_TAG> JOINT_TAG_SET;
 
     /// nodes are not copyable
     PNS_NODE( const PNS_NODE& aB );
@@ -431,13 +457,27 @@ private:
         return m_parent == NULL;
     }
 
-    ///> checks if this branch contains an updated version of the m_item
-    ///> from the root branch.
-    bool overrides( PNS_ITEM* aItem ) const
+    ///> checks if this branch, or a branch between this one and aHolder, contains an
+    ///> updated version of the item aItem stored in the parent node aHolder.
+    bool overrides( PNS_ITEM* aItem, const PNS_NODE* aHolder ) const
     {
-        return m_override.find( aItem ) != m_override.end();
+        for( const PNS_NODE* node = this; node && node != aHolder; node = node->m_parent )
+        {
+            if( node->m_override.find( aItem ) != node->m_override.end() )
+                return true;
+        }
+
+        return false;
     }
 
+    ///> collects the items added by this branch and its non-root parents, which
+    ///> have not been removed since (all the items for the root node).
+    void branchItems( ITEM_VECTOR& aItems );
+
+    ///> copies here the joints of a given tag, from the closest parent storing them,
+    ///> unless this node already stores them or a branch on the way has removed them.
+    void copyJoints( const PNS_JOINT::HASH_TAG& aTag );
+
     PNS_SEGMENT* findRedundantSegment( PNS_SEGMENT* aSeg );
 
     ///> scans the joint map, forming a line starting from segment (current).
@@ -451,9 +491,14 @@ private:
                      bool            aStopAtLockedJoints );
 
     ///> hash table with the joints, linking the items. Joints are hashed by
-    ///> their position, layer set and net.
+    ///> their position, layer set and net. A branch stores only the joints it has
+    ///> touched, the other ones are found in its parents.
     JOINT_MAP m_joints;
 
+    ///> tags of the parents' joints that have been removed in this node, so the
+    ///> lookups must not find them in the parents.
+    JOINT_TAG_SET m_removedJoints;
+
     ///> node this node was branched from
     PNS_NODE* m_parent;
 
@@ -463,7 +508,7 @@ private:
     ///> list of nodes branched from this one
     std::set<PNS_NODE*> m_children;
 
-    ///> hash of root's items that have been changed in this node
+    ///> hash of the parents' items that have been changed in this node
     boost::unordered_set<PNS_ITEM*> m_override;
 
     ///> worst case item-item clearance
@@ -472,6 +517,9 @@ private:
     ///> Clearance resolution functor
     PNS_CLEARANCE_FUNC* m_clearanceFunctor;
 
+    ///> Cache of the hulls and collisions of the root node items (optional)
+    PNS_COLLISION_CACHE* m_collisionCache;
+
     ///> Geometric/Net index of the items
     PNS_INDEX* m_index;
 
@@ -31,6 +31,7 @@
 #include "pns_optimizer.h"
 #include "pns_utils.h"
 #include "pns_router.h"
+#include "pns_logger.h"
 
 /**
  *  Cost Estimator Methods
@@ -384,6 +385,8 @@ bool PNS_OPTIMIZER::checkColliding( PNS_ITEM* aItem, bool aUpdateCache )
 {
     CACHE_VISITOR v( aItem, m_world, m_collisionKindMask );
 
+    PNS_CountUp( PNS_Counters().m_optimizerIterations );
+
     return static_cast<bool>( m_world->CheckColliding( aItem ) );
 
     // something is wrong with the cache, need to investigate.
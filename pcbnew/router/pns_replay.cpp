@@ -0,0 +1,202 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2013-2015 CERN
+ * Author: Tomasz Wlostowski <tomasz.wlostowski@cern.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include <boost/foreach.hpp>
+
+#include <profile.h>
+#include <layers_id_colors_and_visibility.h>
+
+#include "pns_replay.h"
+#include "pns_router.h"
+#include "pns_sizes_settings.h"
+
+PNS_REPLAY::PNS_REPLAY( BOARD* aBoard ) :
+    m_board( aBoard ),
+    m_syncTime( 0.0 )
+{
+    m_router = new PNS_ROUTER;
+    m_router->SetBoard( aBoard );
+}
+
+
+PNS_REPLAY::~PNS_REPLAY()
+{
+    delete m_router;
+}
+
+
+PNS_ITEM* PNS_REPLAY::pickItem( const VECTOR2I& aP, int aLayer, int aKind ) const
+{
+    if( !aKind )
+        return NULL;
+
+    PNS_ITEMSET items = m_router->QueryHoverItems( aP );
+
+    BOOST_FOREACH( PNS_ITEM* item, items.CItems() )
+    {
+        if( item->Kind() == aKind && ( aLayer < 0 || item->Layers().Overlaps( aLayer ) ) )
+            return item;
+    }
+
+    return NULL;
+}
+
+
+int PNS_REPLAY::Run( const PNS_EVENT_LOG& aLog )
+{
+    prof_counter cnt;
+    int count = 0;
+
+    for( int i = 0; i < PNS_EVENT_LOG::EVT_COUNT; i++ )
+        m_latencies[i].clear();
+
+    PNS_Counters().Clear();
+
+    m_router->LoadSettings( m_settings );
+
+    prof_start( &cnt );
+    m_router->SyncWorld();
+    prof_end( &cnt );
+
+    m_syncTime = cnt.msecs();
+
+    BOOST_FOREACH( const PNS_EVENT_LOG::EVENT& evt, aLog.Events() )
+    {
+        bool routing = m_router->RoutingInProgress();
+
+        // events of a session which could not be started
+        if( !routing && evt.type != PNS_EVENT_LOG::EVT_START_ROUTE
+                     && evt.type != PNS_EVENT_LOG::EVT_START_DRAG )
+            continue;
+
+        PNS_ITEM* item = pickItem( evt.p, evt.layer, evt.itemKind );
+
+        prof_start( &cnt );
+
+        switch( evt.type )
+        {
+        case PNS_EVENT_LOG::EVT_START_ROUTE:
+        {
+            if( routing )
+                m_router->StopRouting();
+
+            if( evt.mode )
+                m_router->SetMode( (PNS_ROUTER_MODE) evt.mode );
+
+            PNS_SIZES_SETTINGS sizes( m_router->Sizes() );
+
+            sizes.Init( m_board, item );
+            sizes.AddLayerPair( F_Cu, B_Cu );
+
+            // the sizes used when the events were recorded, if known
+            if( evt.trackWidth > 0 )
+                sizes.SetTrackWidth( evt.trackWidth );
+
+            if( evt.viaDiameter > 0 )
+                sizes.SetViaDiameter( evt.viaDiameter );
+
+            if( evt.viaDrill > 0 )
+                sizes.SetViaDrill( evt.viaDrill );
+
+            m_router->UpdateSizes( sizes );
+            m_router->StartRouting( evt.p, item, evt.layer );
+            break;
+        }
+
+        case PNS_EVENT_LOG::EVT_START_DRAG:
+            if( routing )
+                m_router->StopRouting();
+
+            m_router->StartDragging( evt.p, item );
+            break;
+
+        case PNS_EVENT_LOG::EVT_MOVE:
+            m_router->Move( evt.p, item );
+            break;
+
+        case PNS_EVENT_LOG::EVT_FIX:
+            m_router->FixRoute( evt.p, item );
+            break;
+
+        case PNS_EVENT_LOG::EVT_TOGGLE_VIA:
+            m_router->ToggleViaPlacement();
+            break;
+
+        case PNS_EVENT_LOG::EVT_SWITCH_LAYER:
+            m_router->SwitchLayer( evt.layer );
+            break;
+
+        case PNS_EVENT_LOG::EVT_STOP:
+            m_router->StopRouting();
+            break;
+
+        default:
+            break;
+        }
+
+        prof_end( &cnt );
+
+        m_latencies[evt.type].push_back( cnt.msecs() );
+        count++;
+    }
+
+    m_router->StopRouting();
+    m_counters = PNS_Counters();
+
+    return count;
+}
+
+
+static double percentile( const std::vector<double>& aSorted, double aRank )
+{
+    if( aSorted.empty() )
+        return 0.0;
+
+    return aSorted[ (int) ( aRank * ( aSorted.size() - 1 ) + 0.5 ) ];
+}
+
+
+void PNS_REPLAY::Report( FILE* aFile ) const
+{
+    fprintf( aFile, "sync world: %.3f ms\n", m_syncTime );
+    fprintf( aFile, "%-8s %8s %10s %10s %10s %10s\n", "event", "count",
+             "p50 ms", "p90 ms", "p99 ms", "max ms" );
+
+    for( int i = 0; i < PNS_EVENT_LOG::EVT_COUNT; i++ )
+    {
+        std::vector<double> sorted( m_latencies[i] );
+
+        if( sorted.empty() )
+            continue;
+
+        std::sort( sorted.begin(), sorted.end() );
+
+        fprintf( aFile, "%-8s %8d %10.3f %10.3f %10.3f %10.3f\n",
+                 PNS_EVENT_LOG::TypeName( (PNS_EVENT_LOG::EVENT_TYPE) i ), (int) sorted.size(),
+                 percentile( sorted, 0.5 ), percentile( sorted, 0.9 ),
+                 percentile( sorted, 0.99 ), sorted.back() );
+    }
+
+    fprintf( aFile, "branches: %ld\n", m_counters.m_branches );
+    fprintf( aFile, "index queries: %ld\n", m_counters.m_queries );
+    fprintf( aFile, "optimizer iterations: %ld\n", m_counters.m_optimizerIterations );
+}
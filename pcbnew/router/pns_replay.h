@@ -0,0 +1,81 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2013-2015 CERN
+ * Author: Tomasz Wlostowski <tomasz.wlostowski@cern.ch>
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_REPLAY_H
+#define __PNS_REPLAY_H
+
+#include <cstdio>
+#include <vector>
+
+#include "pns_logger.h"
+#include "pns_routing_settings.h"
+
+class BOARD;
+class PNS_ITEM;
+class PNS_ROUTER;
+
+/**
+ * Class PNS_REPLAY
+ *
+ * Replays the events recorded by the router (PNS_ROUTER::EventLog(), saved by
+ * PNS_ROUTER::DumpLog()) on a board, without any view, and measures the latency
+ * of each event and the work done by the router (PNS_COUNTERS).
+ */
+class PNS_REPLAY
+{
+public:
+    PNS_REPLAY( BOARD* aBoard );
+    ~PNS_REPLAY();
+
+    ///> Sets the routing settings used during the replay (the defaults otherwise),
+    ///> usually the ones saved in the log (PNS_EVENT_LOG::Settings()).
+    void SetSettings( const PNS_ROUTING_SETTINGS& aSettings )
+    {
+        m_settings = aSettings;
+    }
+
+    /**
+     * Function Run()
+     *
+     * Syncs the router world with the board and replays aLog.  The start events
+     * use the track and via sizes saved in aLog, the sizes of the board otherwise.
+     * @return the number of replayed events.  The events of a session which could
+     * not be started are skipped, the events whose item cannot be found are replayed
+     * (and counted) without the item.
+     */
+    int Run( const PNS_EVENT_LOG& aLog );
+
+    ///> Prints the time of the world sync, the latency percentiles of each event
+    ///> type and the router counters.
+    void Report( FILE* aFile ) const;
+
+private:
+    PNS_ITEM* pickItem( const VECTOR2I& aP, int aLayer, int aKind ) const;
+
+    BOARD* m_board;
+    PNS_ROUTER* m_router;
+    PNS_ROUTING_SETTINGS m_settings;
+
+    double m_syncTime;
+    std::vector<double> m_latencies[PNS_EVENT_LOG::EVT_COUNT];
+    PNS_COUNTERS m_counters;
+};
+
+#endif
@@ -388,11 +388,124 @@ PNS_ITEM* PNS_ROUTER::syncVia( VIA* aVia )
 
 void PNS_ROUTER::SetBoard( BOARD* aBoard )
 {
+    // routers are kept between tool activations, the last attached one is in use
+    theRouter = this;
     m_board = aBoard;
     TRACE( 1, "m_board = %p\n", m_board );
 }
 
 
+PNS_ITEM* PNS_ROUTER::syncItem( BOARD_CONNECTED_ITEM* aItem )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:
+        return syncPad( static_cast<D_PAD*>( aItem ) );
+
+    case PCB_TRACE_T:
+        return syncTrack( static_cast<TRACK*>( aItem ) );
+
+    case PCB_VIA_T:
+        return syncVia( static_cast<VIA*>( aItem ) );
+
+    default:
+        return NULL;
+    }
+}
+
+
+void PNS_ROUTER::boardItems( std::vector<BOARD_CONNECTED_ITEM*>& aItems ) const
+{
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+            aItems.push_back( pad );
+    }
+
+    for( TRACK* t = m_board->m_Track; t; t = t->Next() )
+    {
+        KICAD_T type = t->Type();
+
+        if( type == PCB_TRACE_T || type == PCB_VIA_T )
+            aItems.push_back( t );
+    }
+}
+
+
+PNS_ROUTER::ITEM_SIGNATURE PNS_ROUTER::itemSignature( BOARD_CONNECTED_ITEM* aItem ) const
+{
+    ITEM_SIGNATURE sig;
+
+    sig.push_back( aItem->Type() );
+    sig.push_back( aItem->GetNetCode() );
+
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:
+    {
+        D_PAD* pad = static_cast<D_PAD*>( aItem );
+        LSET layers = pad->GetLayerSet();
+        int copperMask = 0;
+
+        for( int i = 0; i < MAX_CU_LAYERS; i++ )
+        {
+            if( layers[i] )
+                copperMask |= 1 << i;
+        }
+
+        sig.push_back( pad->ShapePos().x );
+        sig.push_back( pad->ShapePos().y );
+        sig.push_back( pad->GetSize().x );
+        sig.push_back( pad->GetSize().y );
+        sig.push_back( pad->GetDelta().x );
+        sig.push_back( pad->GetDelta().y );
+        sig.push_back( pad->GetOffset().x );
+        sig.push_back( pad->GetOffset().y );
+        sig.push_back( KiROUND( pad->GetOrientation() * 10.0 ) );
+        sig.push_back( pad->GetShape() );
+        sig.push_back( pad->GetAttribute() );
+        sig.push_back( copperMask );
+        break;
+    }
+
+    case PCB_TRACE_T:
+    {
+        TRACK* track = static_cast<TRACK*>( aItem );
+
+        sig.push_back( track->GetStart().x );
+        sig.push_back( track->GetStart().y );
+        sig.push_back( track->GetEnd().x );
+        sig.push_back( track->GetEnd().y );
+        sig.push_back( track->GetWidth() );
+        sig.push_back( track->GetLayer() );
+        break;
+    }
+
+    case PCB_VIA_T:
+    {
+        VIA* via = static_cast<VIA*>( aItem );
+        LAYER_ID top, bottom;
+
+        via->LayerPair( &top, &bottom );
+
+        sig.push_back( via->GetPosition().x );
+        sig.push_back( via->GetPosition().y );
+        sig.push_back( via->GetWidth() );
+        sig.push_back( via->GetDrillValue() );
+        sig.push_back( top );
+        sig.push_back( bottom );
+        sig.push_back( via->GetViaType() );
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    return sig;
+}
+
+
 void PNS_ROUTER::SyncWorld()
 {
     if( !m_board )
@@ -401,39 +514,125 @@ void PNS_ROUTER::SyncWorld()
         return;
     }
 
+    m_eventLog.Clear();
+
+    // the same board as before: only apply what has changed since
+    if( m_world && m_syncedBoard == m_board )
+    {
+        updateWorld();
+        return;
+    }
+
     ClearWorld();
 
     m_world = new PNS_NODE();
+    m_syncedBoard = m_board;
 
-    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    std::vector<BOARD_CONNECTED_ITEM*> items;
+    PNS_NODE::ITEM_VECTOR synced;
+
+    boardItems( items );
+    synced.reserve( items.size() );
+
+    BOOST_FOREACH( BOARD_CONNECTED_ITEM* item, items )
     {
-        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+        PNS_ITEM* pnsItem = syncItem( item );
+
+        m_signatures[item] = itemSignature( item );
+
+        if( pnsItem )
+            synced.push_back( pnsItem );
+    }
+
+    m_world->AddBulk( synced );
+
+    syncRules();
+}
+
+
+void PNS_ROUTER::updateWorld()
+{
+    m_world->KillChildren();
+
+    if( m_placer )
+        delete m_placer;
+
+    m_placer = NULL;
+
+    // the world items built from each board item
+    std::map<BOARD_CONNECTED_ITEM*, PNS_NODE::ITEM_VECTOR> worldItems;
+    PNS_NODE::ITEM_VECTOR all;
+
+    m_world->AllItems( all );
+
+    BOOST_FOREACH( PNS_ITEM* item, all )
+        worldItems[item->Parent()].push_back( item );
+
+    std::vector<BOARD_CONNECTED_ITEM*> items;
+    std::map<BOARD_CONNECTED_ITEM*, ITEM_SIGNATURE> signatures;
+    PNS_NODE* diff = m_world->Branch();
+    int changed = 0;
+
+    boardItems( items );
+
+    BOOST_FOREACH( BOARD_CONNECTED_ITEM* item, items )
+    {
+        ITEM_SIGNATURE& sig = signatures[item];
+        sig = itemSignature( item );
+
+        std::map<BOARD_CONNECTED_ITEM*, ITEM_SIGNATURE>::iterator prev = m_signatures.find( item );
+        std::map<BOARD_CONNECTED_ITEM*, PNS_NODE::ITEM_VECTOR>::iterator old =
+            worldItems.find( item );
+
+        if( prev == m_signatures.end() || prev->second != sig )
         {
-            PNS_ITEM* solid = syncPad( pad );
+            if( old != worldItems.end() )
+            {
+                BOOST_FOREACH( PNS_ITEM* oldItem, old->second )
+                    diff->Remove( oldItem );
+            }
+
+            PNS_ITEM* pnsItem = syncItem( item );
 
-            if( solid )
-                m_world->Add( solid );
+            if( pnsItem )
+                diff->Add( pnsItem );
+
+            changed++;
         }
+
+        if( old != worldItems.end() )
+            worldItems.erase( old );
     }
 
-    for( TRACK* t = m_board->m_Track; t; t = t->Next() )
+    // whatever is left has been removed from the board
+    for( std::map<BOARD_CONNECTED_ITEM*, PNS_NODE::ITEM_VECTOR>::iterator i = worldItems.begin();
+         i != worldItems.end(); ++i )
     {
-        KICAD_T type = t->Type();
-        PNS_ITEM* item = NULL;
+        BOOST_FOREACH( PNS_ITEM* oldItem, i->second )
+            diff->Remove( oldItem );
 
-        if( type == PCB_TRACE_T )
-            item = syncTrack( t );
-        else if( type == PCB_VIA_T )
-            item = syncVia( static_cast<VIA*>( t ) );
-
-        if( item )
-            m_world->Add( item );
+        changed++;
     }
 
+    TRACE( 1, "incremental sync: %d items changed\n", changed );
+
+    m_world->Commit( diff );
+    m_signatures.swap( signatures );
+
+    delete m_clearanceFunc;
+    syncRules();
+}
+
+
+void PNS_ROUTER::syncRules()
+{
     int worstClearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
     m_clearanceFunc = new PNS_PCBNEW_CLEARANCE_FUNC( this );
     m_world->SetClearanceFunctor( m_clearanceFunc );
     m_world->SetMaxClearance( 4 * worstClearance );
+
+    m_collisionCache.SetWorld( m_world );
+    m_world->SetCollisionCache( &m_collisionCache );
 }
 
 
@@ -448,6 +647,7 @@ PNS_ROUTER::PNS_ROUTER()
     m_placer = NULL;
     m_previewItems = NULL;
     m_board = NULL;
+    m_syncedBoard = NULL;
     m_dragger = NULL;
     m_mode = PNS_MODE_ROUTE_SINGLE;
 
@@ -514,7 +714,10 @@ void PNS_ROUTER::ClearWorld()
     if( m_previewItems )
         delete m_previewItems;
 
+    m_collisionCache.SetWorld( NULL );
+    m_signatures.clear();
     m_clearanceFunc = NULL;
+    m_syncedBoard = NULL;
     m_world = NULL;
     m_placer = NULL;
     m_previewItems = NULL;
@@ -594,6 +797,10 @@ bool PNS_ROUTER::StartDragging( const VECTOR2I& aP, PNS_ITEM* aStartItem )
     if( !aStartItem || aStartItem->OfKind( PNS_ITEM::SOLID ) )
         return false;
 
+    m_eventLog.SetSettings( m_settings );
+    m_eventLog.Add( PNS_EVENT_LOG::EVT_START_DRAG, aP, aStartItem->Layers().Start(), aStartItem,
+                    0, &m_sizes );
+
     m_dragger = new PNS_DRAGGER( this );
     m_dragger->SetWorld( m_world );
 
@@ -611,6 +818,9 @@ bool PNS_ROUTER::StartDragging( const VECTOR2I& aP, PNS_ITEM* aStartItem )
 
 bool PNS_ROUTER::StartRouting( const VECTOR2I& aP, PNS_ITEM* aStartItem, int aLayer )
 {
+    m_eventLog.SetSettings( m_settings );
+    m_eventLog.Add( PNS_EVENT_LOG::EVT_START_ROUTE, aP, aLayer, aStartItem, m_mode, &m_sizes );
+
     m_clearanceFunc->UseDpGap( false );
 
     switch( m_mode )
@@ -675,6 +885,10 @@ void PNS_ROUTER::eraseView()
 
 void PNS_ROUTER::DisplayItem( const PNS_ITEM* aItem, int aColor, int aClearance )
 {
+    // no view when the router is run without the GUI (see PNS_REPLAY)
+    if( !m_previewItems )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( aItem, m_previewItems );
 
     if( aColor >= 0 )
@@ -699,6 +913,9 @@ void PNS_ROUTER::DisplayItems( const PNS_ITEMSET& aItems )
 
 void PNS_ROUTER::DisplayDebugLine( const SHAPE_LINE_CHAIN& aLine, int aType, int aWidth )
 {
+    if( !m_previewItems )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( NULL, m_previewItems );
 
     pitem->Line( aLine, aWidth, aType );
@@ -710,6 +927,9 @@ void PNS_ROUTER::DisplayDebugLine( const SHAPE_LINE_CHAIN& aLine, int aType, int
 
 void PNS_ROUTER::DisplayDebugPoint( const VECTOR2I aPos, int aType )
 {
+    if( !m_previewItems )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( NULL, m_previewItems );
 
     pitem->Point( aPos, aType );
@@ -721,6 +941,8 @@ void PNS_ROUTER::DisplayDebugPoint( const VECTOR2I aPos, int aType )
 
 void PNS_ROUTER::Move( const VECTOR2I& aP, PNS_ITEM* endItem )
 {
+    m_eventLog.Add( PNS_EVENT_LOG::EVT_MOVE, aP, GetCurrentLayer(), endItem );
+
     m_currentEnd = aP;
 
     switch( m_state )
@@ -865,9 +1087,12 @@ void PNS_ROUTER::CommitRouting( PNS_NODE* aNode )
 
         if( parent )
         {
-            m_view->Remove( parent );
+            if( m_view )
+                m_view->Remove( parent );
+
             m_board->Remove( parent );
             m_undoBuffer.PushItem( ITEM_PICKER( parent, UR_DELETED ) );
+            m_signatures.erase( parent );
         }
     }
 
@@ -915,9 +1140,13 @@ void PNS_ROUTER::CommitRouting( PNS_NODE* aNode )
         {
             item->SetParent( newBI );
             newBI->ClearFlags();
-            m_view->Add( newBI );
+
+            if( m_view )
+                m_view->Add( newBI );
+
             m_board->Add( newBI );
             m_undoBuffer.PushItem( ITEM_PICKER( newBI, UR_NEW ) );
+            m_signatures[newBI] = itemSignature( newBI );
             newBI->ViewUpdate( KIGFX::VIEW_ITEM::GEOMETRY );
         }
     }
@@ -931,6 +1160,8 @@ bool PNS_ROUTER::FixRoute( const VECTOR2I& aP, PNS_ITEM* aEndItem )
 {
     bool rv = false;
 
+    m_eventLog.Add( PNS_EVENT_LOG::EVT_FIX, aP, GetCurrentLayer(), aEndItem );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -971,6 +1202,8 @@ void PNS_ROUTER::StopRouting()
     if( !RoutingInProgress() )
         return;
 
+    m_eventLog.Add( PNS_EVENT_LOG::EVT_STOP );
+
     if( m_placer )
         delete m_placer;
 
@@ -999,6 +1232,8 @@ void PNS_ROUTER::FlipPosture()
 
 void PNS_ROUTER::SwitchLayer( int aLayer )
 {
+    m_eventLog.Add( PNS_EVENT_LOG::EVT_SWITCH_LAYER, m_currentEnd, aLayer );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -1012,6 +1247,8 @@ void PNS_ROUTER::SwitchLayer( int aLayer )
 
 void PNS_ROUTER::ToggleViaPlacement()
 {
+    m_eventLog.Add( PNS_EVENT_LOG::EVT_TOGGLE_VIA, m_currentEnd, GetCurrentLayer() );
+
     if( m_state == ROUTE_TRACK )
     {
         bool toggle = !m_placer->IsPlacingVia();
@@ -1057,6 +1294,8 @@ void PNS_ROUTER::DumpLog()
 
     if( logger )
         logger->Save( "/tmp/shove.log" );
+
+    m_eventLog.Save( "/tmp/pns_events.log" );
 }
 
 
@@ -22,6 +22,8 @@
 #define __PNS_ROUTER_H
 
 #include <list>
+#include <map>
+#include <vector>
 
 #include <boost/optional.hpp>
 #include <boost/unordered_set.hpp>
@@ -34,9 +36,12 @@
 #include "pns_item.h"
 #include "pns_itemset.h"
 #include "pns_node.h"
+#include "pns_collision_cache.h"
+#include "pns_logger.h"
 
 class BOARD;
 class BOARD_ITEM;
+class BOARD_CONNECTED_ITEM;
 class D_PAD;
 class TRACK;
 class VIA;
@@ -133,6 +138,12 @@ public:
 
     void DumpLog();
 
+    ///> Returns the events received since the last SyncWorld()
+    const PNS_EVENT_LOG& EventLog() const
+    {
+        return m_eventLog;
+    }
+
     PNS_CLEARANCE_FUNC* GetClearanceFunc() const
     {
         return m_clearanceFunc;
@@ -235,9 +246,23 @@ private:
     PNS_ITEM* pickSingleItem( PNS_ITEMSET& aItems ) const;
     void splitAdjacentSegments( PNS_NODE* aNode, PNS_ITEM* aSeg, const VECTOR2I& aP );
 
+    ///> Board item fields the router items are built from, to find the items changed
+    ///> since the last SyncWorld()
+    typedef std::vector<int> ITEM_SIGNATURE;
+
     PNS_ITEM* syncPad( D_PAD* aPad );
     PNS_ITEM* syncTrack( TRACK* aTrack );
     PNS_ITEM* syncVia( VIA* aVia );
+    PNS_ITEM* syncItem( BOARD_CONNECTED_ITEM* aItem );
+
+    void boardItems( std::vector<BOARD_CONNECTED_ITEM*>& aItems ) const;
+    ITEM_SIGNATURE itemSignature( BOARD_CONNECTED_ITEM* aItem ) const;
+
+    ///> Applies the changes of the board since the last SyncWorld() to the existing world
+    void updateWorld();
+
+    ///> Sets up the clearances and the collision cache of a freshly synced world
+    void syncRules();
 
     void commitPad( PNS_SOLID* aPad );
     void commitSegment( PNS_SEGMENT* aTrack );
@@ -269,6 +294,16 @@ private:
     PNS_ROUTING_SETTINGS m_settings;
     PNS_PCBNEW_CLEARANCE_FUNC* m_clearanceFunc;
 
+    ///> Hulls and collisions of the static items, kept until the next commit
+    PNS_COLLISION_CACHE m_collisionCache;
+
+    ///> Board the world was synced with and the signatures of its items
+    BOARD* m_syncedBoard;
+    std::map<BOARD_CONNECTED_ITEM*, ITEM_SIGNATURE> m_signatures;
+
+    ///> Events received since the last SyncWorld(), for replaying them
+    PNS_EVENT_LOG m_eventLog;
+
     boost::unordered_set<BOARD_CONNECTED_ITEM*> m_hiddenItems;
 
     ///> Stores list of modified items in the current operation
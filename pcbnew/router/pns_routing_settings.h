@@ -133,6 +133,12 @@ public:
     void SetInlineDragEnabled ( bool aEnable ) { m_inlineDragEnabled = aEnable; }
     bool InlineDragEnabled( ) const { return m_inlineDragEnabled; }
 
+    ///> Returns true if both walkaround directions are evaluated concurrently.
+    bool ParallelWalkaround() const { return m_parallelWalkaround; }
+
+    ///> Enables/disables the concurrent evaluation of both walkaround directions.
+    void SetParallelWalkaround( bool aEnable ) { m_parallelWalkaround = aEnable; }
+
 private:
     bool m_shoveVias;
     bool m_startDiagonal;
@@ -145,6 +151,7 @@ private:
     bool m_canViolateDRC;
     bool m_freeAngleMode;
     bool m_inlineDragEnabled;
+    bool m_parallelWalkaround;
 
     PNS_MODE m_routingMode;
     PNS_OPTIMIZATION_EFFORT m_optimizerEffort;
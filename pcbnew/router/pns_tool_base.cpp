@@ -90,19 +90,31 @@ PNS_TOOL_BASE::~PNS_TOOL_BASE()
 
 void PNS_TOOL_BASE::Reset( RESET_REASON aReason )
 {
-    if( m_router )
+    BOARD* board = getModel<BOARD>();
+
+    // Re-activating the tool on the same board: keep the router's world and update it
+    // with the board changes only, instead of building it from scratch.
+    bool reuseWorld = ( aReason == RUN && m_router && board == m_board );
+
+    if( m_router && !reuseWorld )
+    {
         delete m_router;
+        m_router = NULL;
+    }
 
     if( m_gridHelper)
         delete m_gridHelper;
 
     m_frame = getEditFrame<PCB_EDIT_FRAME>();
     m_ctls = getViewControls();
-    m_board = getModel<BOARD>();
+    m_board = board;
 
-    m_router = new PNS_ROUTER;
+    if( !m_router )
+    {
+        m_router = new PNS_ROUTER;
+        m_router->ClearWorld();
+    }
 
-    m_router->ClearWorld();
     m_router->SetBoard( m_board );
     m_router->SyncWorld();
     m_router->LoadSettings( m_savedSettings );
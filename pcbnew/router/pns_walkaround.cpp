@@ -18,6 +18,10 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
 #include <boost/foreach.hpp>
 #include <boost/optional.hpp>
 
@@ -58,6 +62,10 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::singleStep( PNS_LINE& aPath,
 
     bool& prev_recursive = aWindingDirection ? m_recursiveCollision[0] : m_recursiveCollision[1];
 
+    // In the parallel mode, each direction has its own count
+    int& blockage_count = ( m_parallel && !aWindingDirection ) ? m_recursiveBlockageCount[1]
+                                                                : m_recursiveBlockageCount[0];
+
     if( !current_obs )
         return DONE;
 
@@ -67,9 +75,9 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::singleStep( PNS_LINE& aPath,
 
     if( ( current_obs->m_hull ).PointInside( last ) || ( current_obs->m_hull ).PointOnEdge( last ) )
     {
-        m_recursiveBlockageCount++;
+        blockage_count++;
 
-        if( m_recursiveBlockageCount < 3 )
+        if( blockage_count < 3 )
             aPath.Line().Append( current_obs->m_hull.NearestPoint( last ) );
         else
         {
@@ -84,12 +92,17 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::singleStep( PNS_LINE& aPath,
                       path_post[1], !aWindingDirection );
 
 #ifdef DEBUG
-    m_logger.NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", m_iteration );
-    m_logger.Log( &path_walk[0], 0, "path-walk" );
-    m_logger.Log( &path_pre[0], 1, "path-pre" );
-    m_logger.Log( &path_post[0], 4, "path-post" );
-    m_logger.Log( &current_obs->m_hull, 2, "hull" );
-    m_logger.Log( current_obs->m_item, 3, "item" );
+#ifdef USE_OPENMP
+    #pragma omp critical( pns_walkaround_log )
+#endif
+    {
+        m_logger.NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", m_iteration );
+        m_logger.Log( &path_walk[0], 0, "path-walk" );
+        m_logger.Log( &path_pre[0], 1, "path-pre" );
+        m_logger.Log( &path_post[0], 4, "path-post" );
+        m_logger.Log( &current_obs->m_hull, 2, "hull" );
+        m_logger.Log( current_obs->m_item, 3, "item" );
+    }
 #endif
 
     int len_pre = path_walk[0].Length();
@@ -140,6 +153,73 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::singleStep( PNS_LINE& aPath,
 }
 
 
+PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::walk( PNS_LINE& aPath, bool aWindingDirection )
+{
+    WALKAROUND_STATUS st = IN_PROGRESS;
+
+    for( int i = 0; i < m_iterationLimit && st == IN_PROGRESS; i++ )
+        st = singleStep( aPath, aWindingDirection );
+
+    return st;
+}
+
+
+void PNS_WALKAROUND::routeParallel( PNS_LINE& aPathCw, PNS_LINE& aPathCcw,
+                                    WALKAROUND_STATUS& aStatusCw, WALKAROUND_STATUS& aStatusCcw,
+                                    PNS_LINE& aWalkPath )
+{
+    // The walks only read the world, and each of them has its own state
+    // (path, current obstacle, recursion flags), so they can run concurrently.
+#ifdef USE_OPENMP
+    #pragma omp parallel sections num_threads( 2 )
+#endif
+    {
+#ifdef USE_OPENMP
+        #pragma omp section
+#endif
+        aStatusCw = walk( aPathCw, true );
+
+#ifdef USE_OPENMP
+        #pragma omp section
+#endif
+        aStatusCcw = walk( aPathCcw, false );
+    }
+
+    int len_cw  = aPathCw.CLine().Length();
+    int len_ccw = aPathCcw.CLine().Length();
+
+    if( m_forceLongerPath )
+    {
+        aWalkPath = ( len_cw > len_ccw ? aPathCw : aPathCcw );
+        return;
+    }
+
+    if( aStatusCw == DONE && aStatusCcw != DONE )
+    {
+        aWalkPath = aPathCw;
+        return;
+    }
+    else if( aStatusCcw == DONE && aStatusCw != DONE )
+    {
+        aWalkPath = aPathCcw;
+        return;
+    }
+
+    PNS_COST_ESTIMATOR cost_cw, cost_ccw;
+
+    cost_cw.Add( aPathCw );
+    cost_ccw.Add( aPathCcw );
+
+    // Prefer the path which is both shorter and less cornery, the shorter one otherwise
+    if( cost_cw.IsBetter( cost_ccw, 1.0, 1.0 ) )
+        aWalkPath = aPathCcw;
+    else if( cost_ccw.IsBetter( cost_cw, 1.0, 1.0 ) )
+        aWalkPath = aPathCw;
+    else
+        aWalkPath = ( len_cw < len_ccw ? aPathCw : aPathCcw );
+}
+
+
 PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::Route( const PNS_LINE& aInitialPath,
         PNS_LINE& aWalkPath, bool aOptimize )
 {
@@ -160,7 +240,7 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::Route( const PNS_LINE& aInitia
     start( aInitialPath );
 
     m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
-    m_recursiveBlockageCount = 0;
+    m_recursiveBlockageCount[0] = m_recursiveBlockageCount[1] = 0;
 
     aWalkPath = aInitialPath;
 
@@ -173,38 +253,45 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::Route( const PNS_LINE& aInitia
         m_forceSingleDirection = false;
     }
 
-    while( m_iteration < m_iterationLimit )
+    if( m_parallel && !m_forceWinding )
     {
-        if( s_cw != STUCK )
-            s_cw = singleStep( path_cw, true );
+        routeParallel( path_cw, path_ccw, s_cw, s_ccw, aWalkPath );
+    }
+    else
+    {
+        while( m_iteration < m_iterationLimit )
+        {
+            if( s_cw != STUCK )
+                s_cw = singleStep( path_cw, true );
 
-        if( s_ccw != STUCK )
-            s_ccw = singleStep( path_ccw, false );
+            if( s_ccw != STUCK )
+                s_ccw = singleStep( path_ccw, false );
 
-        if( ( s_cw == DONE && s_ccw == DONE ) || ( s_cw == STUCK && s_ccw == STUCK ) )
-        {
-            int len_cw  = path_cw.CLine().Length();
-            int len_ccw = path_ccw.CLine().Length();
+            if( ( s_cw == DONE && s_ccw == DONE ) || ( s_cw == STUCK && s_ccw == STUCK ) )
+            {
+                int len_cw  = path_cw.CLine().Length();
+                int len_ccw = path_ccw.CLine().Length();
 
-            if( m_forceLongerPath )
-                aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
-            else
-                aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
+                if( m_forceLongerPath )
+                    aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
+                else
+                    aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
 
-            break;
-        }
-        else if( s_cw == DONE && !m_forceLongerPath )
-        {
-            aWalkPath = path_cw;
-            break;
-        }
-        else if( s_ccw == DONE && !m_forceLongerPath )
-        {
-            aWalkPath = path_ccw;
-            break;
-        }
+                break;
+            }
+            else if( s_cw == DONE && !m_forceLongerPath )
+            {
+                aWalkPath = path_cw;
+                break;
+            }
+            else if( s_ccw == DONE && !m_forceLongerPath )
+            {
+                aWalkPath = path_ccw;
+                break;
+            }
 
-        m_iteration++;
+            m_iteration++;
+        }
     }
 
     if( m_iteration == m_iterationLimit )
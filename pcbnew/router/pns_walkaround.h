@@ -46,10 +46,11 @@ public:
         m_itemMask = PNS_ITEM::ANY;
 
         // Initialize other members, to avoid uninitialized variables.
-        m_recursiveBlockageCount = 0;
+        m_recursiveBlockageCount[0] = m_recursiveBlockageCount[1] = 0;
         m_recursiveCollision[0] = m_recursiveCollision[1] = false;
         m_iteration = 0;
         m_forceCw = false;
+        m_parallel = false;
     }
 
     ~PNS_WALKAROUND() {};
@@ -107,6 +108,18 @@ public:
         m_forceWinding = aEnabled;
     }
 
+    /**
+     * Function SetParallel()
+     *
+     * Enables the concurrent evaluation of the clockwise and counter-clockwise walks.
+     * Each direction then runs up to the iteration limit (instead of stopping when the
+     * other one is done), and the best path is picked by its cost.
+     */
+    void SetParallel( bool aParallel )
+    {
+        m_parallel = aParallel;
+    }
+
     void RestrictToSet( bool aEnabled, const std::set<PNS_ITEM*>& aSet )
     {
         if( aEnabled )
@@ -127,11 +140,15 @@ private:
     void start( const PNS_LINE& aInitialPath );
 
     WALKAROUND_STATUS singleStep( PNS_LINE& aPath, bool aWindingDirection );
+    WALKAROUND_STATUS walk( PNS_LINE& aPath, bool aWindingDirection );
+    void routeParallel( PNS_LINE& aPathCw, PNS_LINE& aPathCcw, WALKAROUND_STATUS& aStatusCw,
+                        WALKAROUND_STATUS& aStatusCcw, PNS_LINE& aWalkPath );
     PNS_NODE::OPT_OBSTACLE nearestObstacle( const PNS_LINE& aPath );
 
     PNS_NODE* m_world;
 
-    int m_recursiveBlockageCount;
+    ///> Blockage count, for each direction in the parallel mode (shared otherwise)
+    int m_recursiveBlockageCount[2];
     int m_iteration;
     int m_iterationLimit;
     int m_itemMask;
@@ -139,6 +156,7 @@ private:
     bool m_cursorApproachMode;
     bool m_forceWinding;
     bool m_forceCw;
+    bool m_parallel;
     VECTOR2I m_cursorPos;
     PNS_NODE::OPT_OBSTACLE m_currentObstacle[2];
     bool m_recursiveCollision[2];
@@ -37,6 +37,8 @@
 #include <kicad_string.h>
 #include <io_mgr.h>
 #include <macros.h>
+#include <drc_stuff.h>
+#include <router/pns_replay.h>
 #include <stdlib.h>
 
 static PCB_EDIT_FRAME* PcbEditFrame = NULL;
@@ -107,3 +109,49 @@ bool SaveBoard( wxString& aFileName, BOARD* aBoard,
 #endif
     return true;
 }
+
+
+int RunDRC( BOARD* aBoard, wxString& aReportFileName )
+{
+    DRC drc( aBoard );
+
+    // Like the DRC dialog, remove the markers of a previous run, so the report and the
+    // returned count only have the errors found by this run
+    aBoard->DeleteMARKERs();
+
+    drc.RunTests();
+
+    FILE* fp = wxFopen( aReportFileName, wxT( "w" ) );
+
+    if( fp == NULL )
+        return -1;
+
+    if( aReportFileName.EndsWith( wxT( ".json" ) ) )
+        drc.WriteJsonReport( fp );
+    else
+        drc.WriteCsvReport( fp );
+
+    fclose( fp );
+
+    return aBoard->GetMARKERCount() + drc.GetUnconnectedCount();
+}
+
+
+int ReplayRouterEvents( BOARD* aBoard, wxString& aEventFileName )
+{
+    PNS_EVENT_LOG log;
+
+    if( !log.Load( std::string( TO_UTF8( aEventFileName ) ) ) )
+        return -1;
+
+    PNS_REPLAY replay( aBoard );
+
+    if( log.HasSettings() )
+        replay.SetSettings( log.Settings() );
+
+    int count = replay.Run( log );
+
+    replay.Report( stdout );
+
+    return count;
+}
@@ -43,5 +43,25 @@ BOARD*  LoadBoard( wxString& aFileName );
 bool    SaveBoard( wxString& aFileName, BOARD* aBoard, IO_MGR::PCB_FILE_T aFormat );
 bool    SaveBoard( wxString& aFileName, BOARD* aBoard );
 
+/**
+ * Function RunDRC
+ * runs all the DRC tests on aBoard without any window, after removing its markers,
+ * and writes the found errors and the wall time of each test phase to aReportFileName:
+ * as JSON if its extension is .json, as CSV otherwise.
+ * @return the number of errors found by this run (new markers and unconnected items),
+ *         or -1 if the report file cannot be created.
+ */
+int     RunDRC( BOARD* aBoard, wxString& aReportFileName );
+
+/**
+ * Function ReplayRouterEvents
+ * replays on aBoard, without any window, the interactive router events saved in
+ * aEventFileName (by the router "dump log" command, /tmp/pns_events.log) with the
+ * routing settings and sizes saved in it, and prints the latency percentiles of each
+ * event type and the work done by the router.
+ * @return the number of replayed events, or -1 if the event file cannot be read.
+ */
+int     ReplayRouterEvents( BOARD* aBoard, wxString& aEventFileName );
+
 
 #endif
@@ -255,6 +255,8 @@ int POINT_EDITOR::OnSelectionChange( const TOOL_EVENT& aEvent )
         if( !m_editPoints )
             return 0;
 
+        m_originalArea = item->GetBoundingBox();
+
         view->Add( m_editPoints.get() );
         m_editedPoint = NULL;
         bool modified = false;
@@ -539,7 +541,17 @@ void POINT_EDITOR::finishItem() const
         ZONE_CONTAINER* zone = static_cast<ZONE_CONTAINER*>( item );
 
         if( zone->IsFilled() )
-            getEditFrame<PCB_EDIT_FRAME>()->Fill_Zone( zone );
+        {
+            PCB_EDIT_FRAME* frame = getEditFrame<PCB_EDIT_FRAME>();
+
+            // The old and the new outlines can knock out the other filled zones too
+            std::vector<EDA_RECT> dirtyAreas;
+            dirtyAreas.push_back( m_originalArea );
+            dirtyAreas.push_back( zone->GetBoundingBox() );
+
+            frame->Fill_Zones_In_Areas( dirtyAreas, true );
+            frame->SetMsgPanel( zone );
+        }
     }
 }
 
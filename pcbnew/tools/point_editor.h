@@ -68,6 +68,9 @@ private:
     ///> Original position for the current drag point.
     EDIT_POINT m_original;
 
+    ///> Bounding box of the edited item before it was modified.
+    EDA_RECT m_originalArea;
+
     ///> Currently available edit points.
     boost::shared_ptr<EDIT_POINTS> m_editPoints;
 
@@ -0,0 +1,190 @@
+/**
+ * @file zone_clearance_cache.cpp
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <fctsys.h>
+#include <boost/unordered_set.hpp>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+
+#include <zone_clearance_cache.h>
+
+
+bool ZONE_CLEARANCE_CACHE::KEY::operator<( const KEY& aOther ) const
+{
+    if( m_Item != aOther.m_Item )
+        return m_Item < aOther.m_Item;
+
+    if( m_Clearance != aOther.m_Clearance )
+        return m_Clearance < aOther.m_Clearance;
+
+    return m_Segments < aOther.m_Segments;
+}
+
+
+bool ZONE_CLEARANCE_CACHE::SIGNATURE::operator==( const SIGNATURE& aOther ) const
+{
+    return m_Type == aOther.m_Type
+        && m_Start == aOther.m_Start
+        && m_End == aOther.m_End
+        && m_Size == aOther.m_Size
+        && m_Delta == aOther.m_Delta
+        && m_Orientation == aOther.m_Orientation
+        && m_Shape == aOther.m_Shape;
+}
+
+
+ZONE_CLEARANCE_CACHE::ZONE_CLEARANCE_CACHE()
+{
+    m_hits = 0;
+    m_misses = 0;
+}
+
+
+void ZONE_CLEARANCE_CACHE::AddPadShape( SHAPE_POLY_SET& aBuffer, const D_PAD* aPad,
+                                        int aClearance, int aCircleToSegmentsCount,
+                                        double aCorrectionFactor )
+{
+    KEY key = { aPad, aClearance, aCircleToSegmentsCount };
+
+    SIGNATURE signature;
+    signature.m_Type        = aPad->Type();
+    signature.m_Start       = aPad->ShapePos();
+    signature.m_End         = aPad->GetPosition();
+    signature.m_Size        = aPad->GetSize();
+    signature.m_Delta       = aPad->GetDelta();
+    signature.m_Orientation = aPad->GetOrientation();
+    signature.m_Shape       = aPad->GetShape();
+
+    if( find( key, signature, aBuffer ) )
+        return;
+
+    SHAPE_POLY_SET polygon;
+    aPad->TransformShapeWithClearanceToPolygon( polygon, aClearance,
+                                                aCircleToSegmentsCount, aCorrectionFactor );
+
+    store( key, signature, polygon, aBuffer );
+}
+
+
+void ZONE_CLEARANCE_CACHE::AddTrackShape( SHAPE_POLY_SET& aBuffer, const TRACK* aTrack,
+                                          int aClearance, int aCircleToSegmentsCount,
+                                          double aCorrectionFactor )
+{
+    KEY key = { aTrack, aClearance, aCircleToSegmentsCount };
+
+    SIGNATURE signature;
+    signature.m_Type        = aTrack->Type();
+    signature.m_Start       = aTrack->GetStart();
+    signature.m_End         = aTrack->GetEnd();
+    signature.m_Size        = wxSize( aTrack->GetWidth(), aTrack->GetWidth() );
+    signature.m_Delta       = wxSize( 0, 0 );
+    signature.m_Orientation = 0.0;
+    signature.m_Shape       = 0;
+
+    if( find( key, signature, aBuffer ) )
+        return;
+
+    SHAPE_POLY_SET polygon;
+    aTrack->TransformShapeWithClearanceToPolygon( polygon, aClearance,
+                                                  aCircleToSegmentsCount, aCorrectionFactor );
+
+    store( key, signature, polygon, aBuffer );
+}
+
+
+bool ZONE_CLEARANCE_CACHE::find( const KEY& aKey, const SIGNATURE& aSignature,
+                                 SHAPE_POLY_SET& aBuffer )
+{
+    bool found = false;
+
+#ifdef USE_OPENMP
+    #pragma omp critical( zone_clearance_cache )
+#endif
+    {
+        ENTRIES::const_iterator it = m_entries.find( aKey );
+
+        if( it != m_entries.end() && it->second.m_Signature == aSignature )
+        {
+            aBuffer.Append( it->second.m_Polygon );
+            m_hits++;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+
+void ZONE_CLEARANCE_CACHE::store( const KEY& aKey, const SIGNATURE& aSignature,
+                                  const SHAPE_POLY_SET& aPolygon, SHAPE_POLY_SET& aBuffer )
+{
+    aBuffer.Append( aPolygon );
+
+#ifdef USE_OPENMP
+    #pragma omp critical( zone_clearance_cache )
+#endif
+    {
+        ENTRY& entry = m_entries[aKey];
+        entry.m_Signature = aSignature;
+        entry.m_Polygon = aPolygon;
+        m_misses++;
+    }
+}
+
+
+void ZONE_CLEARANCE_CACHE::Prune( BOARD* aBoard )
+{
+    boost::unordered_set<const BOARD_ITEM*> items;
+
+    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+            items.insert( pad );
+    }
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+        items.insert( track );
+
+    for( ENTRIES::iterator it = m_entries.begin(); it != m_entries.end(); )
+    {
+        if( items.count( it->first.m_Item ) )
+            ++it;
+        else
+            m_entries.erase( it++ );
+    }
+}
+
+
+void ZONE_CLEARANCE_CACHE::Clear()
+{
+    m_entries.clear();
+    m_hits = 0;
+    m_misses = 0;
+}
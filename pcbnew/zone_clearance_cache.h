@@ -0,0 +1,147 @@
+/**
+ * @file zone_clearance_cache.h
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef _ZONE_CLEARANCE_CACHE_H
+#define _ZONE_CLEARANCE_CACHE_H
+
+#include <map>
+
+#include <wx/gdicmn.h>
+#include <geometry/shape_poly_set.h>
+
+class BOARD;
+class BOARD_ITEM;
+class D_PAD;
+class TRACK;
+
+
+/**
+ * Class ZONE_CLEARANCE_CACHE
+ * keeps the polygons of the pads and the tracks inflated by a clearance, as built by
+ * TransformShapeWithClearanceToPolygon() for the zone holes, so that they are not
+ * built again for each zone, and each time the zones are filled.
+ *
+ * An entry is found by the item, the clearance and the number of segments per circle.
+ * It also stores a signature of the item shape (position, size, orientation ...): when
+ * the item is modified, the signature does not match anymore and the polygon is built
+ * again.  The shape does not depend on the layer of the zone, so the layer is not part
+ * of the key.
+ *
+ * The cache can be used by several threads filling zones.
+ */
+class ZONE_CLEARANCE_CACHE
+{
+public:
+    ZONE_CLEARANCE_CACHE();
+
+    /**
+     * Function AddPadShape
+     * appends to aBuffer the polygon of aPad inflated by aClearance, from the cache if
+     * possible.  Parameters are the same as D_PAD::TransformShapeWithClearanceToPolygon().
+     */
+    void AddPadShape( SHAPE_POLY_SET& aBuffer, const D_PAD* aPad, int aClearance,
+                      int aCircleToSegmentsCount, double aCorrectionFactor );
+
+    /**
+     * Function AddTrackShape
+     * appends to aBuffer the polygon of aTrack inflated by aClearance, from the cache if
+     * possible.  Parameters are the same as TRACK::TransformShapeWithClearanceToPolygon().
+     */
+    void AddTrackShape( SHAPE_POLY_SET& aBuffer, const TRACK* aTrack, int aClearance,
+                        int aCircleToSegmentsCount, double aCorrectionFactor );
+
+    /**
+     * Function Prune
+     * removes the entries of the items which are not on aBoard anymore.
+     */
+    void Prune( BOARD* aBoard );
+
+    /**
+     * Function Clear
+     * removes all the entries.
+     */
+    void Clear();
+
+    /// @return the number of polygons found in the cache since the last Clear().
+    int GetHitCount() const { return m_hits; }
+
+    /// @return the number of polygons built since the last Clear().
+    int GetMissCount() const { return m_misses; }
+
+private:
+    struct KEY
+    {
+        const BOARD_ITEM*   m_Item;
+        int                 m_Clearance;
+        int                 m_Segments;
+
+        bool operator<( const KEY& aOther ) const;
+    };
+
+    ///> What the polygon of an item depends on, besides the clearance
+    struct SIGNATURE
+    {
+        int         m_Type;
+        wxPoint     m_Start;
+        wxPoint     m_End;
+        wxSize      m_Size;
+        wxSize      m_Delta;
+        double      m_Orientation;
+        int         m_Shape;
+
+        bool operator==( const SIGNATURE& aOther ) const;
+    };
+
+    struct ENTRY
+    {
+        SIGNATURE       m_Signature;
+        SHAPE_POLY_SET  m_Polygon;
+    };
+
+    typedef std::map<KEY, ENTRY> ENTRIES;
+
+    /**
+     * Function find
+     * appends to aBuffer the polygon of the entry aKey if it exists and has the
+     * signature aSignature.
+     * @return true if found.
+     */
+    bool find( const KEY& aKey, const SIGNATURE& aSignature, SHAPE_POLY_SET& aBuffer );
+
+    /**
+     * Function store
+     * stores aPolygon as the entry aKey, and appends it to aBuffer.
+     */
+    void store( const KEY& aKey, const SIGNATURE& aSignature, const SHAPE_POLY_SET& aPolygon,
+                SHAPE_POLY_SET& aBuffer );
+
+    ENTRIES     m_entries;
+    int         m_hits;
+    int         m_misses;
+};
+
+#endif  // _ZONE_CLEARANCE_CACHE_H
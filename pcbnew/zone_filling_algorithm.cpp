@@ -33,10 +33,14 @@
 #include <trigo.h>
 #include <wxPcbStruct.h>
 
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
 #include <class_zone.h>
 
 #include <pcbnew.h>
 #include <zones.h>
+#include <zone_obstacles_index.h>
 
 /* Build the filled solid areas data from real outlines (stored in m_Poly)
  * The solid areas can be more than one on copper layers, and do not have holes
@@ -54,7 +58,8 @@
  * to add holes for pads and tracks and other items not in net.
  */
 
-bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET* aOutlineBuffer )
+bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET* aOutlineBuffer,
+                                                    const ZONE_OBSTACLES_INDEX* aObstacles )
 {
     /* convert outlines + holes to outlines without holes (adding extra segments if necessary)
      * m_Poly data is expected normalized, i.e. NormalizeAreaOutlines was used after building
@@ -65,31 +70,8 @@ bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET*
         return 0;
 
     // Make a smoothed polygon out of the user-drawn polygon if required
-    if( m_smoothedPoly )
-    {
-        delete m_smoothedPoly;
-        m_smoothedPoly = NULL;
-    }
-
-    switch( m_cornerSmoothingType )
-    {
-    case ZONE_SETTINGS::SMOOTHING_CHAMFER:
-        m_smoothedPoly = m_Poly->Chamfer( m_cornerRadius );
-        break;
-
-    case ZONE_SETTINGS::SMOOTHING_FILLET:
-        m_smoothedPoly = m_Poly->Fillet( m_cornerRadius, m_ArcToSegmentsCount );
-        break;
-
-    default:
-        // Acute angles between adjacent edges can create issues in calculations,
-        // in inflate/deflate outlines transforms, especially when the angle is very small.
-        // We can avoid issues by creating a very small chamfer which remove acute angles,
-        // or left it without chamfer and use only CPOLYGONS_LIST::InflateOutline to create
-        // clearance areas
-        m_smoothedPoly = m_Poly->Chamfer( Millimeter2iu( 0.0 ) );
-        break;
-    }
+    delete m_smoothedPoly;
+    m_smoothedPoly = BuildSmoothedPoly();
 
     if( aOutlineBuffer )
         aOutlineBuffer->Append( ConvertPolyListToPolySet( m_smoothedPoly->m_CornersList ) );
@@ -105,7 +87,7 @@ bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET*
 
         if( IsOnCopperLayer() )
         {
-            AddClearanceAreasPolygonsToPolysList_NG( aPcb );
+            AddClearanceAreasPolygonsToPolysList_NG( aPcb, aObstacles );
         }
         else
         {
@@ -125,6 +107,106 @@ bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET*
 }
 
 
+CPolyLine* ZONE_CONTAINER::BuildSmoothedPoly() const
+{
+    switch( m_cornerSmoothingType )
+    {
+    case ZONE_SETTINGS::SMOOTHING_CHAMFER:
+        return m_Poly->Chamfer( m_cornerRadius );
+
+    case ZONE_SETTINGS::SMOOTHING_FILLET:
+        return m_Poly->Fillet( m_cornerRadius, m_ArcToSegmentsCount );
+
+    default:
+        // Acute angles between adjacent edges can create issues in calculations,
+        // in inflate/deflate outlines transforms, especially when the angle is very small.
+        // We can avoid issues by creating a very small chamfer which remove acute angles,
+        // or left it without chamfer and use only CPOLYGONS_LIST::InflateOutline to create
+        // clearance areas
+        return m_Poly->Chamfer( Millimeter2iu( 0.0 ) );
+    }
+}
+
+
+void FillZones( BOARD* aPcb, const std::vector<ZONE_CONTAINER*>& aZones,
+                const ZONE_OBSTACLES_INDEX* aObstacles )
+{
+    // Index the items once, for all the zones
+    ZONE_OBSTACLES_INDEX obstacles;
+
+    if( !aObstacles )
+    {
+        obstacles.Build( aPcb );
+        aObstacles = &obstacles;
+    }
+
+    // Pads cache their bounding radius on first use: compute it now,
+    // before the pads are shared between threads
+    for( MODULE* module = aPcb->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+            pad->GetBoundingRadius();
+    }
+
+    int zoneCount = aZones.size();
+    int ii;
+
+    // Each zone only writes its own filled areas, and only reads the outlines of the
+    // other zones, so zones can be filled in any order.
+    // The zone dump (debug option) writes to a single file, so it is not threaded.
+#ifdef USE_OPENMP
+    #pragma omp parallel for private(ii) schedule(dynamic, 1) if( !g_DumpZonesWhenFilling )
+#endif
+    for( ii = 0; ii < zoneCount; ii++ )
+    {
+        ZONE_CONTAINER* zone = aZones[ii];
+
+        zone->ClearFilledPolysList();
+        zone->UnFill();
+
+        // Cannot fill keepout zones:
+        if( zone->GetIsKeepout() )
+            continue;
+
+        zone->BuildFilledSolidAreasPolygons( aPcb, NULL, aObstacles );
+    }
+}
+
+
+void FindZonesToRefill( BOARD* aPcb, const std::vector<EDA_RECT>& aDirtyAreas,
+                        const ZONE_OBSTACLES_INDEX& aObstacles,
+                        std::vector<ZONE_CONTAINER*>& aZones )
+{
+    aZones.clear();
+
+    for( int ii = 0; ii < aPcb->GetAreaCount(); ii++ )
+    {
+        ZONE_CONTAINER* zone = aPcb->GetArea( ii );
+
+        if( zone->GetIsKeepout() )
+            continue;
+
+        // An item modifies the filled areas if its clearance or thermal gap reaches
+        // the zone outline, taking into account the zone clearance and thermal gap,
+        // and the thickness of the outline
+        int margin = aObstacles.GetMaxMargin() + zone->GetClearance()
+                     + zone->GetThermalReliefGap() + zone->GetMinThickness() + 1;
+
+        EDA_RECT zoneArea = zone->GetBoundingBox();
+        zoneArea.Inflate( margin );
+
+        for( unsigned jj = 0; jj < aDirtyAreas.size(); jj++ )
+        {
+            if( zoneArea.Intersects( aDirtyAreas[jj] ) )
+            {
+                aZones.push_back( zone );
+                break;
+            }
+        }
+    }
+}
+
+
 // Sort function to build filled zones
 static bool SortByXValues( const int& a, const int &b )
 {
@@ -0,0 +1,249 @@
+/**
+ * @file zone_obstacles_index.cpp
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <fctsys.h>
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_edge_mod.h>
+#include <class_zone.h>
+
+#include <zone_obstacles_index.h>
+
+
+/**
+ * Visitor used with RTree::Search(): stores every ordinal it is given.
+ */
+struct OBSTACLE_COLLECTOR
+{
+    OBSTACLE_COLLECTOR( std::vector<int>& aFound ) :
+        m_found( aFound )
+    {
+    }
+
+    bool operator()( int aOrdinal )
+    {
+        m_found.push_back( aOrdinal );
+        return true;
+    }
+
+    std::vector<int>& m_found;
+};
+
+
+ZONE_OBSTACLES_INDEX::ZONE_OBSTACLES_INDEX()
+{
+    for( int layer = 0; layer < LAYER_ID_COUNT; ++layer )
+        m_trees[layer] = NULL;
+
+    m_maxMargin = 0;
+    m_clearanceCache = NULL;
+}
+
+
+ZONE_OBSTACLES_INDEX::~ZONE_OBSTACLES_INDEX()
+{
+    for( int layer = 0; layer < LAYER_ID_COUNT; ++layer )
+        delete m_trees[layer];
+}
+
+
+void ZONE_OBSTACLES_INDEX::Clear()
+{
+    for( int layer = 0; layer < LAYER_ID_COUNT; ++layer )
+    {
+        delete m_trees[layer];
+        m_trees[layer] = NULL;
+    }
+
+    m_pads.clear();
+    m_tracks.clear();
+    m_moduleEdges.clear();
+    m_drawings.clear();
+    m_zones.clear();
+    m_maxMargin = 0;
+}
+
+
+void ZONE_OBSTACLES_INDEX::Build( BOARD* aBoard )
+{
+    Clear();
+
+    const LSET all_cu = LSET::AllCuMask();
+
+    // Pads: the copper shape on the pad layers, and the hole on all copper layers
+    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+        {
+            int ordinal = m_pads.size();
+            m_pads.push_back( pad );
+
+            LSET layers = pad->GetLayerSet() & all_cu;
+            EDA_RECT bbox = pad->GetBoundingBox();
+
+            const wxSize& drill = pad->GetDrillSize();
+
+            if( drill.x || drill.y )
+            {
+                EDA_RECT hole( pad->GetPosition(), wxSize( 0, 0 ) );
+                hole.Inflate( ( std::max( drill.x, drill.y ) + 1 ) / 2 );
+                bbox.Merge( hole );
+                layers = all_cu;
+            }
+
+            m_maxMargin = std::max( m_maxMargin, pad->GetClearance() );
+            m_maxMargin = std::max( m_maxMargin, pad->GetThermalGap() );
+
+            insert( ordinal, bbox, layers );
+        }
+    }
+
+    int first = m_pads.size();
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        int ordinal = first + m_tracks.size();
+        m_tracks.push_back( track );
+
+        m_maxMargin = std::max( m_maxMargin, track->GetClearance() );
+        insert( ordinal, track->GetBoundingBox(), track->GetLayerSet() & all_cu );
+    }
+
+    first += m_tracks.size();
+
+    for( MODULE* module = aBoard->m_Modules; module; module = module->Next() )
+    {
+        for( BOARD_ITEM* item = module->GraphicalItems(); item; item = item->Next() )
+        {
+            if( item->Type() != PCB_MODULE_EDGE_T )
+                continue;
+
+            int ordinal = first + m_moduleEdges.size();
+            m_moduleEdges.push_back( (EDGE_MODULE*) item );
+
+            insert( ordinal, item->GetBoundingBox(), LSET( item->GetLayer() ) );
+        }
+    }
+
+    first += m_moduleEdges.size();
+
+    for( BOARD_ITEM* item = aBoard->m_Drawings; item; item = item->Next() )
+    {
+        if( item->Type() != PCB_LINE_T && item->Type() != PCB_TEXT_T )
+            continue;
+
+        int ordinal = first + m_drawings.size();
+        m_drawings.push_back( item );
+
+        insert( ordinal, item->GetBoundingBox(), LSET( item->GetLayer() ) );
+    }
+
+    first += m_drawings.size();
+
+    for( int ii = 0; ii < aBoard->GetAreaCount(); ii++ )
+    {
+        ZONE_CONTAINER* zone = aBoard->GetArea( ii );
+
+        int ordinal = first + m_zones.size();
+        m_zones.push_back( zone );
+
+        m_maxMargin = std::max( m_maxMargin, zone->GetClearance() );
+        insert( ordinal, zone->GetBoundingBox(), LSET( zone->GetLayer() ) );
+    }
+}
+
+
+void ZONE_OBSTACLES_INDEX::insert( int aOrdinal, const EDA_RECT& aBBox, LSET aLayers )
+{
+    EDA_RECT bbox = aBBox;
+    bbox.Normalize();
+
+    const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+    const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+    for( LSEQ seq = aLayers.Seq(); seq; ++seq )
+    {
+        LAYER_ID layer = *seq;
+
+        if( !m_trees[layer] )
+            m_trees[layer] = new ORDINAL_RTREE();
+
+        m_trees[layer]->Insert( mmin, mmax, aOrdinal );
+    }
+}
+
+
+void ZONE_OBSTACLES_INDEX::Query( const EDA_RECT& aArea, LAYER_ID aLayer,
+                                  ZONE_OBSTACLES& aObstacles, std::vector<int>& aScratch ) const
+{
+    aObstacles.Clear();
+    aScratch.clear();
+
+    EDA_RECT area = aArea;
+    area.Normalize();
+    area.Inflate( m_maxMargin + 1 );
+
+    const int mmin[2] = { area.GetX(), area.GetY() };
+    const int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+    OBSTACLE_COLLECTOR collector( aScratch );
+
+    if( m_trees[aLayer] )
+        m_trees[aLayer]->Search( mmin, mmax, collector );
+
+    // Board edges make holes in the zones of all layers
+    if( aLayer != Edge_Cuts && m_trees[Edge_Cuts] )
+        m_trees[Edge_Cuts]->Search( mmin, mmax, collector );
+
+    std::sort( aScratch.begin(), aScratch.end() );
+    aScratch.erase( std::unique( aScratch.begin(), aScratch.end() ), aScratch.end() );
+
+    int tracksFirst   = m_pads.size();
+    int edgesFirst    = tracksFirst + m_tracks.size();
+    int drawingsFirst = edgesFirst + m_moduleEdges.size();
+    int zonesFirst    = drawingsFirst + m_drawings.size();
+
+    for( unsigned ii = 0; ii < aScratch.size(); ++ii )
+    {
+        int ordinal = aScratch[ii];
+
+        if( ordinal < tracksFirst )
+            aObstacles.m_Pads.push_back( m_pads[ordinal] );
+        else if( ordinal < edgesFirst )
+            aObstacles.m_Tracks.push_back( m_tracks[ordinal - tracksFirst] );
+        else if( ordinal < drawingsFirst )
+            aObstacles.m_ModuleEdges.push_back( m_moduleEdges[ordinal - edgesFirst] );
+        else if( ordinal < zonesFirst )
+            aObstacles.m_Drawings.push_back( m_drawings[ordinal - drawingsFirst] );
+        else
+            aObstacles.m_Zones.push_back( m_zones[ordinal - zonesFirst] );
+    }
+}
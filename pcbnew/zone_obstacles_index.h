@@ -0,0 +1,167 @@
+/**
+ * @file zone_obstacles_index.h
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef _ZONE_OBSTACLES_INDEX_H
+#define _ZONE_OBSTACLES_INDEX_H
+
+#include <vector>
+
+#include <layers_id_colors_and_visibility.h>
+#include <class_eda_rect.h>
+#include <geometry/rtree.h>
+
+class BOARD;
+class BOARD_ITEM;
+class D_PAD;
+class TRACK;
+class EDGE_MODULE;
+class ZONE_CONTAINER;
+class ZONE_CLEARANCE_CACHE;
+
+
+/**
+ * Struct ZONE_OBSTACLES
+ * is the list of the board items which can make holes in a zone, as found by
+ * ZONE_OBSTACLES_INDEX::Query().  Each list is in board order.
+ */
+struct ZONE_OBSTACLES
+{
+    std::vector<D_PAD*>             m_Pads;         ///< pads and pad holes
+    std::vector<TRACK*>             m_Tracks;       ///< tracks and vias
+    std::vector<EDGE_MODULE*>       m_ModuleEdges;  ///< footprint graphic items
+    std::vector<BOARD_ITEM*>        m_Drawings;     ///< board graphic items and texts
+    std::vector<ZONE_CONTAINER*>    m_Zones;        ///< zones and keepout areas
+
+    void Clear()
+    {
+        m_Pads.clear();
+        m_Tracks.clear();
+        m_ModuleEdges.clear();
+        m_Drawings.clear();
+        m_Zones.clear();
+    }
+};
+
+
+/**
+ * Class ZONE_OBSTACLES_INDEX
+ * keeps one R-tree per layer containing the items which can make holes in a zone:
+ * pads (on all copper layers if they have a hole), tracks, footprint and board
+ * graphic items, and zones.  It is built once before filling a set of zones, so
+ * that each zone only tests the items near its outline, instead of all the items
+ * of the board.
+ *
+ * Items are stored by their ordinal in the board lists, and are returned in this
+ * order, so that the holes are built exactly as with a walk of the board lists.
+ *
+ * The index is a snapshot: it must be rebuilt if the board is modified (filling
+ * zones does not modify the indexed data).  Once built, it is only read by the
+ * queries, which can run concurrently.
+ */
+class ZONE_OBSTACLES_INDEX
+{
+public:
+    ZONE_OBSTACLES_INDEX();
+    ~ZONE_OBSTACLES_INDEX();
+
+    /**
+     * Function Build
+     * (re)creates the index from the items of aBoard.
+     */
+    void Build( BOARD* aBoard );
+
+    /**
+     * Function Clear
+     * removes all the items from the index.
+     */
+    void Clear();
+
+    /**
+     * Function Query
+     * collects the items whose bounding box, inflated by GetMaxMargin(), intersects
+     * aArea, on the layer aLayer and on the Edge_Cuts layer.
+     * @param aArea The area to search.
+     * @param aLayer The layer of the zone.
+     * @param aObstacles The lists to fill.
+     * @param aScratch A buffer used internally, owned by the caller so that several
+     *                 threads can query the same index.
+     */
+    void Query( const EDA_RECT& aArea, LAYER_ID aLayer, ZONE_OBSTACLES& aObstacles,
+                std::vector<int>& aScratch ) const;
+
+    /**
+     * Function GetMaxMargin
+     * @return the largest clearance or thermal gap of the indexed items, which is
+     * the largest distance from its bounding box an item can make a hole at.
+     */
+    int GetMaxMargin() const
+    {
+        return m_maxMargin;
+    }
+
+    /**
+     * Function SetClearanceCache
+     * sets the cache of the pad and track clearance polygons used by the zones
+     * filled with this index (NULL to build all the polygons).
+     */
+    void SetClearanceCache( ZONE_CLEARANCE_CACHE* aCache )
+    {
+        m_clearanceCache = aCache;
+    }
+
+    ZONE_CLEARANCE_CACHE* GetClearanceCache() const
+    {
+        return m_clearanceCache;
+    }
+
+private:
+    typedef RTree<int, int, 2, float>   ORDINAL_RTREE;
+
+    /**
+     * Function insert
+     * adds the ordinal aOrdinal with bounding box aBBox to the trees of all the
+     * layers in aLayers.
+     */
+    void insert( int aOrdinal, const EDA_RECT& aBBox, LSET aLayers );
+
+    ORDINAL_RTREE*                  m_trees[LAYER_ID_COUNT];
+
+    // The ordinals of each kind of items follow the ordinals of the previous kind
+    std::vector<D_PAD*>             m_pads;
+    std::vector<TRACK*>             m_tracks;
+    std::vector<EDGE_MODULE*>       m_moduleEdges;
+    std::vector<BOARD_ITEM*>        m_drawings;
+    std::vector<ZONE_CONTAINER*>    m_zones;
+
+    ///> Largest clearance or thermal gap of the indexed items
+    int                             m_maxMargin;
+
+    ///> Not owned, can be NULL
+    ZONE_CLEARANCE_CACHE*           m_clearanceCache;
+};
+
+#endif  // _ZONE_OBSTACLES_INDEX_H
@@ -60,10 +60,42 @@ enum ZoneConnection {
     PAD_ZONE_CONN_THT_THERMAL   ///< Thermal relief only for THT pads
 };
 
+#include <vector>
+
+class BOARD;
+class EDA_RECT;
 class ZONE_CONTAINER;
 class ZONE_SETTINGS;
+class ZONE_OBSTACLES_INDEX;
 class PCB_BASE_FRAME;
 
+/**
+ * Function FillZones
+ * (re)fills the zones aZones of aPcb; keepout areas are only emptied.
+ * When OpenMP is available, several zones are filled at the same time.
+ * Only the filled areas of the zones are modified: the caller must update the
+ * view and the connectivity afterwards, from the main thread.
+ * @param aObstacles = an index of the items of aPcb, to share between several
+ *                     calls; if NULL, an index is built for this call.
+ */
+void FillZones( BOARD* aPcb, const std::vector<ZONE_CONTAINER*>& aZones,
+                const ZONE_OBSTACLES_INDEX* aObstacles = NULL );
+
+/**
+ * Function FindZonesToRefill
+ * collects the zones of aPcb whose filled areas can be modified by a change of the
+ * board items inside aDirtyAreas (typically the old and the new bounding boxes of
+ * the modified items).  Keepout areas are not collected.
+ * The filled areas are only rebuilt for the whole zone: insulated islands and
+ * thermal stubs depend on the connections of all the zone.
+ * @param aObstacles = the index of the items of aPcb, which gives the largest
+ *                     clearance an item can have.
+ * @param aZones = the list to fill with the zones to refill.
+ */
+void FindZonesToRefill( BOARD* aPcb, const std::vector<EDA_RECT>& aDirtyAreas,
+                        const ZONE_OBSTACLES_INDEX& aObstacles,
+                        std::vector<ZONE_CONTAINER*>& aZones );
+
 /**
  * Function InvokeNonCopperZonesEditor
  * invokes up a modal dialog window for non-copper zone editing.
@@ -42,8 +42,11 @@
 
 #include <pcbnew.h>
 #include <zones.h>
+#include <zone_obstacles_index.h>
+#include <zone_clearance_cache.h>
 
 #define FORMAT_STRING _( "Filling zone %d out of %d (net %s)..." )
+#define FORMAT_BATCH_STRING _( "Filling zones %d to %d out of %d..." )
 
 
 /**
@@ -148,31 +151,93 @@ int PCB_EDIT_FRAME::Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose )
     // Remove segment zones
     GetBoard()->m_Zone.DeleteAll();
 
-    int ii;
+    // Zones are filled by batches (the zones of a batch are filled in parallel
+    // when possible), and the progress bar is updated between two batches.
+    // Filling only modifies the zones, so the view and the ratsnest are updated
+    // here, after each batch.
+    const int batchSize = 16;
+    std::vector<ZONE_CONTAINER*> batch;
+    int filledCount = 0;
+    bool aborted = false;
 
-    for( ii = 0; ii < areaCount; ii++ )
-    {
-        ZONE_CONTAINER* zoneContainer = GetBoard()->GetArea( ii );
-        if( zoneContainer->GetIsKeepout() )
-            continue;
+    // Filling zones does not modify the indexed items, so the index is shared by all batches
+    ZONE_OBSTACLES_INDEX obstacles;
+    obstacles.Build( GetBoard() );
+
+    // Forget the polygons of the deleted items, and reuse the other ones
+    m_zoneClearanceCache->Prune( GetBoard() );
+    obstacles.SetClearanceCache( m_zoneClearanceCache );
 
-        msg.Printf( FORMAT_STRING, ii + 1, areaCount, GetChars( zoneContainer->GetNetname() ) );
+    for( int first = 0; first < areaCount; first += batchSize )
+    {
+        int last = std::min( first + batchSize, areaCount );
 
         if( progressDialog )
         {
-            if( !progressDialog->Update( ii+1, msg ) )
+            msg.Printf( FORMAT_BATCH_STRING, first + 1, last, areaCount );
+
+            if( !progressDialog->Update( first + 1, msg ) )
                 break;  // Aborted by user
         }
 
-        errorLevel = Fill_Zone( zoneContainer );
+        batch.clear();
+
+        for( int ii = first; ii < last; ii++ )
+        {
+            ZONE_CONTAINER* zoneContainer = GetBoard()->GetArea( ii );
+
+            if( !zoneContainer->GetIsKeepout() )
+                batch.push_back( zoneContainer );
+        }
+
+        FillZones( GetBoard(), batch, &obstacles );
+        filledCount += batch.size();
+
+        for( int ii = first; ii < last; ii++ )
+        {
+            ZONE_CONTAINER* zoneContainer = GetBoard()->GetArea( ii );
+
+            if( zoneContainer->GetIsKeepout() )
+                continue;
+
+            zoneContainer->ViewUpdate( KIGFX::VIEW_ITEM::ALL );
+            GetBoard()->GetRatsnest()->Update( zoneContainer );
+
+            // Same messages as when the zones were filled one by one
+            msg.Printf( FORMAT_STRING, ii + 1, areaCount,
+                        GetChars( zoneContainer->GetNetname() ) );
+
+            if( progressDialog && !progressDialog->Update( ii + 1, msg ) )
+                aborted = true;
+        }
+
+        if( aborted )
+            break;  // Aborted by user
+    }
+
+    if( !batch.empty() )
+    {
+        // Like Fill_Zone(), show the net of the last filled zone
+        ZONE_CONTAINER* lastZone = batch.back();
+        ZONE_SETTINGS zoneInfo = GetZoneSettings();
+        zoneInfo.m_NetcodeSelection = lastZone->GetNetCode();
+        SetZoneSettings( zoneInfo );
+
+        msg = lastZone->GetNetname();
 
-        if( errorLevel && !aVerbose )
-            break;
+        if( msg.IsEmpty() )
+            msg = wxT( "No net" );
+
+        ClearMsgPanel();
+        AppendMsgPanel( _( "NetName" ), msg, RED );
     }
 
+    if( filledCount )
+        OnModify();
+
     if( progressDialog )
     {
-        progressDialog->Update( ii+2, _( "Updating ratsnest..." ) );
+        progressDialog->Update( areaCount + 1, _( "Updating ratsnest..." ) );
 #ifdef __WXMAC__
         // Work around a dialog z-order issue on OS X
         aActiveWindow->Raise();
@@ -186,3 +251,48 @@ int PCB_EDIT_FRAME::Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose )
         progressDialog->Destroy();
     return errorLevel;
 }
+
+
+int PCB_EDIT_FRAME::Fill_Zones_In_Areas( const std::vector<EDA_RECT>& aDirtyAreas,
+                                         bool aFilledOnly )
+{
+    ZONE_OBSTACLES_INDEX obstacles;
+    obstacles.Build( GetBoard() );
+
+    std::vector<ZONE_CONTAINER*> zones;
+    FindZonesToRefill( GetBoard(), aDirtyAreas, obstacles, zones );
+
+    if( aFilledOnly )
+    {
+        std::vector<ZONE_CONTAINER*> filled;
+
+        for( unsigned ii = 0; ii < zones.size(); ii++ )
+        {
+            if( zones[ii]->IsFilled() )
+                filled.push_back( zones[ii] );
+        }
+
+        zones.swap( filled );
+    }
+
+    if( zones.empty() )
+        return 0;
+
+    wxBusyCursor dummyCursor;
+
+    // Most of the hole polygons of the refilled zones did not change since the last fill
+    m_zoneClearanceCache->Prune( GetBoard() );
+    obstacles.SetClearanceCache( m_zoneClearanceCache );
+
+    FillZones( GetBoard(), zones, &obstacles );
+
+    for( unsigned ii = 0; ii < zones.size(); ii++ )
+    {
+        zones[ii]->ViewUpdate( KIGFX::VIEW_ITEM::ALL );
+        GetBoard()->GetRatsnest()->Update( zones[ii] );
+    }
+
+    OnModify();
+
+    return zones.size();
+}
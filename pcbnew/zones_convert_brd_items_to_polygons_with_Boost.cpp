@@ -67,6 +67,8 @@
 
 #include <pcbnew.h>
 #include <zones.h>
+#include <zone_obstacles_index.h>
+#include <zone_clearance_cache.h>
 #include <convert_basic_shapes_to_polygon.h>
 
 #include <geometry/shape_poly_set.h>
@@ -94,7 +96,44 @@ extern void CreateThermalReliefPadPolygon( SHAPE_POLY_SET&       aCornerBuffer,
 // Local Variables:
 static double s_thermalRot = 450;  // angle of stubs in thermal reliefs for round pads
 
-void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeatures )
+
+/**
+ * Function collectAllObstacles
+ * fills aObstacles with all the items of aPcb which can make holes in a zone,
+ * in the same order as ZONE_OBSTACLES_INDEX::Query().
+ */
+static void collectAllObstacles( BOARD* aPcb, ZONE_OBSTACLES& aObstacles )
+{
+    aObstacles.Clear();
+
+    for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads(); pad != NULL; pad = pad->Next() )
+            aObstacles.m_Pads.push_back( pad );
+    }
+
+    for( TRACK* track = aPcb->m_Track;  track;  track = track->Next() )
+        aObstacles.m_Tracks.push_back( track );
+
+    for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
+    {
+        for( BOARD_ITEM* item = module->GraphicalItems();  item;  item = item->Next() )
+        {
+            if( item->Type() == PCB_MODULE_EDGE_T )
+                aObstacles.m_ModuleEdges.push_back( (EDGE_MODULE*) item );
+        }
+    }
+
+    for( BOARD_ITEM* item = aPcb->m_Drawings; item; item = item->Next() )
+        aObstacles.m_Drawings.push_back( item );
+
+    for( int ii = 0; ii < aPcb->GetAreaCount(); ii++ )
+        aObstacles.m_Zones.push_back( aPcb->GetArea( ii ) );
+}
+
+
+void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeatures,
+                                           const ZONE_OBSTACLES_INDEX* aObstacles )
 {
     int segsPerCircle;
     double correctionFactor;
@@ -132,6 +171,26 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
     biggest_clearance = std::max( biggest_clearance, zone_clearance );
     zone_boundingbox.Inflate( biggest_clearance );
 
+    /* Collect the items which can make holes in the zone. With an index, only the items
+     * near the zone are tested: the ones whose bounding box, inflated by their clearance
+     * or thermal gap (and the outline thickness), can intersect zone_boundingbox.
+     */
+    ZONE_OBSTACLES obstacles;
+    ZONE_CLEARANCE_CACHE* cache = aObstacles ? aObstacles->GetClearanceCache() : NULL;
+
+    if( aObstacles )
+    {
+        EDA_RECT area = zone_boundingbox;
+        area.Inflate( outline_half_thickness + GetThermalReliefGap() );
+
+        std::vector<int> scratch;
+        aObstacles->Query( area, GetLayer(), obstacles, scratch );
+    }
+    else
+    {
+        collectAllObstacles( aPcb, obstacles );
+    }
+
     /*
      * First : Add pads. Note: pads having the same net as zone are left in zone.
      * Thermal shapes will be created later if necessary
@@ -148,69 +207,72 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
     MODULE dummymodule( aPcb );    // Creates a dummy parent
     D_PAD dummypad( &dummymodule );
 
-    for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
+    for( unsigned ip = 0; ip < obstacles.m_Pads.size(); ip++ )
     {
-        D_PAD* nextpad;
+        D_PAD* pad = obstacles.m_Pads[ip];     // can be replaced by the dummy pad below
 
-        for( D_PAD* pad = module->Pads(); pad != NULL; pad = nextpad )
+        if( !pad->IsOnLayer( GetLayer() ) )
         {
-            nextpad = pad->Next();  // pad pointer can be modified by next code, so
-                                    // calculate the next pad here
+            /* Test for pads that are on top or bottom only and have a hole.
+             * There are curious pads but they can be used for some components that are
+             * inside the board (in fact inside the hole. Some photo diodes and Leds are
+             * like this)
+             */
+            if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
+                continue;
 
-            if( !pad->IsOnLayer( GetLayer() ) )
-            {
-                /* Test for pads that are on top or bottom only and have a hole.
-                 * There are curious pads but they can be used for some components that are
-                 * inside the board (in fact inside the hole. Some photo diodes and Leds are
-                 * like this)
-                 */
-                if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
-                    continue;
-
-                // Use a dummy pad to calculate a hole shape that have the same dimension as
-                // the pad hole
-                dummypad.SetSize( pad->GetDrillSize() );
-                dummypad.SetOrientation( pad->GetOrientation() );
-                dummypad.SetShape( pad->GetDrillShape() == PAD_DRILL_SHAPE_OBLONG ?
-                                   PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
-                dummypad.SetPosition( pad->GetPosition() );
-
-                pad = &dummypad;
-            }
+            // Use a dummy pad to calculate a hole shape that have the same dimension as
+            // the pad hole
+            dummypad.SetSize( pad->GetDrillSize() );
+            dummypad.SetOrientation( pad->GetOrientation() );
+            dummypad.SetShape( pad->GetDrillShape() == PAD_DRILL_SHAPE_OBLONG ?
+                               PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
+            dummypad.SetPosition( pad->GetPosition() );
+
+            pad = &dummypad;
+        }
+
+        // Note: netcode <=0 means not connected item
+        if( ( pad->GetNetCode() != GetNetCode() ) || ( pad->GetNetCode() <= 0 ) )
+        {
+            item_clearance   = pad->GetClearance() + outline_half_thickness;
+            item_boundingbox = pad->GetBoundingBox();
+            item_boundingbox.Inflate( item_clearance );
 
-            // Note: netcode <=0 means not connected item
-            if( ( pad->GetNetCode() != GetNetCode() ) || ( pad->GetNetCode() <= 0 ) )
+            if( item_boundingbox.Intersects( zone_boundingbox ) )
             {
-                item_clearance   = pad->GetClearance() + outline_half_thickness;
-                item_boundingbox = pad->GetBoundingBox();
-                item_boundingbox.Inflate( item_clearance );
+                int clearance = std::max( zone_clearance, item_clearance );
 
-                if( item_boundingbox.Intersects( zone_boundingbox ) )
-                {
-                    int clearance = std::max( zone_clearance, item_clearance );
+                // The dummy pad changes for each pad hole: do not cache it
+                if( cache && pad != &dummypad )
+                    cache->AddPadShape( aFeatures, pad, clearance,
+                                        segsPerCircle, correctionFactor );
+                else
                     pad->TransformShapeWithClearanceToPolygon( aFeatures,
                                                                clearance,
                                                                segsPerCircle,
                                                                correctionFactor );
-                }
-
-                continue;
             }
 
-            if( GetPadConnection( pad ) == PAD_ZONE_CONN_NONE )
-            {
-                int gap = zone_clearance;
-                int thermalGap = GetThermalReliefGap( pad );
-                gap = std::max( gap, thermalGap );
-                item_boundingbox = pad->GetBoundingBox();
+            continue;
+        }
+
+        if( GetPadConnection( pad ) == PAD_ZONE_CONN_NONE )
+        {
+            int gap = zone_clearance;
+            int thermalGap = GetThermalReliefGap( pad );
+            gap = std::max( gap, thermalGap );
+            item_boundingbox = pad->GetBoundingBox();
 
-                if( item_boundingbox.Intersects( zone_boundingbox ) )
-                {
+            if( item_boundingbox.Intersects( zone_boundingbox ) )
+            {
+                if( cache && pad != &dummypad )
+                    cache->AddPadShape( aFeatures, pad, gap, segsPerCircle, correctionFactor );
+                else
                     pad->TransformShapeWithClearanceToPolygon( aFeatures,
                                                                gap,
                                                                segsPerCircle,
                                                                correctionFactor );
-                }
             }
         }
     }
@@ -218,8 +280,10 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
     /* Add holes (i.e. tracks and vias areas as polygons outlines)
      * in cornerBufferPolysToSubstract
      */
-    for( TRACK* track = aPcb->m_Track;  track;  track = track->Next() )
+    for( unsigned it = 0; it < obstacles.m_Tracks.size(); it++ )
     {
+        TRACK* track = obstacles.m_Tracks[it];
+
         if( !track->IsOnLayer( GetLayer() ) )
             continue;
 
@@ -232,10 +296,15 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
         if( item_boundingbox.Intersects( zone_boundingbox ) )
         {
             int clearance = std::max( zone_clearance, item_clearance );
-            track->TransformShapeWithClearanceToPolygon( aFeatures,
-                                                         clearance,
-                                                         segsPerCircle,
-                                                         correctionFactor );
+
+            if( cache )
+                cache->AddTrackShape( aFeatures, track, clearance,
+                                      segsPerCircle, correctionFactor );
+            else
+                track->TransformShapeWithClearanceToPolygon( aFeatures,
+                                                             clearance,
+                                                             segsPerCircle,
+                                                             correctionFactor );
         }
     }
 
@@ -243,30 +312,27 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
      * Pcbnew allows these items to be on copper layers in microwave applictions
      * This is a bad thing, but must be handled here, until a better way is found
      */
-    for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
+    for( unsigned ie = 0; ie < obstacles.m_ModuleEdges.size(); ie++ )
     {
-        for( BOARD_ITEM* item = module->GraphicalItems();  item;  item = item->Next() )
-        {
-            if( !item->IsOnLayer( GetLayer() ) && !item->IsOnLayer( Edge_Cuts ) )
-                continue;
+        EDGE_MODULE* item = obstacles.m_ModuleEdges[ie];
 
-            if( item->Type() != PCB_MODULE_EDGE_T )
-                continue;
+        if( !item->IsOnLayer( GetLayer() ) && !item->IsOnLayer( Edge_Cuts ) )
+            continue;
 
-            item_boundingbox = item->GetBoundingBox();
+        item_boundingbox = item->GetBoundingBox();
 
-            if( item_boundingbox.Intersects( zone_boundingbox ) )
-            {
-                ( (EDGE_MODULE*) item )->TransformShapeWithClearanceToPolygon(
-                    aFeatures, zone_clearance,
-                    segsPerCircle, correctionFactor );
-            }
+        if( item_boundingbox.Intersects( zone_boundingbox ) )
+        {
+            item->TransformShapeWithClearanceToPolygon( aFeatures, zone_clearance,
+                                                        segsPerCircle, correctionFactor );
         }
     }
 
     // Add graphic items (copper texts) and board edges
-    for( BOARD_ITEM* item = aPcb->m_Drawings; item; item = item->Next() )
+    for( unsigned id = 0; id < obstacles.m_Drawings.size(); id++ )
     {
+        BOARD_ITEM* item = obstacles.m_Drawings[id];
+
         if( item->GetLayer() != GetLayer() && item->GetLayer() != Edge_Cuts )
             continue;
 
@@ -289,9 +355,10 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
     }
 
     // Add zones outlines having an higher priority and keepout
-    for( int ii = 0; ii < GetBoard()->GetAreaCount(); ii++ )
+    for( unsigned iz = 0; iz < obstacles.m_Zones.size(); iz++ )
     {
-        ZONE_CONTAINER* zone = GetBoard()->GetArea( ii );
+        ZONE_CONTAINER* zone = obstacles.m_Zones[iz];
+
         if( zone->GetLayer() != GetLayer() )
             continue;
 
@@ -336,37 +403,36 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
     }
 
    // Remove thermal symbols
-    for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
+    for( unsigned ip = 0; ip < obstacles.m_Pads.size(); ip++ )
     {
-        for( D_PAD* pad = module->Pads(); pad != NULL; pad = pad->Next() )
-        {
-            // Rejects non-standard pads with tht-only thermal reliefs
-            if( GetPadConnection( pad ) == PAD_ZONE_CONN_THT_THERMAL
-             && pad->GetAttribute() != PAD_ATTRIB_STANDARD )
-                continue;
+        D_PAD* pad = obstacles.m_Pads[ip];
 
-            if( GetPadConnection( pad ) != PAD_ZONE_CONN_THERMAL
-             && GetPadConnection( pad ) != PAD_ZONE_CONN_THT_THERMAL )
-                continue;
+        // Rejects non-standard pads with tht-only thermal reliefs
+        if( GetPadConnection( pad ) == PAD_ZONE_CONN_THT_THERMAL
+         && pad->GetAttribute() != PAD_ATTRIB_STANDARD )
+            continue;
 
-            if( !pad->IsOnLayer( GetLayer() ) )
-                continue;
+        if( GetPadConnection( pad ) != PAD_ZONE_CONN_THERMAL
+         && GetPadConnection( pad ) != PAD_ZONE_CONN_THT_THERMAL )
+            continue;
 
-            if( pad->GetNetCode() != GetNetCode() )
-                continue;
-            item_boundingbox = pad->GetBoundingBox();
-            int thermalGap = GetThermalReliefGap( pad );
-            item_boundingbox.Inflate( thermalGap, thermalGap );
+        if( !pad->IsOnLayer( GetLayer() ) )
+            continue;
 
-            if( item_boundingbox.Intersects( zone_boundingbox ) )
-            {
-                CreateThermalReliefPadPolygon( aFeatures,
-                                               *pad, thermalGap,
-                                               GetThermalReliefCopperBridge( pad ),
-                                               m_ZoneMinThickness,
-                                               segsPerCircle,
-                                               correctionFactor, s_thermalRot );
-            }
+        if( pad->GetNetCode() != GetNetCode() )
+            continue;
+        item_boundingbox = pad->GetBoundingBox();
+        int thermalGap = GetThermalReliefGap( pad );
+        item_boundingbox.Inflate( thermalGap, thermalGap );
+
+        if( item_boundingbox.Intersects( zone_boundingbox ) )
+        {
+            CreateThermalReliefPadPolygon( aFeatures,
+                                           *pad, thermalGap,
+                                           GetThermalReliefCopperBridge( pad ),
+                                           m_ZoneMinThickness,
+                                           segsPerCircle,
+                                           correctionFactor, s_thermalRot );
         }
     }
 
@@ -403,7 +469,8 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
  *     Remove new insulated copper islands
  */
 
-void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb )
+void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb,
+                                        const ZONE_OBSTACLES_INDEX* aObstacles )
 {
     int segsPerCircle;
     double correctionFactor;
@@ -433,6 +500,14 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb )
 
     SHAPE_POLY_SET solidAreas = ConvertPolyListToPolySet( m_smoothedPoly->m_CornersList );
 
+    if( g_DumpZonesWhenFilling )
+    {
+        // The name gives the Inflate() parameters, to replay it (see tools/zone_fill_bench.cpp)
+        char name[64];
+        snprintf( name, sizeof( name ), "outline-%d-%d", segsPerCircle, outline_half_thickness );
+        dumper->Write( &solidAreas, name );
+    }
+
     solidAreas.Inflate( -outline_half_thickness, segsPerCircle );
     solidAreas.Simplify( POLY_CALC_MODE );
 
@@ -442,7 +517,7 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList_NG( BOARD* aPcb )
         dumper->Write( &solidAreas, "solid-areas" );
 
     tmp.RemoveAllContours();
-    buildFeatureHoleList( aPcb, holes );
+    buildFeatureHoleList( aPcb, holes, aObstacles );
 
     if(g_DumpZonesWhenFilling)
         dumper->Write( &holes, "feature-holes" );
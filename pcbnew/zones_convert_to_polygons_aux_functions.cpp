@@ -50,8 +50,15 @@ void ZONE_CONTAINER::TransformOutlinesShapeWithClearanceToPolygon(
         SHAPE_POLY_SET& aCornerBuffer, int aMinClearanceValue, bool aUseNetClearance )
 {
     // Creates the zone outline polygon (with holes if any)
+    // This zone is not modified: it can be being filled by another thread
     SHAPE_POLY_SET polybuffer;
-    BuildFilledSolidAreasPolygons( NULL, &polybuffer );
+
+    if( GetNumCorners() > 2 )   // malformed zone. polygon calculations do not like it ...
+    {
+        CPolyLine* smoothedPoly = BuildSmoothedPoly();
+        polybuffer = ConvertPolyListToPolySet( smoothedPoly->m_CornersList );
+        delete smoothedPoly;
+    }
 
     // add clearance to outline
     int clearance = aMinClearanceValue;
@@ -0,0 +1,51 @@
+import code
+import unittest
+import os
+import json
+import pcbnew
+import pdb
+import tempfile
+
+
+PHASES = [u'pad2pad', u'tracks', u'zone fill', u'zones',
+          u'unconnected', u'keepout', u'texts']
+
+
+class TestDRC(unittest.TestCase):
+
+    def setUp(self):
+        self.pcb = pcbnew.LoadBoard("data/complex_hierarchy.kicad_pcb")
+        self.FILENAME=tempfile.mktemp()
+
+    def tearDown(self):
+        if os.path.exists(self.FILENAME):
+            os.remove(self.FILENAME)
+
+    def test_drc_json_report(self):
+        self.FILENAME += ".json"
+        count = pcbnew.RunDRC(self.pcb, self.FILENAME)
+        self.assertTrue(count >= 0)
+
+        with open(self.FILENAME) as f:
+            report = json.load(f)
+
+        self.assertEqual([p['name'] for p in report['phases']], PHASES)
+        self.assertEqual(len(report['items']), count)
+
+    def test_drc_csv_report(self):
+        self.FILENAME += ".csv"
+        count = pcbnew.RunDRC(self.pcb, self.FILENAME)
+        self.assertTrue(count >= 0)
+
+        with open(self.FILENAME) as f:
+            lines = f.read().splitlines()
+
+        items = [l for l in lines[1:] if not l.startswith('phase,')]
+        self.assertEqual(len(items), count)
+        self.assertEqual(len(lines) - 1 - len(items), len(PHASES))
+
+    #def test_interactive(self):
+    # 	code.interact(local=locals())
+
+if __name__ == '__main__':
+    unittest.main()
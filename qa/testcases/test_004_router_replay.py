@@ -0,0 +1,90 @@
+import code
+import unittest
+import os
+import pcbnew
+import pdb
+import tempfile
+
+
+from pcbnew import *
+
+
+class TestRouterReplay(unittest.TestCase):
+
+    def setUp(self):
+        self.pcb = LoadBoard("data/complex_hierarchy.kicad_pcb")
+        self.FILENAME=tempfile.mktemp()+".log"
+
+    def tearDown(self):
+        if os.path.exists(self.FILENAME):
+            os.remove(self.FILENAME)
+
+    def test_replay_missing_file(self):
+        self.assertEqual(ReplayRouterEvents(self.pcb, self.FILENAME), -1)
+
+    def test_replay_route_from_pad(self):
+        module = self.pcb.FindModule('P1')
+        pos = module.Pads().GetPosition()
+
+        end = wxPoint(pos.x + 2000000, pos.y)
+        width = FromMM(0.123)
+        before = set((t.GetStart().x, t.GetStart().y, t.GetEnd().x, t.GetEnd().y)
+                     for t in self.pcb.GetTracks())
+
+        # walkaround mode, full optimizer effort; start on the pad (kind 1 = solid)
+        # with a track width unknown to the board, move away and fix the route
+        with open(self.FILENAME, "w") as f:
+            f.write("settings 2 2\n")
+            f.write("event start %d %d 0 1 1 %d 0 0\n" % (pos.x, pos.y, width))
+            f.write("event move %d %d 0 0 0 0 0 0\n" % (end.x, end.y))
+            f.write("event fix %d %d 0 0 0 0 0 0\n" % (end.x, end.y))
+
+        self.assertEqual(ReplayRouterEvents(self.pcb, self.FILENAME), 3)
+
+        added = [t for t in self.pcb.GetTracks()
+                 if (t.GetStart().x, t.GetStart().y, t.GetEnd().x, t.GetEnd().y) not in before]
+
+        # the route reaches the end point, with the recorded width
+        self.assertTrue(added)
+        self.assertEqual(set(t.GetWidth() for t in added), set([width]))
+        ends = set()
+        for t in added:
+            ends.add((t.GetStart().x, t.GetStart().y))
+            ends.add((t.GetEnd().x, t.GetEnd().y))
+        self.assertTrue((end.x, end.y) in ends)
+
+    def test_replay_drag_lone_via_back(self):
+        # a via connected to nothing, away from the other items
+        bbox = self.pcb.ComputeBoundingBox()
+        pos = wxPoint(bbox.GetRight() + FromMM(10), bbox.GetBottom() + FromMM(10))
+        net = self.pcb.FindModule('P1').Pads().GetNetCode()
+
+        via = VIA(self.pcb)
+        via.SetPosition(pos)
+        via.SetWidth(FromMM(0.8))
+        via.SetDrill(FromMM(0.4))
+        via.SetLayerPair(F_Cu, B_Cu)
+        via.SetNetCode(net)
+        self.pcb.Add(via)
+
+        # drag it (kind 16 = via) away and back: the branch of the second move
+        # must not find the joint of the via removed by the first move
+        with open(self.FILENAME, "w") as f:
+            f.write("event drag %d %d 0 16 0\n" % (pos.x, pos.y))
+            f.write("event move %d %d 0 0 0\n" % (pos.x + FromMM(2), pos.y))
+            f.write("event move %d %d 0 0 0\n" % (pos.x, pos.y))
+            f.write("event fix %d %d 0 0 0\n" % (pos.x, pos.y))
+
+        self.assertEqual(ReplayRouterEvents(self.pcb, self.FILENAME), 4)
+
+        moved = [(t.GetPosition().x, t.GetPosition().y) for t in self.pcb.GetTracks()
+                 if t.GetClass() == "VIA" and t.GetNetCode() == net
+                 and abs(t.GetPosition().y - pos.y) < FromMM(1)
+                 and abs(t.GetPosition().x - pos.x) < FromMM(5)]
+        self.assertEqual(moved, [(pos.x, pos.y)])
+
+    #def test_interactive(self):
+    # 	code.interact(local=locals())
+
+if __name__ == '__main__':
+    unittest.main()
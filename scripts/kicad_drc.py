@@ -0,0 +1,45 @@
+#!/usr/bin/python
+
+# Run the DRC on a board without any window, for instance on a build server.
+# Prints the wall time of each DRC phase, and writes the errors to a report
+# file: JSON if its extension is .json, CSV otherwise.
+
+# 1) Build target _pcbnew after enabling scripting in cmake.
+# $ make _pcbnew
+
+# 2) Changed dir to pcbnew
+# $ cd pcbnew
+
+# 3) Entered following command line, script takes two arguments: board_file report_file
+# $ PYTHONPATH=. <path_to>/kicad_drc.py my_board.kicad_pcb my_board_drc.json
+
+# The exit status is 0 if no error was found, 1 if errors were found
+# and 2 if the board or the report cannot be read or written.
+
+
+from __future__ import print_function
+from pcbnew import *
+import sys
+
+if len( sys.argv ) < 3 :
+    print( "usage: script <board_file> <report_file>" )
+    sys.exit(2)
+
+board_file = sys.argv[1]
+report_file = sys.argv[2]
+
+board = LoadBoard( board_file )
+
+if board is None:
+    print( "cannot load board", board_file )
+    sys.exit(2)
+
+count = RunDRC( board, report_file )
+
+if count < 0:
+    print( "cannot write report", report_file )
+    sys.exit(2)
+
+print( count, "DRC errors" )
+
+sys.exit( 1 if count else 0 )
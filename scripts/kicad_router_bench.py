@@ -0,0 +1,46 @@
+#!/usr/bin/python
+
+# Replay the events of an interactive router session on a board, without any
+# window, and print the latency percentiles of each event type, the number of
+# branched nodes, index queries and optimizer iterations.
+# The events are saved by the router "dump log" command to /tmp/pns_events.log.
+
+# 1) Build target _pcbnew after enabling scripting in cmake.
+# $ make _pcbnew
+
+# 2) Changed dir to pcbnew
+# $ cd pcbnew
+
+# 3) Entered following command line, script takes two arguments: board_file event_file
+# $ PYTHONPATH=. <path_to>/kicad_router_bench.py my_board.kicad_pcb pns_events.log
+
+# The exit status is 0 if the events were replayed, and 2 if the board or the
+# event file cannot be read.
+
+
+from __future__ import print_function
+from pcbnew import *
+import sys
+
+if len( sys.argv ) < 3 :
+    print( "usage: script <board_file> <event_file>" )
+    sys.exit(2)
+
+board_file = sys.argv[1]
+event_file = sys.argv[2]
+
+board = LoadBoard( board_file )
+
+if board is None:
+    print( "cannot load board", board_file )
+    sys.exit(2)
+
+count = ReplayRouterEvents( board, event_file )
+
+if count < 0:
+    print( "cannot read events", event_file )
+    sys.exit(2)
+
+print( count, "events replayed" )
+
+sys.exit(0)
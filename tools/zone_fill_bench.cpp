@@ -0,0 +1,320 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Replays the polygon operations of the zone filling on a zone dump, and prints the
+ * time, the vertex counts and the heap allocations of each of them.
+ *
+ * The dump is the zones_dump.txt file written by pcbnew when filling zones with the
+ * g_DumpZonesWhenFilling option: for each zone, the outline with the parameters of
+ * its deflate, the solid areas, the feature holes and the fractured result.  The
+ * operations replayed for each zone are:
+ *  - Inflate: the outline deflated by half the zone min thickness, with the number of
+ *    segments per circle of the zone,
+ *  - Simplify: the feature holes,
+ *  - BooleanSubtract: the solid areas minus the simplified holes,
+ *  - Fracture: the result of the subtraction, which is checked point by point against
+ *    the dump.
+ *
+ * usage: zone_fill_bench <zones_dump.txt> [repeat count]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <profile.h>
+#include <geometry/shape_poly_set.h>
+#include <geometry/shape_file_io.h>
+
+#define POLY_CALC_MODE SHAPE_POLY_SET::PM_FAST
+
+
+// Heap allocations are counted by replacing the global operator new
+static unsigned long s_allocCount = 0;
+static unsigned long s_allocBytes = 0;
+
+void* operator new( size_t aSize ) throw( std::bad_alloc )
+{
+    s_allocCount++;
+    s_allocBytes += aSize;
+
+    void* ptr = malloc( aSize ? aSize : 1 );
+
+    if( !ptr )
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+
+void* operator new[]( size_t aSize ) throw( std::bad_alloc )
+{
+    return operator new( aSize );
+}
+
+
+void operator delete( void* aPtr ) throw()
+{
+    free( aPtr );
+}
+
+
+void operator delete[]( void* aPtr ) throw()
+{
+    free( aPtr );
+}
+
+
+struct ZONE_DUMP
+{
+    SHAPE_POLY_SET  m_Outline;
+    int             m_SegmentsPerCircle;
+    int             m_HalfThickness;
+    SHAPE_POLY_SET  m_SolidAreas;
+    SHAPE_POLY_SET  m_Holes;
+    SHAPE_POLY_SET  m_Fractured;
+};
+
+
+struct STAGE
+{
+    const char*     m_Name;
+    double          m_Ms;
+    long            m_VerticesIn;
+    long            m_VerticesOut;
+    unsigned long   m_Allocs;
+    unsigned long   m_Bytes;
+};
+
+
+static void begin( prof_counter& aCounter, unsigned long& aAllocs, unsigned long& aBytes )
+{
+    aAllocs = s_allocCount;
+    aBytes  = s_allocBytes;
+    prof_start( &aCounter );
+}
+
+
+static void end( STAGE& aStage, prof_counter& aCounter, unsigned long aAllocs,
+                 unsigned long aBytes )
+{
+    prof_end( &aCounter );
+
+    aStage.m_Ms     += aCounter.msecs();
+    aStage.m_Allocs += s_allocCount - aAllocs;
+    aStage.m_Bytes  += s_allocBytes - aBytes;
+}
+
+
+// Compares two polygon sets point by point, outlines and holes
+static bool samePolygons( const SHAPE_POLY_SET& aA, const SHAPE_POLY_SET& aB )
+{
+    if( aA.OutlineCount() != aB.OutlineCount() )
+        return false;
+
+    for( int ii = 0; ii < aA.OutlineCount(); ii++ )
+    {
+        const SHAPE_POLY_SET::POLYGON& polyA = aA.CPolygon( ii );
+        const SHAPE_POLY_SET::POLYGON& polyB = aB.CPolygon( ii );
+
+        if( polyA.size() != polyB.size() )
+            return false;
+
+        for( unsigned jj = 0; jj < polyA.size(); jj++ )
+        {
+            const SHAPE_LINE_CHAIN& pathA = polyA[jj];
+            const SHAPE_LINE_CHAIN& pathB = polyB[jj];
+
+            if( pathA.PointCount() != pathB.PointCount() )
+                return false;
+
+            for( int kk = 0; kk < pathA.PointCount(); kk++ )
+            {
+                if( pathA.CPoint( kk ) != pathB.CPoint( kk ) )
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+static bool readDump( const char* aFileName, std::vector<ZONE_DUMP>& aZones )
+{
+    SHAPE_FILE_IO file( aFileName, SHAPE_FILE_IO::IOM_READ );
+    SHAPE* shape;
+    bool found = false;
+
+    while( ( shape = file.Read() ) != NULL )
+    {
+        found = true;
+
+        if( shape->Type() != SH_POLY_SET )
+        {
+            delete shape;
+            continue;
+        }
+
+        SHAPE_POLY_SET* polyset = static_cast<SHAPE_POLY_SET*>( shape );
+        const std::string& name = file.GetShapeName();
+
+        int segmentsPerCircle, halfThickness;
+
+        // Each zone starts with its outline, then its solid areas (the deflated outline),
+        // its holes and its fractured areas
+        if( sscanf( name.c_str(), "outline-%d-%d", &segmentsPerCircle, &halfThickness ) == 2 )
+        {
+            aZones.push_back( ZONE_DUMP() );
+            aZones.back().m_Outline = *polyset;
+            aZones.back().m_SegmentsPerCircle = segmentsPerCircle;
+            aZones.back().m_HalfThickness = halfThickness;
+        }
+        else if( !aZones.empty() && name == "solid-areas" )
+        {
+            aZones.back().m_SolidAreas = *polyset;
+        }
+        else if( !aZones.empty() && name == "feature-holes" )
+        {
+            aZones.back().m_Holes = *polyset;
+        }
+        else if( !aZones.empty() && name == "fractured"
+                 && aZones.back().m_Fractured.OutlineCount() == 0 )
+        {
+            // Keep the first one: the second one is built after removing thermal stubs
+            aZones.back().m_Fractured = *polyset;
+        }
+
+        delete shape;
+    }
+
+    return found;
+}
+
+
+int main( int argc, char** argv )
+{
+    if( argc < 2 )
+    {
+        fprintf( stderr, "usage: %s <zones_dump.txt> [repeat count]\n", argv[0] );
+        return 1;
+    }
+
+    int repeat = argc > 2 ? atoi( argv[2] ) : 1;
+
+    if( repeat < 1 )
+        repeat = 1;
+
+    std::vector<ZONE_DUMP> zones;
+
+    if( !readDump( argv[1], zones ) )
+    {
+        fprintf( stderr, "%s: no shape found\n", argv[1] );
+        return 1;
+    }
+
+    if( zones.empty() )
+    {
+        fprintf( stderr, "%s: no zone outline found (dump made by an older pcbnew?)\n",
+                 argv[1] );
+        return 1;
+    }
+
+    STAGE stages[4] =
+    {
+        { "Inflate",          0.0, 0, 0, 0, 0 },
+        { "Simplify",         0.0, 0, 0, 0, 0 },
+        { "BooleanSubtract",  0.0, 0, 0, 0, 0 },
+        { "Fracture",         0.0, 0, 0, 0, 0 }
+    };
+
+    int mismatches = 0;
+
+    for( int pass = 0; pass < repeat; pass++ )
+    {
+        for( unsigned ii = 0; ii < zones.size(); ii++ )
+        {
+            const ZONE_DUMP& zone = zones[ii];
+            prof_counter counter;
+            unsigned long allocs, bytes;
+
+            SHAPE_POLY_SET inflated = zone.m_Outline;
+            begin( counter, allocs, bytes );
+            inflated.Inflate( -zone.m_HalfThickness, zone.m_SegmentsPerCircle );
+            end( stages[0], counter, allocs, bytes );
+
+            SHAPE_POLY_SET holes = zone.m_Holes;
+            begin( counter, allocs, bytes );
+            holes.Simplify( POLY_CALC_MODE );
+            end( stages[1], counter, allocs, bytes );
+
+            SHAPE_POLY_SET solidAreas = zone.m_SolidAreas;
+            begin( counter, allocs, bytes );
+            solidAreas.BooleanSubtract( holes, POLY_CALC_MODE );
+            end( stages[2], counter, allocs, bytes );
+
+            SHAPE_POLY_SET fractured = solidAreas;
+            begin( counter, allocs, bytes );
+            fractured.Fracture( POLY_CALC_MODE );
+            end( stages[3], counter, allocs, bytes );
+
+            if( pass == 0 )
+            {
+                stages[0].m_VerticesIn  += zone.m_Outline.TotalVertices();
+                stages[0].m_VerticesOut += inflated.TotalVertices();
+                stages[1].m_VerticesIn  += zone.m_Holes.TotalVertices();
+                stages[1].m_VerticesOut += holes.TotalVertices();
+                stages[2].m_VerticesIn  += zone.m_SolidAreas.TotalVertices()
+                                           + holes.TotalVertices();
+                stages[2].m_VerticesOut += solidAreas.TotalVertices();
+                stages[3].m_VerticesIn  += solidAreas.TotalVertices();
+                stages[3].m_VerticesOut += fractured.TotalVertices();
+
+                // Same operations on the same data: the result must match the dump
+                if( zone.m_Fractured.OutlineCount() && !samePolygons( fractured, zone.m_Fractured ) )
+                    mismatches++;
+            }
+        }
+    }
+
+    printf( "%u zones, %d pass(es)\n", (unsigned) zones.size(), repeat );
+    printf( "%-16s %12s %12s %12s %12s %14s\n",
+            "stage", "ms/pass", "vertices in", "vertices out", "allocs/pass", "bytes/pass" );
+
+    for( int ii = 0; ii < 4; ii++ )
+    {
+        const STAGE& stage = stages[ii];
+
+        printf( "%-16s %12.3f %12ld %12ld %12lu %14lu\n", stage.m_Name,
+                stage.m_Ms / repeat, stage.m_VerticesIn, stage.m_VerticesOut,
+                stage.m_Allocs / repeat, stage.m_Bytes / repeat );
+    }
+
+    if( mismatches )
+        printf( "%d zone(s) fractured differently from the dump\n", mismatches );
+
+    return 0;
+}